@@ -0,0 +1,233 @@
+// micro-benchmarks for the per packet ip work on the tun and exit paths: full checksums over a
+// realistic mix of packet sizes, and rewriting addresses one packet at a time against a batch at
+// once.  every result is printed as one json object per line on stdout so runs can be diffed
+// across commits.  run with AVX2_FORCE_DISABLE=1 to time the scalar checksum.
+
+#include <llarp/constants/version.hpp>
+#include <llarp/net/ip.hpp>
+#include <llarp/net/ip_packet.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Options
+  {
+    size_t packets = 1'000'000;
+    /// how many packets of one flow come in a row when rewriting
+    size_t run = 8;
+    std::string only;
+  };
+
+  /// packet sizes in the proportions of the usual internet mix, 7 small to 4 medium to 1 full
+  /// sized, plus the occasional 64k segment the tun offload hands us
+  std::vector<size_t>
+  PacketMix(size_t n)
+  {
+    static const std::vector<size_t> pattern{
+        64, 576, 64, 1500, 64, 576, 64, 64, 576, 64, 576, 64};
+    std::vector<size_t> sizes;
+    for (size_t idx = 0; idx < n; ++idx)
+      sizes.push_back(idx % 512 == 511 ? 64 * 1024 : pattern[idx % pattern.size()]);
+    return sizes;
+  }
+
+  /// the checksum the way it was summed before, a 16 bit word at a time, to compare against
+  uint16_t
+  WordAtATime(const byte_t* buf, size_t sz)
+  {
+    uint32_t sum = 0;
+    while (sz > 1)
+    {
+      uint16_t word;
+      std::memcpy(&word, buf, 2);
+      sum += word;
+      sz -= 2;
+      buf += 2;
+    }
+    if (sz != 0)
+      sum += *buf;
+    sum = (sum & 0xFFff) + (sum >> 16);
+    sum += sum >> 16;
+    return uint16_t(~sum);
+  }
+
+  nlohmann::json
+  Result(std::string bench)
+  {
+    return nlohmann::json{{"bench", std::move(bench)}, {"version", VERSION_FULL}};
+  }
+
+  void
+  Emit(const nlohmann::json& result)
+  {
+    std::cout << result.dump() << std::endl;
+  }
+
+  void
+  BenchChecksum(const Options& opts)
+  {
+    const auto sizes = PacketMix(std::min<size_t>(opts.packets, 4096));
+    std::mt19937 rng{1};
+    std::vector<std::vector<byte_t>> bufs;
+    size_t bytes = 0;
+    for (const auto sz : sizes)
+    {
+      auto& buf = bufs.emplace_back(sz);
+      for (auto& b : buf)
+        b = rng();
+      bytes += sz;
+    }
+    const size_t rounds = std::max<size_t>(opts.packets / bufs.size(), 1);
+
+    for (const auto& [name, sum] :
+         std::vector<std::pair<std::string, uint16_t (*)(const byte_t*, size_t)>>{
+             {"word_at_a_time", &WordAtATime},
+             {"ipchksum", [](const byte_t* buf, size_t sz) { return net::ipchksum(buf, sz); }}})
+    {
+      uint32_t sink = 0;
+      const auto started = Clock_t::now();
+      for (size_t round = 0; round < rounds; ++round)
+      {
+        for (const auto& buf : bufs)
+          sink += sum(buf.data(), buf.size());
+      }
+      const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+      auto result = Result("ip_checksum");
+      result["impl"] = name;
+      result["packets"] = rounds * bufs.size();
+      result["gbps"] = rounds * bytes * 8 / elapsed.count() / 1e9;
+      result["sink"] = sink;
+      Emit(result);
+    }
+  }
+
+  /// a tcp packet between two addresses, v4 or v6, of size bytes
+  net::IPPacket
+  MakePacket(bool v4, uint64_t flow, size_t size)
+  {
+    std::vector<byte_t> raw(std::max<size_t>(size, v4 ? 40 : 60));
+    if (v4)
+    {
+      raw[0] = 0x45;
+      oxenc::write_host_as_big<uint16_t>(raw.size(), &raw[2]);
+      raw[9] = 6;
+      oxenc::write_host_as_big<uint32_t>(0x0a00'0000 | flow, &raw[12]);
+      oxenc::write_host_as_big<uint32_t>(0x5db8'd822, &raw[16]);
+    }
+    else
+    {
+      raw[0] = 0x60;
+      oxenc::write_host_as_big<uint16_t>(raw.size() - 40, &raw[4]);
+      raw[6] = 6;
+      raw[8] = 0xfd;
+      oxenc::write_host_as_big<uint64_t>(flow, &raw[16]);
+      raw[24] = 0x20;
+      raw[39] = 1;
+    }
+    return net::IPPacket{std::move(raw)};
+  }
+
+  void
+  BenchRewrite(const Options& opts)
+  {
+    const auto sizes = PacketMix(std::min<size_t>(opts.packets, 4096));
+    for (const bool v4 : {true, false})
+    {
+      // the same flow for run packets in a row, the way a burst from one convo arrives
+      std::vector<net::IPPacket> pkts;
+      std::vector<std::pair<huint128_t, huint128_t>> to;
+      for (size_t idx = 0; idx < sizes.size(); ++idx)
+      {
+        const uint64_t flow = idx / std::max<size_t>(opts.run, 1) % 64;
+        pkts.emplace_back(MakePacket(v4, flow, sizes[idx]));
+        to.emplace_back(
+            net::ExpandV4(ipaddr_ipv4_bits(172, 16, 0, flow)),
+            net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 1)));
+        if (not v4)
+        {
+          to.back().first = huint128_t{uint128_t{0xfd00'0000'0000'0000UL, flow}};
+          to.back().second = huint128_t{uint128_t{0xfd00'0000'0000'0000UL, 1UL}};
+        }
+      }
+      const size_t rounds = std::max<size_t>(opts.packets / pkts.size(), 1);
+
+      std::vector<net::AddressRewrite> batch;
+      for (size_t idx = 0; idx < pkts.size(); ++idx)
+        batch.push_back(net::AddressRewrite{&pkts[idx], to[idx].first, to[idx].second});
+
+      const auto time = [&](std::string name, auto&& rewrite) {
+        const auto started = Clock_t::now();
+        for (size_t round = 0; round < rounds; ++round)
+          rewrite();
+        const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+        auto result = Result("ip_rewrite");
+        result["impl"] = std::move(name);
+        result["family"] = v4 ? "ipv4" : "ipv6";
+        result["run"] = opts.run;
+        result["packets"] = rounds * pkts.size();
+        result["pps"] = rounds * pkts.size() / elapsed.count();
+        Emit(result);
+      };
+      time("each", [&]() {
+        for (size_t idx = 0; idx < pkts.size(); ++idx)
+        {
+          if (v4)
+            pkts[idx].UpdateIPv4Address(
+                xhtonl(net::TruncateV6(to[idx].first)), xhtonl(net::TruncateV6(to[idx].second)));
+          else
+            pkts[idx].UpdateIPv6Address(to[idx].first, to[idx].second);
+        }
+      });
+      time("batch", [&]() { net::RewriteAddresses(batch); });
+    }
+  }
+
+  void
+  Usage(const char* exe)
+  {
+    std::cerr << "usage: " << exe
+              << " [--packets N] [--run N] [--only checksum|rewrite]\n"
+                 "\nresults are written to stdout as one json object per line\n";
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  Options opts;
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string arg{argv[idx]};
+    if (arg == "-h" or arg == "--help" or idx + 1 == argc)
+    {
+      Usage(argv[0]);
+      return arg == "-h" or arg == "--help" ? 0 : 1;
+    }
+    const std::string val{argv[++idx]};
+    if (arg == "--packets")
+      opts.packets = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--run")
+      opts.run = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--only")
+      opts.only = val;
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  if (opts.only.empty() or opts.only == "checksum")
+    BenchChecksum(opts);
+  if (opts.only.empty() or opts.only == "rewrite")
+    BenchRewrite(opts);
+  return 0;
+}
@@ -0,0 +1,244 @@
+// micro-benchmarks for the k closest lookups the dht does for every find and publish: the nearest
+// keys in a dht::Bucket that are not excluded, and the closest rcs in the nodedb.  once with the
+// linear scans they used to do, a whole bucket per key wanted and a partial sort of every rc, and
+// once with dht::VisitClosest as they are now.  every result is printed as one json object per
+// line on stdout so runs can be diffed across commits.
+
+#include <llarp/constants/version.hpp>
+#include <llarp/dht/bucket.hpp>
+#include <llarp/dht/kademlia.hpp>
+#include <llarp/nodedb.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Options
+  {
+    std::vector<size_t> keys{10'000, 100'000};
+    size_t queries = 2'000;
+    size_t near = 4;
+  };
+
+  nlohmann::json
+  Result(std::string bench)
+  {
+    return nlohmann::json{{"bench", std::move(bench)}, {"version", VERSION_FULL}};
+  }
+
+  void
+  Emit(const nlohmann::json& result)
+  {
+    std::cout << result.dump() << std::endl;
+  }
+
+  struct Node
+  {
+    dht::Key_t ID;
+
+    bool
+    operator<(const Node& other) const
+    {
+      return ID < other.ID;
+    }
+
+    util::StatusObject
+    ExtractStatus() const
+    {
+      return {};
+    }
+  };
+
+  template <typename Key>
+  Key
+  RandomKey(std::mt19937_64& rng)
+  {
+    Key key;
+    for (auto& b : key)
+      b = rng();
+    return key;
+  }
+
+  /// the nearest key not excluded the way Bucket::FindCloseExcluding found it, over every key
+  bool
+  ScanCloseExcluding(
+      const std::map<dht::Key_t, Node, dht::XorMetric>& nodes,
+      const dht::Key_t& target,
+      dht::Key_t& result,
+      const std::set<dht::Key_t>& exclude)
+  {
+    dht::Key_t maxdist;
+    maxdist.Fill(0xff);
+    dht::Key_t mindist;
+    mindist.Fill(0xff);
+    for (const auto& item : nodes)
+    {
+      if (exclude.count(item.first))
+        continue;
+      auto curDist = item.first ^ target;
+      if (curDist < mindist)
+      {
+        mindist = curDist;
+        result = item.first;
+      }
+    }
+    return mindist < maxdist;
+  }
+
+  template <typename Query>
+  void
+  Time(nlohmann::json result, size_t queries, Query&& query)
+  {
+    size_t found = 0;
+    const auto started = Clock_t::now();
+    for (size_t idx = 0; idx < queries; ++idx)
+      found += query(idx);
+    const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+    result["queries"] = queries;
+    result["found"] = found;
+    result["queries_per_second"] = queries / elapsed.count();
+    Emit(result);
+  }
+
+  void
+  BenchBucket(const Options& opts, size_t num)
+  {
+    std::mt19937_64 rng{1};
+    const dht::Key_t us = RandomKey<dht::Key_t>(rng);
+    dht::Bucket<Node> bucket{us, [&rng]() { return rng(); }};
+    std::map<dht::Key_t, Node, dht::XorMetric> scanned{dht::XorMetric{us}};
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      const Node node{RandomKey<dht::Key_t>(rng)};
+      bucket.PutNode(node);
+      scanned.emplace(node.ID, node);
+    }
+    std::vector<dht::Key_t> targets;
+    for (size_t idx = 0; idx < 256; ++idx)
+      targets.push_back(RandomKey<dht::Key_t>(rng));
+    // us and whoever asked, as the dht context excludes
+    const std::set<dht::Key_t> exclude{us, RandomKey<dht::Key_t>(rng)};
+
+    const auto result = [&](std::string impl) {
+      auto result = Result("dht_bucket_near");
+      result["impl"] = std::move(impl);
+      result["keys"] = num;
+      result["near"] = opts.near;
+      return result;
+    };
+    // the scans are slow enough at 100k keys that they get fewer queries
+    const size_t scans = std::max<size_t>(opts.queries * 1'000 / num, 1);
+    Time(result("scan"), scans, [&](size_t idx) {
+      std::set<dht::Key_t> found;
+      std::set<dht::Key_t> s{exclude};
+      dht::Key_t peer;
+      for (size_t n = 0; n < opts.near; ++n)
+      {
+        if (not ScanCloseExcluding(scanned, targets[idx % targets.size()], peer, s))
+          break;
+        s.insert(peer);
+        found.insert(peer);
+      }
+      return found.size();
+    });
+    Time(result("xor_index"), opts.queries * 100, [&](size_t idx) {
+      std::set<dht::Key_t> found;
+      bucket.GetManyNearExcluding(targets[idx % targets.size()], found, opts.near, exclude);
+      return found.size();
+    });
+  }
+
+  void
+  BenchNodeDB(const Options& opts, size_t num)
+  {
+    std::mt19937_64 rng{2};
+    NodeDB nodedb;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      RouterContact rc;
+      for (auto& b : rc.pubkey)
+        b = rng();
+      nodedb.Put(std::move(rc));
+    }
+    std::vector<dht::Key_t> targets;
+    for (size_t idx = 0; idx < 256; ++idx)
+      targets.push_back(RandomKey<dht::Key_t>(rng));
+
+    const auto result = [&](std::string impl) {
+      auto result = Result("nodedb_closest");
+      result["impl"] = std::move(impl);
+      result["relays"] = num;
+      result["near"] = opts.near;
+      return result;
+    };
+    const size_t sorts = std::max<size_t>(opts.queries * 1'000 / num, 1);
+    Time(result("partial_sort"), sorts, [&](size_t idx) {
+      std::vector<const RouterContact*> all;
+      nodedb.VisitAll([&all](const auto& rc) { all.push_back(&rc); });
+      const auto mid = all.begin() + std::min(opts.near, all.size());
+      std::partial_sort(
+          all.begin(),
+          mid,
+          all.end(),
+          [compare = dht::XorMetric{targets[idx % targets.size()]}](auto* a, auto* b) {
+            return compare(*a, *b);
+          });
+      std::vector<RouterContact> closest;
+      for (auto itr = all.begin(); itr != mid; ++itr)
+        closest.push_back(**itr);
+      return closest.size();
+    });
+    Time(result("xor_index"), opts.queries * 100, [&](size_t idx) {
+      return nodedb.FindManyClosestTo(targets[idx % targets.size()], opts.near).size();
+    });
+  }
+
+  void
+  Usage(const char* exe)
+  {
+    std::cerr << "usage: " << exe
+              << " [--keys N] [--queries N] [--near N]\n"
+                 "\n--keys runs with just that many keys instead of 10k and 100k\n"
+                 "results are written to stdout as one json object per line\n";
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  Options opts;
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string arg{argv[idx]};
+    if (arg == "-h" or arg == "--help" or idx + 1 == argc)
+    {
+      Usage(argv[0]);
+      return arg == "-h" or arg == "--help" ? 0 : 1;
+    }
+    const std::string val{argv[++idx]};
+    if (arg == "--keys")
+      opts.keys = {std::max<size_t>(std::stoull(val), 1)};
+    else if (arg == "--queries")
+      opts.queries = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--near")
+      opts.near = std::max<size_t>(std::stoull(val), 1);
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  for (const auto num : opts.keys)
+  {
+    BenchBucket(opts, num);
+    BenchNodeDB(opts, num);
+  }
+  return 0;
+}
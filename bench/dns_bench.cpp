@@ -0,0 +1,191 @@
+// micro-benchmarks for answering dns queries: parsing a query off the wire and encoding the reply,
+// through dns::Message as the resolvers do and through the in place MessageView and ReplyBuilder.
+// every result is printed as one json object per line on stdout so runs can be diffed across
+// commits.
+
+#include <llarp/constants/version.hpp>
+#include <llarp/dns/dns.hpp>
+#include <llarp/dns/message.hpp>
+#include <llarp/dns/message_view.hpp>
+#include <llarp/net/ip.hpp>
+#include <llarp/net/net_bits.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Options
+  {
+    size_t queries = 1'000'000;
+    std::string only;
+  };
+
+  /// a query for name with qtype, the way a stub resolver sends one
+  std::vector<byte_t>
+  MakeQuery(std::string_view name, uint16_t qtype)
+  {
+    std::vector<byte_t> wire{0x12, 0x34, 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+    while (not name.empty())
+    {
+      const auto dot = name.find('.');
+      const auto label = name.substr(0, dot);
+      wire.push_back(label.size());
+      wire.insert(wire.end(), label.begin(), label.end());
+      name.remove_prefix(dot == std::string_view::npos ? name.size() : dot + 1);
+    }
+    wire.insert(wire.end(), {0, byte_t(qtype >> 8), byte_t(qtype), 0, dns::qClassIN});
+    return wire;
+  }
+
+  nlohmann::json
+  Result(std::string bench)
+  {
+    return nlohmann::json{{"bench", std::move(bench)}, {"version", VERSION_FULL}};
+  }
+
+  void
+  Emit(const nlohmann::json& result)
+  {
+    std::cout << result.dump() << std::endl;
+  }
+
+  /// answer query n times with answer, which returns the size of the reply it made
+  template <typename Answer_t>
+  double
+  QueriesPerSecond(const std::vector<byte_t>& query, size_t n, Answer_t answer)
+  {
+    size_t bytes = 0;
+    const auto started = Clock_t::now();
+    for (size_t idx = 0; idx < n; ++idx)
+      bytes += answer(byte_view_t{query.data(), query.size()});
+    const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+    if (bytes == 0)
+      std::cerr << "no replies?" << std::endl;
+    return n / elapsed.count();
+  }
+
+  struct Workload
+  {
+    std::string name;
+    uint16_t qtype;
+    std::function<size_t(dns::Message&)> message;
+    std::function<size_t(dns::ReplyBuilder&)> view;
+  };
+
+  void
+  BenchAnswers(const Options& opts)
+  {
+    static const std::string name =
+        "dw68y1xhptqbhcm5s8aaaip6dbopykagig5q5o3k5xx5gnt6j4ny.loki";
+    const auto addr = net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 1));
+    const std::vector<byte_t> rdata{10, 0, 0, 1};
+    const std::vector<Workload> workloads{
+        {"a",
+         dns::qTypeA,
+         [&](dns::Message& msg) {
+           msg.AddINReply(addr, false);
+           return 1;
+         },
+         [&](dns::ReplyBuilder& reply) {
+           return reply.AddRecord(dns::qTypeA, 1, byte_view_t{rdata.data(), rdata.size()});
+         }},
+        {"cname",
+         dns::qTypeCNAME,
+         [&](dns::Message& msg) {
+           msg.AddCNAMEReply("www." + name);
+           return 1;
+         },
+         [&](dns::ReplyBuilder& reply) {
+           return reply.AddNameRecord(dns::qTypeCNAME, 1, "www." + name);
+         }},
+        {"nxdomain",
+         dns::qTypeA,
+         [&](dns::Message& msg) {
+           msg.AddNXReply();
+           return 1;
+         },
+         [&](dns::ReplyBuilder& reply) {
+           reply.SetRCode(dns::flags_RCODENameError);
+           return 1;
+         }},
+    };
+
+    for (const auto& workload : workloads)
+    {
+      if (not opts.only.empty() and opts.only != workload.name)
+        continue;
+      const auto query = MakeQuery(name, workload.qtype);
+      {
+        auto result = Result("dns_answer");
+        result["reply"] = workload.name;
+        result["parser"] = "Message";
+        result["queries"] = opts.queries;
+        result["qps"] = QueriesPerSecond(query, opts.queries, [&](byte_view_t wire) -> size_t {
+          auto msg = dns::MaybeParseDNSMessage(llarp_buffer_t{wire.data(), wire.size()});
+          if (not msg or not workload.message(*msg))
+            return 0;
+          return msg->ToBuffer().sz;
+        });
+        Emit(result);
+      }
+      {
+        auto result = Result("dns_answer");
+        result["reply"] = workload.name;
+        result["parser"] = "MessageView";
+        result["queries"] = opts.queries;
+        result["qps"] = QueriesPerSecond(query, opts.queries, [&](byte_view_t wire) -> size_t {
+          auto view = dns::MessageView::Parse(wire);
+          if (not view)
+            return 0;
+          dns::ReplyBuilder reply{*view};
+          if (not workload.view(reply))
+            return 0;
+          return reply.Finish().sz;
+        });
+        Emit(result);
+      }
+    }
+  }
+
+  void
+  Usage(const char* exe)
+  {
+    std::cerr << "usage: " << exe
+              << " [--queries N] [--only a|cname|nxdomain]\n"
+                 "\nresults are written to stdout as one json object per line\n";
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  Options opts;
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string arg{argv[idx]};
+    if (arg == "-h" or arg == "--help" or idx + 1 == argc)
+    {
+      Usage(argv[0]);
+      return arg == "-h" or arg == "--help" ? 0 : 1;
+    }
+    const std::string val{argv[++idx]};
+    if (arg == "--queries")
+      opts.queries = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--only")
+      opts.only = val;
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  BenchAnswers(opts);
+  return 0;
+}
@@ -0,0 +1,770 @@
+// micro-benchmarks for the iwp link layer.  two routers run in this process, each with its own
+// event loop thread and crypto workers, and talk iwp to each other over a local address.  every
+// result is printed as one json object per line on stdout so runs can be diffed across commits.
+
+#include <llarp/constants/version.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/ev/libuv.hpp>
+#include <llarp/iwp/iwp.hpp>
+#include <llarp/iwp/message_window.hpp>
+#include <llarp/net/net.hpp>
+#include <llarp/router/router.hpp>
+#include <llarp/util/logging.hpp>
+#include <llarp/util/thread/worker_pool.hpp>
+
+#include <nlohmann/json.hpp>
+#include <oxenc/endian.h>
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Options
+  {
+    std::optional<std::string> ip;
+    uint16_t port = 41900;
+    llarp_time_t duration = 2s;
+    std::vector<size_t> sizes{128, 1024, 4096, MAX_LINK_MSG_SIZE};
+    std::vector<double> losses{0, 0.01, 0.05};
+    size_t handshakes = 64;
+    size_t window = 256;
+    size_t workers = 2;
+    std::string only;
+  };
+
+  /// udp handle that drops a fraction of what we send so we can bench over a lossy path
+  class LossyUDPHandle final : public UDPHandle
+  {
+    const std::shared_ptr<UDPHandle> m_Inner;
+    const std::atomic<double>& m_Loss;
+
+    bool
+    Drop() const
+    {
+      // sends come from the crypto workers as well as the loop
+      thread_local std::minstd_rand rng{std::random_device{}()};
+      const auto loss = m_Loss.load(std::memory_order_relaxed);
+      return loss > 0 and std::uniform_real_distribution<double>{}(rng) < loss;
+    }
+
+   public:
+    LossyUDPHandle(
+        std::shared_ptr<UDPHandle> inner, ReceiveFunc recv, const std::atomic<double>& loss)
+        : UDPHandle{std::move(recv)}, m_Inner{std::move(inner)}, m_Loss{loss}
+    {}
+
+    bool
+    listen(const SockAddr& addr) override
+    {
+      m_Inner->set_batch_recv(on_recv_batch);
+      return m_Inner->listen(addr);
+    }
+
+    bool
+    send(const SockAddr& dest, const llarp_buffer_t& buf) override
+    {
+      return Drop() or m_Inner->send(dest, buf);
+    }
+
+    size_t
+    send_batch(const SockAddr& dest, const std::vector<byte_view_t>& bufs) override
+    {
+      std::vector<byte_view_t> kept;
+      kept.reserve(bufs.size());
+      for (const auto& buf : bufs)
+      {
+        if (not Drop())
+          kept.push_back(buf);
+      }
+      const auto dropped = bufs.size() - kept.size();
+      return dropped + (kept.empty() ? 0 : m_Inner->send_batch(dest, kept));
+    }
+
+    void
+    close() override
+    {
+      m_Inner->close();
+    }
+
+    std::optional<int>
+    file_descriptor() override
+    {
+      return m_Inner->file_descriptor();
+    }
+
+    std::optional<SockAddr>
+    LocalAddr() const override
+    {
+      return m_Inner->LocalAddr();
+    }
+  };
+
+  class BenchLoop : public uv::Loop
+  {
+   public:
+    BenchLoop() : uv::Loop{1024}
+    {}
+
+    /// fraction of outgoing packets to drop
+    std::atomic<double> loss{0};
+
+    std::shared_ptr<UDPHandle>
+    make_udp(UDPReceiveFunc on_recv) override
+    {
+      return std::make_shared<LossyUDPHandle>(uv::Loop::make_udp(on_recv), on_recv, loss);
+    }
+  };
+
+  /// a router identity with a signed rc
+  struct Identity
+  {
+    std::shared_ptr<KeyManager> keys = std::make_shared<KeyManager>();
+    RouterContact rc;
+
+    Identity()
+    {
+      auto crypto = CryptoManager::instance();
+      crypto->identity_keygen(keys->identityKey);
+      crypto->encryption_keygen(keys->encryptionKey);
+      crypto->encryption_keygen(keys->transportKey);
+    }
+
+    RouterID
+    ID() const
+    {
+      return RouterID{keys->identityKey.toPublic().data()};
+    }
+
+    void
+    SignRC(std::optional<AddressInfo> ai)
+    {
+      rc.pubkey = keys->identityKey.toPublic();
+      rc.enckey = keys->encryptionKey.toPublic();
+      rc.addrs.clear();
+      if (ai)
+        rc.addrs.push_back(*ai);
+      rc.last_updated = time_now_ms();
+      if (not rc.Sign(keys->identityKey))
+        throw std::runtime_error{"failed to sign bench rc"};
+    }
+  };
+
+  /// just enough of a router for link layers to run on: an event loop thread of its own, crypto
+  /// workers, and a pump that only pumps our links
+  class BenchRouter : public Router
+  {
+    const std::shared_ptr<BenchLoop> m_Loop;
+    thread::WorkerPool m_Workers;
+    std::shared_ptr<EventLoopWakeup> m_Waker;
+    std::vector<iwp::LinkLayer_ptr> m_Links;
+    std::thread m_Thread;
+
+   public:
+    BenchRouter(std::shared_ptr<BenchLoop> loop, size_t workers)
+        : Router{loop, nullptr}, m_Loop{std::move(loop)}, m_Workers{workers, "bench-crypto"}
+    {
+      m_Waker = m_Loop->make_waker([this]() {
+        for (const auto& link : m_Links)
+          link->Pump();
+      });
+      m_Workers.Start();
+      m_Thread = std::thread{[loop = m_Loop]() { loop->run(); }};
+    }
+
+    ~BenchRouter() override
+    {
+      Sync([this]() {
+        for (const auto& link : m_Links)
+          link->Stop();
+        m_Links.clear();
+        m_Waker.reset();
+        return 0;
+      });
+      m_Loop->stop();
+      m_Thread.join();
+      m_Workers.Stop();
+    }
+
+    BenchLoop&
+    Loop()
+    {
+      return *m_Loop;
+    }
+
+    /// run f on our loop and wait for its result
+    template <typename Func_t>
+    auto
+    Sync(Func_t f)
+    {
+      std::packaged_task<decltype(f())()> task{std::move(f)};
+      auto result = task.get_future();
+      m_Loop->call([&task]() { task(); });
+      return result.get();
+    }
+
+    void
+    TriggerPump() override
+    {
+      if (m_Waker)
+        m_Waker->Trigger();
+    }
+
+    void
+    QueueWork(std::function<void(void)> func) override
+    {
+      m_Workers.AddJob(std::move(func));
+    }
+
+    void
+    QueuePinnedWork(uint64_t affinity, std::function<void(void)> func) override
+    {
+      m_Workers.AddJob(affinity, std::move(func));
+    }
+
+    /// make, bind and start a link for ident, must be called on our loop
+    iwp::LinkLayer_ptr
+    AddLink(
+        bool inbound,
+        std::shared_ptr<Identity> ident,
+        SockAddr addr,
+        LinkMessageHandler handler,
+        SessionEstablishedHandler established)
+    {
+      auto link = (inbound ? iwp::NewInboundLink : iwp::NewOutboundLink)(
+          ident->keys,
+          m_Loop,
+          [ident]() -> const RouterContact& { return ident->rc; },
+          std::move(handler),
+          [ident](Signature& sig, const llarp_buffer_t& buf) {
+            return CryptoManager::instance()->sign(sig, ident->keys->identityKey, buf);
+          },
+          nullptr,
+          std::move(established),
+          [](RouterContact, RouterContact) { return true; },
+          [](ILinkSession*) {},
+          [](RouterID) {},
+          []() {},
+          [this](std::function<void(void)> work) { QueueWork(std::move(work)); });
+      link->Bind(this, addr);
+      if (not link->Start())
+        throw std::runtime_error{"failed to start bench link"};
+      m_Links.push_back(link);
+      return link;
+    }
+
+    void
+    RemoveLink(const iwp::LinkLayer_ptr& link)
+    {
+      link->Stop();
+      m_Links.erase(std::remove(m_Links.begin(), m_Links.end(), link), m_Links.end());
+    }
+  };
+
+  uint64_t
+  NowNS()
+  {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock_t::now().time_since_epoch())
+        .count();
+  }
+
+  /// the pth percentile of samples, which get sorted
+  uint64_t
+  Percentile(std::vector<uint64_t>& samples, double p)
+  {
+    if (samples.empty())
+      return 0;
+    std::sort(samples.begin(), samples.end());
+    const auto idx = std::min(samples.size() - 1, static_cast<size_t>(samples.size() * p));
+    return samples[idx];
+  }
+
+  nlohmann::json
+  Result(std::string bench)
+  {
+    return nlohmann::json{{"bench", std::move(bench)}, {"version", VERSION_FULL}};
+  }
+
+  void
+  Emit(const nlohmann::json& result)
+  {
+    std::cout << result.dump() << std::endl;
+  }
+
+  /// poll cond every millisecond until it holds or we give up after timeout
+  template <typename Cond_t>
+  bool
+  WaitFor(Cond_t cond, std::chrono::milliseconds timeout)
+  {
+    const auto deadline = Clock_t::now() + timeout;
+    while (not cond())
+    {
+      if (Clock_t::now() >= deadline)
+        return false;
+      std::this_thread::sleep_for(1ms);
+    }
+    return true;
+  }
+
+  /// messages from one transfer run carry its id and the time they were sent
+  struct Receiver
+  {
+    std::atomic<uint64_t> run{0};
+    // only touched on the server loop
+    std::vector<uint64_t> latencies;
+    uint64_t delivered = 0;
+    uint64_t bytes = 0;
+    Clock_t::time_point last;
+
+    bool
+    HandleMessage(const llarp_buffer_t& buf)
+    {
+      if (buf.sz < 16 or oxenc::load_host_to_little<uint64_t>(buf.base) != run.load())
+        return true;
+      latencies.push_back(NowNS() - oxenc::load_host_to_little<uint64_t>(buf.base + 8));
+      delivered++;
+      bytes += buf.sz;
+      last = Clock_t::now();
+      return true;
+    }
+  };
+
+  /// keeps up to `window` messages of one size in flight for as long as running is set, all on
+  /// the client loop
+  struct Sender
+  {
+    iwp::LinkLayer_ptr link;
+    RouterID remote;
+    size_t window;
+    size_t size = 0;
+    uint64_t run = 0;
+    bool running = false;
+    bool filling = false;
+    size_t outstanding = 0;
+    uint64_t sent = 0;
+    uint64_t acked = 0;
+    uint64_t dropped = 0;
+
+    void
+    Fill()
+    {
+      // a full send queue fails sends with a completion from inside SendTo
+      if (filling)
+        return;
+      filling = true;
+      std::vector<byte_t> msg(size);
+      while (running and outstanding < window)
+      {
+        if (not link->HasSessionTo(remote))
+        {
+          running = false;
+          break;
+        }
+        oxenc::write_host_as_little(run, msg.data());
+        oxenc::write_host_as_little(NowNS(), msg.data() + 8);
+        outstanding++;
+        sent++;
+        const llarp_buffer_t buf{msg};
+        if (not link->SendTo(
+                remote,
+                buf,
+                [this](ILinkSession::DeliveryStatus st) {
+                  outstanding--;
+                  if (st == ILinkSession::DeliveryStatus::eDeliverySuccess)
+                    acked++;
+                  else
+                    dropped++;
+                  Fill();
+                },
+                0))
+          break;
+      }
+      filling = false;
+    }
+  };
+
+  void
+  BenchTransfer(
+      const Options& opts,
+      BenchRouter& server,
+      const std::shared_ptr<Identity>& serverIdent,
+      const SockAddr& serverAddr,
+      BenchRouter& client,
+      const SockAddr& clientAddr)
+  {
+    Receiver receiver;
+    auto serverLink = server.Sync([&]() {
+      return server.AddLink(
+          true,
+          serverIdent,
+          serverAddr,
+          [&receiver](ILinkSession*, const llarp_buffer_t& buf) {
+            return receiver.HandleMessage(buf);
+          },
+          [](ILinkSession*, bool) { return true; });
+    });
+
+    auto clientIdent = std::make_shared<Identity>();
+    clientIdent->SignRC(std::nullopt);
+    std::atomic<bool> established{false};
+    auto clientLink = client.Sync([&]() {
+      auto link = client.AddLink(
+          false,
+          clientIdent,
+          clientAddr,
+          [](ILinkSession*, const llarp_buffer_t&) { return true; },
+          [&established](ILinkSession*, bool) {
+            established = true;
+            return true;
+          });
+      link->TryEstablishTo(serverIdent->rc);
+      return link;
+    });
+    if (not WaitFor([&]() { return established.load(); }, 5s))
+      throw std::runtime_error{"bench client never connected to the server"};
+
+    Sender sender{clientLink, serverIdent->ID(), opts.window};
+    for (const auto loss : opts.losses)
+    {
+      for (const auto size : opts.sizes)
+      {
+        const auto run = sender.run + 1;
+        server.Loop().loss = loss;
+        client.Loop().loss = loss;
+        server.Sync([&]() {
+          receiver.run = run;
+          receiver.latencies.clear();
+          receiver.delivered = 0;
+          receiver.bytes = 0;
+          return 0;
+        });
+        const auto started = Clock_t::now();
+        client.Sync([&]() {
+          sender.size = std::clamp<size_t>(size, 16, MAX_LINK_MSG_SIZE);
+          sender.run = run;
+          sender.sent = sender.acked = sender.dropped = 0;
+          sender.running = true;
+          sender.Fill();
+          return 0;
+        });
+        std::this_thread::sleep_for(opts.duration);
+        client.Sync([&]() {
+          sender.running = false;
+          return 0;
+        });
+        // let whatever is still in flight be delivered or time out
+        WaitFor([&]() { return client.Sync([&]() { return sender.outstanding == 0; }); }, 5s);
+
+        auto result = Result("iwp_transfer");
+        result["size"] = sender.size;
+        result["loss"] = loss;
+        result["window"] = opts.window;
+        client.Sync([&]() {
+          result["sent"] = sender.sent;
+          result["acked"] = sender.acked;
+          result["dropped"] = sender.dropped;
+          return 0;
+        });
+        server.Sync([&]() {
+          const auto elapsed =
+              std::chrono::duration<double>((receiver.delivered ? receiver.last : started) - started)
+                  .count();
+          result["delivered"] = receiver.delivered;
+          result["elapsed_ms"] = elapsed * 1000;
+          result["msgs_per_sec"] = elapsed > 0 ? receiver.delivered / elapsed : 0;
+          result["bytes_per_sec"] = elapsed > 0 ? receiver.bytes / elapsed : 0;
+          result["latency_p50_us"] = Percentile(receiver.latencies, 0.5) / 1000;
+          result["latency_p99_us"] = Percentile(receiver.latencies, 0.99) / 1000;
+          return 0;
+        });
+        Emit(result);
+      }
+    }
+    server.Loop().loss = 0;
+    client.Loop().loss = 0;
+    client.Sync([&]() {
+      client.RemoveLink(clientLink);
+      return 0;
+    });
+    server.Sync([&]() {
+      server.RemoveLink(serverLink);
+      return 0;
+    });
+  }
+
+  void
+  BenchHandshakes(
+      const Options& opts,
+      BenchRouter& server,
+      const std::shared_ptr<Identity>& serverIdent,
+      const SockAddr& serverAddr,
+      BenchRouter& client,
+      const SockAddr& clientAddr)
+  {
+    auto serverLink = server.Sync([&]() {
+      return server.AddLink(
+          true,
+          serverIdent,
+          serverAddr,
+          [](ILinkSession*, const llarp_buffer_t&) { return true; },
+          [](ILinkSession*, bool) { return true; });
+    });
+
+    // every handshake comes from its own identity and socket, made up front so we only time the
+    // handshakes themselves
+    const auto num = opts.handshakes;
+    std::vector<Clock_t::time_point> done(num);
+    std::atomic<size_t> established{0};
+    std::vector<iwp::LinkLayer_ptr> links;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      auto ident = std::make_shared<Identity>();
+      ident->SignRC(std::nullopt);
+      links.push_back(client.Sync([&]() {
+        return client.AddLink(
+            false,
+            ident,
+            clientAddr,
+            [](ILinkSession*, const llarp_buffer_t&) { return true; },
+            [&done, &established, idx](ILinkSession*, bool) {
+              done[idx] = Clock_t::now();
+              established++;
+              return true;
+            });
+      }));
+    }
+
+    const auto started = Clock_t::now();
+    client.Sync([&]() {
+      for (const auto& link : links)
+        link->TryEstablishTo(serverIdent->rc);
+      return 0;
+    });
+    WaitFor([&]() { return established.load() == num; }, 10s);
+
+    auto result = Result("iwp_handshake");
+    result["attempted"] = num;
+    client.Sync([&]() {
+      std::vector<uint64_t> latencies;
+      auto last = started;
+      for (const auto& at : done)
+      {
+        if (at == Clock_t::time_point{})
+          continue;
+        latencies.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(at - started).count());
+        last = std::max(last, at);
+      }
+      const auto elapsed = std::chrono::duration<double>(last - started).count();
+      result["established"] = latencies.size();
+      result["elapsed_ms"] = elapsed * 1000;
+      result["handshakes_per_sec"] = elapsed > 0 ? latencies.size() / elapsed : 0;
+      result["latency_p50_us"] = Percentile(latencies, 0.5);
+      result["latency_p99_us"] = Percentile(latencies, 0.99);
+      for (const auto& link : links)
+        client.RemoveLink(link);
+      return 0;
+    });
+    Emit(result);
+    server.Sync([&]() {
+      server.RemoveLink(serverLink);
+      return 0;
+    });
+  }
+
+  /// what a session keeps per message in flight, roughly
+  struct WindowMsg
+  {
+    uint64_t m_MsgID;
+    std::array<byte_t, 64> data;
+  };
+
+  /// the session pattern: a sliding run of ids in flight, each acked (looked up and erased)
+  /// about when a newer one is added
+  template <typename Insert_t, typename Find_t, typename Erase_t>
+  double
+  WindowNSPerOp(size_t inFlight, size_t ops, Insert_t insert, Find_t find, Erase_t erase)
+  {
+    std::minstd_rand rng{42};
+    for (uint64_t id = 0; id < inFlight; ++id)
+      insert(id);
+    uint64_t found = 0;
+    const auto started = Clock_t::now();
+    for (uint64_t id = inFlight; id < inFlight + ops; ++id)
+    {
+      insert(id);
+      found += find(id - (rng() % inFlight));
+      erase(id - inFlight);
+    }
+    const auto elapsed = std::chrono::duration<double, std::nano>(Clock_t::now() - started);
+    if (found == 0)
+      std::cerr << "nothing found?" << std::endl;
+    return elapsed.count() / ops;
+  }
+
+  void
+  BenchMessageWindow()
+  {
+    static constexpr size_t Ops = 2'000'000;
+    for (const size_t inFlight : {16, 256, 4096})
+    {
+      {
+        iwp::MessageWindow<WindowMsg, MaxSendQueueSize> window;
+        auto result = Result("message_window");
+        result["container"] = "MessageWindow";
+        result["in_flight"] = inFlight;
+        result["ns_per_op"] = WindowNSPerOp(
+            inFlight,
+            Ops,
+            [&](uint64_t id) { window.insert(WindowMsg{id, {}}); },
+            [&](uint64_t id) { return window.find(id) != nullptr; },
+            [&](uint64_t id) { window.erase(id); });
+        Emit(result);
+      }
+      {
+        std::map<uint64_t, WindowMsg> window;
+        auto result = Result("message_window");
+        result["container"] = "std::map";
+        result["in_flight"] = inFlight;
+        result["ns_per_op"] = WindowNSPerOp(
+            inFlight,
+            Ops,
+            [&](uint64_t id) { window.emplace(id, WindowMsg{id, {}}); },
+            [&](uint64_t id) { return window.count(id) != 0; },
+            [&](uint64_t id) { window.erase(id); });
+        Emit(result);
+      }
+    }
+  }
+
+  template <typename T>
+  std::vector<T>
+  ParseList(const std::string& str)
+  {
+    std::vector<T> list;
+    std::istringstream in{str};
+    std::string part;
+    while (std::getline(in, part, ','))
+      list.push_back(static_cast<T>(std::stod(part)));
+    return list;
+  }
+
+  void
+  Usage(const char* exe)
+  {
+    std::cerr << "usage: " << exe
+              << " [--ip ADDR] [--port PORT] [--duration MS] [--sizes N,...] [--loss P,...]"
+                 " [--handshakes N] [--window N] [--workers N]"
+                 " [--only transfer|handshake|window]\n"
+                 "\nresults are written to stdout as one json object per line\n";
+  }
+
+  /// the first non loopback address we have; traffic between two local addresses still goes over
+  /// the loopback device, but the link layer refuses to bind loopback itself
+  std::optional<std::string>
+  DefaultIP()
+  {
+    const auto* net = net::Platform::Default_ptr();
+    if (auto ifname = net->GetBestNetIF(AF_INET))
+    {
+      if (auto addr = net->GetInterfaceAddr(*ifname, AF_INET))
+        return addr->hostString(false);
+    }
+    return std::nullopt;
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  Options opts;
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string arg{argv[idx]};
+    if (arg == "-h" or arg == "--help" or idx + 1 == argc)
+    {
+      Usage(argv[0]);
+      return arg == "-h" or arg == "--help" ? 0 : 1;
+    }
+    const std::string val{argv[++idx]};
+    if (arg == "--ip")
+      opts.ip = val;
+    else if (arg == "--port")
+      opts.port = std::stoul(val);
+    else if (arg == "--duration")
+      opts.duration = llarp_time_t{std::stoull(val)};
+    else if (arg == "--sizes")
+      opts.sizes = ParseList<size_t>(val);
+    else if (arg == "--loss")
+      opts.losses = ParseList<double>(val);
+    else if (arg == "--handshakes")
+      opts.handshakes = std::stoul(val);
+    else if (arg == "--window")
+      opts.window = std::max<size_t>(std::stoul(val), 1);
+    else if (arg == "--workers")
+      opts.workers = std::max<size_t>(std::stoul(val), 1);
+    else if (arg == "--only")
+      opts.only = val;
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+
+  llarp::log::add_sink(llarp::log::Type::Print, "stderr");
+  llarp::log::reset_level(llarp::log::Level::warn);
+
+  llarp::sodium::CryptoLibSodium crypto;
+  llarp::CryptoManager manager{&crypto};
+
+  if (opts.only.empty() or opts.only == "window")
+    BenchMessageWindow();
+  if (opts.only == "window")
+    return 0;
+
+  if (not opts.ip)
+    opts.ip = DefaultIP();
+  if (not opts.ip)
+  {
+    std::cerr << "no non loopback address to bench over, pass one with --ip" << std::endl;
+    return 1;
+  }
+  // our addresses are as likely as not private ones
+  llarp::RouterContact::BlockBogons = false;
+
+  try
+  {
+    auto serverIdent = std::make_shared<Identity>();
+    const llarp::SockAddr serverAddr{*opts.ip, llarp::huint16_t{opts.port}};
+    const llarp::SockAddr clientAddr{*opts.ip, llarp::huint16_t{0}};
+    llarp::AddressInfo ai;
+    ai.fromSockAddr(serverAddr);
+    ai.dialect = "iwp";
+    ai.pubkey = serverIdent->keys->transportKey.toPublic();
+    ai.rank = 1;
+    serverIdent->SignRC(ai);
+
+    BenchRouter server{std::make_shared<BenchLoop>(), opts.workers};
+    BenchRouter client{std::make_shared<BenchLoop>(), opts.workers};
+    if (opts.only.empty() or opts.only == "handshake")
+      BenchHandshakes(opts, server, serverIdent, serverAddr, client, clientAddr);
+    if (opts.only.empty() or opts.only == "transfer")
+      BenchTransfer(opts, server, serverIdent, serverAddr, client, clientAddr);
+  }
+  catch (std::exception& ex)
+  {
+    std::cerr << "bench failed: " << ex.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
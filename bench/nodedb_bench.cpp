@@ -0,0 +1,204 @@
+// micro-benchmarks for picking path hops out of the nodedb, the way path::Builder does for every
+// build: a random endpoint, then random hops that are not excluded, not bad for paths and not on a
+// network another hop is on.  once with a copy and shuffle of every rc per hop and the whole hop
+// set checked for each candidate, as it was, and once with NodeDB::GetRandom and the hop set's
+// networks worked out up front.  every result is printed as one json object per line on stdout so
+// runs can be diffed across commits.
+
+#include <llarp/config/config.hpp>
+#include <llarp/constants/version.hpp>
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/nodedb.hpp>
+#include <llarp/profiling.hpp>
+
+#include <nlohmann/json.hpp>
+
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+  using namespace llarp;
+  using Clock_t = std::chrono::steady_clock;
+
+  struct Options
+  {
+    size_t relays = 2000;
+    size_t builds = 20'000;
+    size_t hops = 4;
+  };
+
+  nlohmann::json
+  Result(std::string bench)
+  {
+    return nlohmann::json{{"bench", std::move(bench)}, {"version", VERSION_FULL}};
+  }
+
+  void
+  Emit(const nlohmann::json& result)
+  {
+    std::cout << result.dump() << std::endl;
+  }
+
+  /// relays spread over a few thousand /16s so some share one, a few of them bad for paths
+  void
+  Populate(NodeDB& nodedb, Profiling& profiling, size_t num)
+  {
+    std::mt19937_64 rng{1};
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      RouterContact rc;
+      for (auto& b : rc.pubkey)
+        b = rng();
+      AddressInfo ai{};
+      ai.ip.s6_addr[10] = 0xff;
+      ai.ip.s6_addr[11] = 0xff;
+      ai.ip.s6_addr[12] = 1 + rng() % 223;
+      ai.ip.s6_addr[13] = rng() % 16;
+      ai.ip.s6_addr[15] = 1;
+      rc.addrs.push_back(ai);
+      if (idx % 20 == 0)
+      {
+        for (int fail = 0; fail < 10; ++fail)
+          profiling.MarkHopFail(rc.pubkey);
+      }
+      nodedb.Put(std::move(rc));
+    }
+  }
+
+  /// pick a random rc by copying and shuffling them all
+  template <typename Filter>
+  std::optional<RouterContact>
+  ShuffleAll(const NodeDB& nodedb, Filter visit)
+  {
+    std::vector<const RouterContact*> rcs;
+    nodedb.VisitAll([&rcs](const auto& rc) { rcs.push_back(&rc); });
+    std::shuffle(rcs.begin(), rcs.end(), CSRNG{});
+    for (const auto* rc : rcs)
+    {
+      if (visit(*rc))
+        return *rc;
+    }
+    return std::nullopt;
+  }
+
+  void
+  BenchHops(const Options& opts)
+  {
+    NodeDB nodedb;
+    Profiling profiling;
+    Populate(nodedb, profiling, opts.relays);
+    PeerSelectionConfig paths{};
+    paths.m_UniqueHopsNetmaskSize = 16;
+    const std::set<RouterID> exclude;
+
+    const auto any = [](const auto&) { return true; };
+
+    const auto time = [&](std::string name, auto&& build) {
+      size_t built = 0;
+      const auto started = Clock_t::now();
+      for (size_t idx = 0; idx < opts.builds; ++idx)
+        built += build();
+      const std::chrono::duration<double> elapsed = Clock_t::now() - started;
+      auto result = Result("path_hops");
+      result["select"] = std::move(name);
+      result["relays"] = opts.relays;
+      result["hops"] = opts.hops;
+      result["built"] = built;
+      result["builds_per_second"] = opts.builds / elapsed.count();
+      Emit(result);
+    };
+
+    time("shuffle", [&]() -> bool {
+      const auto endpoint = ShuffleAll(nodedb, any);
+      std::vector<RouterContact> hops{*ShuffleAll(nodedb, any)};
+      while (hops.size() + 1 < opts.hops)
+      {
+        const auto hop = ShuffleAll(nodedb, [&](const auto& rc) -> bool {
+          if (exclude.count(rc.pubkey))
+            return false;
+          std::set<RouterContact> hopsSet{hops.begin(), hops.end()};
+          hopsSet.insert(*endpoint);
+          if (profiling.IsBadForPath(rc.pubkey, 1))
+            return false;
+          for (const auto& other : hopsSet)
+          {
+            if (other.pubkey == rc.pubkey)
+              return false;
+          }
+          hopsSet.insert(rc);
+          return paths.Acceptable(hopsSet);
+        });
+        if (not hop)
+          return false;
+        hops.push_back(*hop);
+      }
+      return true;
+    });
+
+    time("index", [&]() -> bool {
+      const auto endpoint = nodedb.GetRandom(any);
+      std::vector<RouterContact> hops{*nodedb.GetRandom(any)};
+      while (hops.size() + 1 < opts.hops)
+      {
+        std::set<RouterContact> hopsSet{hops.begin(), hops.end()};
+        hopsSet.insert(*endpoint);
+        std::set<RouterID> chosen;
+        for (const auto& hop : hopsSet)
+          chosen.insert(hop.pubkey);
+        const auto taken = paths.TakenRanges(hopsSet);
+        if (not taken)
+          return false;
+        const auto hop = nodedb.GetRandom([&](const auto& rc) -> bool {
+          if (exclude.count(rc.pubkey) or chosen.count(rc.pubkey))
+            return false;
+          if (profiling.IsBadForPath(rc.pubkey, 1))
+            return false;
+          return paths.Acceptable(*taken, rc);
+        });
+        if (not hop)
+          return false;
+        hops.push_back(*hop);
+      }
+      return true;
+    });
+  }
+
+  void
+  Usage(const char* exe)
+  {
+    std::cerr << "usage: " << exe
+              << " [--relays N] [--builds N] [--hops N]\n"
+                 "\nresults are written to stdout as one json object per line\n";
+  }
+}  // namespace
+
+int
+main(int argc, char* argv[])
+{
+  Options opts;
+  for (int idx = 1; idx < argc; ++idx)
+  {
+    const std::string arg{argv[idx]};
+    if (arg == "-h" or arg == "--help" or idx + 1 == argc)
+    {
+      Usage(argv[0]);
+      return arg == "-h" or arg == "--help" ? 0 : 1;
+    }
+    const std::string val{argv[++idx]};
+    if (arg == "--relays")
+      opts.relays = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--builds")
+      opts.builds = std::max<size_t>(std::stoull(val), 1);
+    else if (arg == "--hops")
+      opts.hops = std::max<size_t>(std::stoull(val), 2);
+    else
+    {
+      Usage(argv[0]);
+      return 1;
+    }
+  }
+  BenchHops(opts);
+  return 0;
+}
@@ -0,0 +1,42 @@
+// feeds whatever libfuzzer comes up with to dns::MessageView, which must either reject it or let
+// us walk all of it and build a reply to it that parses again.
+
+#include <llarp/dns/message_view.hpp>
+
+#include <cstdlib>
+
+using namespace llarp;
+
+// keeps the walks below from being optimised out
+static volatile size_t sink;
+
+extern "C" int
+LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+  const auto view = dns::MessageView::Parse(byte_view_t{data, size});
+  if (not view)
+    return 0;
+
+  size_t total = 0;
+  view->ForEachQuestion(
+      [&total](const dns::QuestionView& q) { total += q.name.ToString().size() + q.qtype; });
+  view->ForEachRecord([&total](const dns::RecordView& rec) {
+    total += rec.name.Length() + rec.rdata.size();
+    if (rec.name.EndsWith(".loki"))
+      ++total;
+  });
+
+  const auto question = view->FirstQuestion();
+  if (not question)
+    return 0;
+  dns::ReplyBuilder builder{*view};
+  builder.AddRecord(question->qtype, 1, view->FirstQuestionBytes());
+  builder.AddNameRecord(5, 1, "www." + question->name.ToString());
+  const auto reply = builder.Finish();
+  const auto again = dns::MessageView::Parse(byte_view_t{reply.buf.get(), reply.sz});
+  if (not again or again->ID() != view->ID() or again->QuestionCount() != 1
+      or not again->FirstQuestion()->name.Equals(question->name.ToString()))
+    std::abort();
+  sink = total;
+  return 0;
+}
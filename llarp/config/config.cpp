@@ -51,6 +51,7 @@ namespace llarp
   {
     constexpr Default DefaultJobQueueSize{1024 * 8};
     constexpr Default DefaultWorkerThreads{0};
+    constexpr Default DefaultCryptoThreads{0};
     constexpr Default DefaultBlockBogons{true};
 
     conf.defineOption<int>(
@@ -179,9 +180,8 @@ namespace llarp
         "worker-threads",
         DefaultWorkerThreads,
         Comment{
-            "The number of threads available for performing cryptographic functions.",
-            "The minimum is one thread, but network performance may increase with more.",
-            "threads. Should not exceed the number of logical CPU cores.",
+            "The number of threads oxenmq runs rpc requests and other background jobs on.",
+            "Cryptographic work has its own threads, see crypto-threads.",
             "0 means use the number of logical CPU cores detected at startup.",
         },
         [this](int arg) {
@@ -191,6 +191,24 @@ namespace llarp
           m_workerThreads = arg;
         });
 
+    conf.defineOption<int>(
+        "router",
+        "crypto-threads",
+        DefaultCryptoThreads,
+        Comment{
+            "The number of threads available for performing cryptographic functions.",
+            "The minimum is one thread, but network performance may increase with more",
+            "threads. Together with worker-threads this should not exceed the number of",
+            "logical CPU cores.",
+            "0 means use the number of logical CPU cores detected at startup.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("crypto-threads must be >= 0");
+
+          m_cryptoThreads = arg;
+        });
+
     // Hidden option because this isn't something that should ever be turned off occasionally when
     // doing dev/testing work.
     conf.defineOption<bool>(
@@ -613,6 +631,30 @@ namespace llarp
         },
         AssignmentAcceptor(m_ifname));
 
+    conf.defineOption<int>(
+        "network",
+        "tun-queues",
+        Default{1},
+        Comment{
+            "Number of queues to open on the interface, each read by its own thread. Only used on",
+            "Linux; more than one lets a busy exit or client spread packet io over several cores.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 64)
+            throw std::invalid_argument{"[network]:tun-queues must be between 1 and 64"};
+          m_TunQueues = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "tun-offload",
+        Default{false},
+        Comment{
+            "Have the kernel hand us TCP as segmentation offloaded super packets of up to 64KiB",
+            "instead of segmenting it first, cutting down the reads we do. Only used on Linux.",
+        },
+        AssignmentAcceptor(m_TunOffload));
+
     conf.defineOption<std::string>(
         "network",
         "ifaddr",
@@ -880,6 +922,20 @@ namespace llarp
           m_hostfiles.emplace_back(std::move(path));
         });
 
+    conf.defineOption<int>(
+        "dns",
+        "cache-size",
+        Default{1024},
+        Comment{
+            "How many dns replies to keep so repeats of a query are answered straight away, for",
+            "as long as the replies' ttls say.  0 turns this off.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument{"[dns]:cache-size cannot be negative"};
+          m_CacheSize = arg;
+        });
+
     // Ignored option (used by the systemd service file to disable resolvconf configuration).
     conf.defineOption<bool>(
         "dns",
@@ -1337,10 +1393,16 @@ namespace llarp
   bool
   PeerSelectionConfig::Acceptable(const std::set<RouterContact>& rcs) const
   {
+    return TakenRanges(rcs).has_value();
+  }
+
+  std::optional<std::set<IPRange>>
+  PeerSelectionConfig::TakenRanges(const std::set<RouterContact>& rcs) const
+  {
+    std::set<IPRange> seenRanges;
     if (m_UniqueHopsNetmaskSize == 0)
-      return true;
+      return seenRanges;
     const auto netmask = netmask_ipv6_bits(96 + m_UniqueHopsNetmaskSize);
-    std::set<IPRange> seenRanges;
     for (const auto& hop : rcs)
     {
       for (const auto& addr : hop.addrs)
@@ -1348,10 +1410,27 @@ namespace llarp
         const auto network_addr = net::In6ToHUInt(addr.ip) & netmask;
         if (auto [it, inserted] = seenRanges.emplace(network_addr, netmask); not inserted)
         {
-          return false;
+          return std::nullopt;
         }
       }
     }
+    return seenRanges;
+  }
+
+  bool
+  PeerSelectionConfig::Acceptable(const std::set<IPRange>& taken, const RouterContact& hop) const
+  {
+    if (m_UniqueHopsNetmaskSize == 0)
+      return true;
+    const auto netmask = netmask_ipv6_bits(96 + m_UniqueHopsNetmaskSize);
+    // the hop's own addresses cannot share a network either
+    std::set<IPRange> ours;
+    for (const auto& addr : hop.addrs)
+    {
+      const IPRange range{net::In6ToHUInt(addr.ip) & netmask, netmask};
+      if (taken.count(range) or not ours.insert(range).second)
+        return false;
+    }
     return true;
   }
 
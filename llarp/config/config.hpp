@@ -66,6 +66,7 @@ namespace llarp
     bool m_blockBogons = false;
 
     int m_workerThreads = -1;
+    int m_cryptoThreads = -1;
     int m_numNetThreads = -1;
 
     size_t m_JobQueueSize = 0;
@@ -102,6 +103,15 @@ namespace llarp
     /// return true if this set of router contacts is acceptable against this config
     bool
     Acceptable(const std::set<RouterContact>& hops) const;
+
+    /// the networks hops take up under the unique hops netmask, or std::nullopt if two of them
+    /// share one.  for checking many candidates for one more hop against the same hops.
+    std::optional<std::set<IPRange>>
+    TakenRanges(const std::set<RouterContact>& hops) const;
+
+    /// return true if hop can join hops taking up the networks in taken
+    bool
+    Acceptable(const std::set<IPRange>& taken, const RouterContact& hop) const;
   };
 
   struct NetworkConfig
@@ -111,6 +121,8 @@ namespace llarp
     std::set<RouterID> m_strictConnect;
     std::string m_ifname;
     IPRange m_ifaddr;
+    size_t m_TunQueues = 1;
+    bool m_TunOffload = false;
 
     std::optional<fs::path> m_keyfile;
     std::string m_endpointType;
@@ -160,6 +172,7 @@ namespace llarp
     std::vector<SockAddr> m_upstreamDNS;
     std::vector<fs::path> m_hostfiles;
     std::optional<SockAddr> m_QueryBind;
+    size_t m_CacheSize = 0;
 
     std::unordered_multimap<std::string, std::string> m_ExtraOpts;
 
@@ -4,4 +4,15 @@ namespace llarp
 {
   /// default queue length for logic jobs
   constexpr std::size_t event_loop_queue_size = 1024;
+
+  /// max number of datagrams read or written per batched udp syscall
+  constexpr std::size_t udp_batch_size = 64;
+  /// size of each datagram slot in the batched udp receive slab
+  constexpr std::size_t udp_batch_slot_size = 2048;
+
+  /// max number of bytes coalesced into one segmentation offloaded (GSO) udp send
+  constexpr std::size_t udp_gso_max_size = 63 * 1024;
+  /// size of each slot in the batched udp receive slab when receive offload (GRO) is enabled, it
+  /// still has udp_batch_size of them
+  constexpr std::size_t udp_gro_slot_size = 64 * 1024;
 }  // namespace llarp
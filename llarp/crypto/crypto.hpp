@@ -6,6 +6,7 @@
 #include <llarp/util/buffer.hpp>
 
 #include <functional>
+#include <vector>
 
 #include <cstdint>
 
@@ -18,6 +19,15 @@
 
 namespace llarp
 {
+  /// a single buffer for Crypto::xchacha20_batch to xor in place with its keystream
+  struct XChaCha20Job
+  {
+    byte_t* buf;
+    size_t sz;
+    const SharedSecret* key;
+    const TunnelNonce* nonce;
+  };
+
   /// library crypto configuration
   struct Crypto
   {
@@ -36,6 +46,11 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher over many independent buffers at once, each with its own key
+    /// and nonce; results are identical to calling xchacha20 on each job in turn
+    virtual bool
+    xchacha20_batch(const std::vector<XChaCha20Job>& jobs) = 0;
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
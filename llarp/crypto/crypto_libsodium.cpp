@@ -1,4 +1,7 @@
 #include "crypto_libsodium.hpp"
+#ifdef LOKINET_AVX2_KERNELS
+#include "xchacha20_avx2.hpp"
+#endif
 #include <sodium/crypto_generichash.h>
 #include <sodium/crypto_sign.h>
 #include <sodium/crypto_scalarmult.h>
@@ -140,6 +143,33 @@ namespace llarp
       return crypto_stream_xchacha20_xor(buff.base, buff.base, buff.sz, n.data(), k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_batch(const std::vector<XChaCha20Job>& jobs)
+    {
+#ifdef LOKINET_AVX2_KERNELS
+      // libsodium's own simd paths only kick in for long buffers, onion layers are mostly a
+      // handful of blocks each so we spread blocks from every job across the vector lanes instead
+      static const bool has_avx2 = [] {
+        const char* disable = std::getenv("AVX2_FORCE_DISABLE");
+        return __builtin_cpu_supports("avx2") and not(disable and std::string{disable} == "1");
+      }();
+      if (jobs.size() > 1 and has_avx2)
+      {
+        avx2::xchacha20_xor_multi(jobs.data(), jobs.size());
+        return true;
+      }
+#endif
+      bool ok = true;
+      for (const auto& job : jobs)
+      {
+        if (crypto_stream_xchacha20_xor(
+                job.buf, job.buf, job.sz, job.nonce->data(), job.key->data())
+            != 0)
+          ok = false;
+      }
+      return ok;
+    }
+
     bool
     CryptoLibSodium::xchacha20_alt(
         const llarp_buffer_t& out, const llarp_buffer_t& in, const SharedSecret& k, const byte_t* n)
@@ -29,6 +29,10 @@ namespace llarp
           const SharedSecret&,
           const byte_t*) override;
 
+      /// xchacha symmetric cipher over many buffers at once
+      bool
+      xchacha20_batch(const std::vector<XChaCha20Job>& jobs) override;
+
       /// path dh creator's side
       bool
       dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
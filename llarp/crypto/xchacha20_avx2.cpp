@@ -0,0 +1,220 @@
+#include "xchacha20_avx2.hpp"
+#include "crypto.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace llarp::avx2
+{
+  namespace
+  {
+    constexpr size_t Lanes = 8;
+    constexpr size_t BlockSize = 64;
+    /// how many jobs we derive subkeys for at once before generating their keystream
+    constexpr size_t JobChunk = 64;
+
+    constexpr std::array<uint32_t, 4> Sigma{0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+    using State = __m256i[16];
+    /// one row per state word, one column per lane
+    using LaneWords = uint32_t[16][Lanes];
+
+    inline __m256i
+    rotl16(__m256i x)
+    {
+      const __m256i mask = _mm256_set_epi8(
+          13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2,
+          13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2);
+      return _mm256_shuffle_epi8(x, mask);
+    }
+
+    inline __m256i
+    rotl8(__m256i x)
+    {
+      const __m256i mask = _mm256_set_epi8(
+          14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3,
+          14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3);
+      return _mm256_shuffle_epi8(x, mask);
+    }
+
+    template <int N>
+    inline __m256i
+    rotl(__m256i x)
+    {
+      return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+    }
+
+    inline void
+    quarter_round(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+      a = _mm256_add_epi32(a, b);
+      d = rotl16(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = rotl<12>(_mm256_xor_si256(b, c));
+      a = _mm256_add_epi32(a, b);
+      d = rotl8(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = rotl<7>(_mm256_xor_si256(b, c));
+    }
+
+    /// the 20 chacha rounds over 8 independent states
+    inline void
+    rounds(State& x)
+    {
+      for (int i = 0; i < 10; ++i)
+      {
+        quarter_round(x[0], x[4], x[8], x[12]);
+        quarter_round(x[1], x[5], x[9], x[13]);
+        quarter_round(x[2], x[6], x[10], x[14]);
+        quarter_round(x[3], x[7], x[11], x[15]);
+        quarter_round(x[0], x[5], x[10], x[15]);
+        quarter_round(x[1], x[6], x[11], x[12]);
+        quarter_round(x[2], x[7], x[8], x[13]);
+        quarter_round(x[3], x[4], x[9], x[14]);
+      }
+    }
+
+    inline uint32_t
+    load32(const uint8_t* ptr)
+    {
+      uint32_t val;
+      std::memcpy(&val, ptr, sizeof(val));
+      return val;
+    }
+
+    inline void
+    load_state(State& x, const LaneWords& in)
+    {
+      for (size_t i = 0; i < 16; ++i)
+        x[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in[i]));
+    }
+
+    inline void
+    store_state(LaneWords& out, const State& x)
+    {
+      for (size_t i = 0; i < 16; ++i)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out[i]), x[i]);
+    }
+
+    /// hchacha20 for up to 8 jobs at once, writing the derived chacha20 keys to subkeys
+    void
+    hchacha20(const XChaCha20Job* jobs, size_t num, std::array<uint32_t, 8>* subkeys)
+    {
+      alignas(32) LaneWords words{};
+      for (size_t lane = 0; lane < num; ++lane)
+      {
+        const uint8_t* key = jobs[lane].key->data();
+        const uint8_t* nonce = jobs[lane].nonce->data();
+        for (size_t i = 0; i < 4; ++i)
+          words[i][lane] = Sigma[i];
+        for (size_t i = 0; i < 8; ++i)
+          words[4 + i][lane] = load32(key + (4 * i));
+        for (size_t i = 0; i < 4; ++i)
+          words[12 + i][lane] = load32(nonce + (4 * i));
+      }
+      State x;
+      load_state(x, words);
+      rounds(x);
+      store_state(words, x);
+      for (size_t lane = 0; lane < num; ++lane)
+      {
+        for (size_t i = 0; i < 4; ++i)
+        {
+          subkeys[lane][i] = words[i][lane];
+          subkeys[lane][4 + i] = words[12 + i][lane];
+        }
+      }
+    }
+
+    /// a single keystream block to generate
+    struct Block
+    {
+      size_t job;
+      uint64_t counter;
+    };
+
+    /// generate up to 8 keystream blocks and xor them into their jobs' buffers
+    void
+    chacha20_blocks(
+        const XChaCha20Job* jobs,
+        const std::array<uint32_t, 8>* subkeys,
+        const Block* blocks,
+        size_t num)
+    {
+      alignas(32) LaneWords words{};
+      for (size_t lane = 0; lane < num; ++lane)
+      {
+        const auto& block = blocks[lane];
+        const uint8_t* nonce = jobs[block.job].nonce->data() + 16;
+        for (size_t i = 0; i < 4; ++i)
+          words[i][lane] = Sigma[i];
+        for (size_t i = 0; i < 8; ++i)
+          words[4 + i][lane] = subkeys[block.job][i];
+        words[12][lane] = static_cast<uint32_t>(block.counter);
+        words[13][lane] = static_cast<uint32_t>(block.counter >> 32);
+        words[14][lane] = load32(nonce);
+        words[15][lane] = load32(nonce + 4);
+      }
+      State x, orig;
+      load_state(orig, words);
+      for (size_t i = 0; i < 16; ++i)
+        x[i] = orig[i];
+      rounds(x);
+      for (size_t i = 0; i < 16; ++i)
+        x[i] = _mm256_add_epi32(x[i], orig[i]);
+      store_state(words, x);
+
+      for (size_t lane = 0; lane < num; ++lane)
+      {
+        const auto& block = blocks[lane];
+        const auto& job = jobs[block.job];
+        uint8_t keystream[BlockSize];
+        for (size_t i = 0; i < 16; ++i)
+          std::memcpy(keystream + (4 * i), &words[i][lane], 4);
+        const size_t offset = block.counter * BlockSize;
+        const size_t len = std::min(BlockSize, job.sz - offset);
+        uint8_t* ptr = job.buf + offset;
+        for (size_t i = 0; i < len; ++i)
+          ptr[i] ^= keystream[i];
+      }
+    }
+  }  // namespace
+
+  void
+  xchacha20_xor_multi(const XChaCha20Job* jobs, size_t num)
+  {
+    std::array<std::array<uint32_t, 8>, JobChunk> subkeys;
+    std::array<Block, Lanes> blocks;
+    while (num > 0)
+    {
+      const size_t chunk = std::min(num, JobChunk);
+      for (size_t idx = 0; idx < chunk; idx += Lanes)
+        hchacha20(jobs + idx, std::min(Lanes, chunk - idx), subkeys.data() + idx);
+
+      // walk every block of every job in this chunk, filling all 8 lanes before running them
+      size_t used = 0;
+      for (size_t idx = 0; idx < chunk; ++idx)
+      {
+        const size_t num_blocks = (jobs[idx].sz + BlockSize - 1) / BlockSize;
+        for (uint64_t counter = 0; counter < num_blocks; ++counter)
+        {
+          blocks[used++] = Block{idx, counter};
+          if (used == Lanes)
+          {
+            chacha20_blocks(jobs, subkeys.data(), blocks.data(), used);
+            used = 0;
+          }
+        }
+      }
+      if (used)
+        chacha20_blocks(jobs, subkeys.data(), blocks.data(), used);
+
+      jobs += chunk;
+      num -= chunk;
+    }
+  }
+}  // namespace llarp::avx2
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+namespace llarp
+{
+  struct XChaCha20Job;
+
+  namespace avx2
+  {
+    /// xor every job's buffer in place with the xchacha20 keystream for its key and nonce.
+    /// keystream blocks from all jobs are computed 8 at a time, one per avx2 lane, so this is
+    /// fastest for many small buffers where a single buffer kernel would leave lanes empty.
+    /// this translation unit is built with -mavx2 so the caller must check the cpu supports avx2.
+    void
+    xchacha20_xor_multi(const XChaCha20Job* jobs, size_t num);
+  }  // namespace avx2
+}  // namespace llarp
@@ -2,6 +2,7 @@
 
 #include "kademlia.hpp"
 #include "key.hpp"
+#include "xor_index.hpp"
 #include <llarp/util/status.hpp>
 
 #include <map>
@@ -15,10 +16,11 @@ namespace llarp
     template <typename Val_t>
     struct Bucket
     {
-      using BucketStorage_t = std::map<Key_t, Val_t, XorMetric>;
+      /// kept in key order, not by distance from us, so VisitClosest can find what is near any key
+      using BucketStorage_t = std::map<Key_t, Val_t>;
       using Random_t = std::function<uint64_t()>;
 
-      Bucket(const Key_t& us, Random_t r) : nodes(XorMetric(us)), random(std::move(r))
+      Bucket(const Key_t&, Random_t r) : random(std::move(r))
       {}
 
       util::StatusObject
@@ -76,17 +78,10 @@ namespace llarp
       bool
       FindClosest(const Key_t& target, Key_t& result) const
       {
-        Key_t mindist;
-        mindist.Fill(0xff);
-        for (const auto& item : nodes)
-        {
-          auto curDist = item.first ^ target;
-          if (curDist < mindist)
-          {
-            mindist = curDist;
-            result = item.first;
-          }
-        }
+        VisitClosest(nodes, target, [&result](const auto& item) {
+          result = item.first;
+          return false;
+        });
         return nodes.size() > 0;
       }
 
@@ -124,27 +119,19 @@ namespace llarp
       bool
       FindCloseExcluding(const Key_t& target, Key_t& result, const std::set<Key_t>& exclude) const
       {
-        Key_t maxdist;
-        maxdist.Fill(0xff);
-        Key_t mindist;
-        mindist.Fill(0xff);
-        for (const auto& item : nodes)
-        {
+        bool found = false;
+        VisitClosest(nodes, target, [&](const auto& item) {
           if (exclude.count(item.first))
-          {
-            continue;
-          }
-
-          auto curDist = item.first ^ target;
-          if (curDist < mindist)
-          {
-            mindist = curDist;
-            result = item.first;
-          }
-        }
-        return mindist < maxdist;
+            return true;
+          result = item.first;
+          found = true;
+          return false;
+        });
+        return found;
       }
 
+      /// put the N closest keys to target that are not excluded into result, false if there are
+      /// not that many
       bool
       GetManyNearExcluding(
           const Key_t& target,
@@ -152,19 +139,17 @@ namespace llarp
           size_t N,
           const std::set<Key_t>& exclude) const
       {
-        std::set<Key_t> s(exclude.begin(), exclude.end());
-
-        Key_t peer;
-        while (N--)
-        {
-          if (!FindCloseExcluding(target, peer, s))
+        if (N == 0)
+          return true;
+        VisitClosest(nodes, target, [&](const auto& item) {
+          if (exclude.count(item.first) == 0)
           {
-            return false;
+            result.insert(item.first);
+            --N;
           }
-          s.insert(peer);
-          result.insert(peer);
-        }
-        return true;
+          return N > 0;
+        });
+        return N == 0;
       }
 
       void
@@ -35,8 +35,8 @@ namespace llarp
         // lookup router
         if (router and router->nodedb()->Has(pk))
           continue;
-        parent->LookupRouter(
-            pk, [router, pk](const auto& res) { router->HandleDHTLookupForExplore(pk, res); });
+        // the lookup checks what it finds and puts it into the nodedb itself
+        parent->LookupRouter(pk, nullptr);
       }
     }
   }  // namespace dht
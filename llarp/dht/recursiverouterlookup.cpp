@@ -44,28 +44,35 @@ namespace llarp
     void
     RecursiveRouterLookup::SendReply()
     {
-      if (valuesFound.size())
-      {
-        RouterContact found;
-        for (const auto& rc : valuesFound)
-        {
-          if (found.OtherIsNewer(rc) && parent->GetRouter()->rcLookupHandler().CheckRC(rc))
-            found = rc;
-        }
-        valuesFound.clear();
-        valuesFound.emplace_back(found);
-      }
-      if (resultHandler)
-      {
-        resultHandler(valuesFound);
-      }
-      if (whoasked.node != parent->OurKey())
-      {
-        parent->DHTSendTo(
-            whoasked.node.as_array(),
-            new GotRouterMessage({}, whoasked.txid, valuesFound, false),
-            false);
-      }
+      // Validate let through only rcs that verify; they go into the nodedb from the crypto
+      // workers, and we are gone by then, so the reply is sent from the hook
+      parent->GetRouter()->rcLookupHandler().CheckRCs(
+          std::move(valuesFound),
+          [ctx = parent, whoasked = whoasked, handler = resultHandler](
+              std::vector<RouterContact> valid) {
+            std::vector<RouterContact> found;
+            if (not valid.empty())
+            {
+              RouterContact newest;
+              for (auto& rc : valid)
+              {
+                if (newest.OtherIsNewer(rc))
+                  newest = std::move(rc);
+              }
+              found.emplace_back(std::move(newest));
+            }
+            if (handler)
+            {
+              handler(found);
+            }
+            if (whoasked.node != ctx->OurKey())
+            {
+              ctx->DHTSendTo(
+                  whoasked.node.as_array(),
+                  new GotRouterMessage({}, whoasked.txid, found, false),
+                  false);
+            }
+          });
     }
   }  // namespace dht
 }  // namespace llarp
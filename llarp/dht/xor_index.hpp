@@ -0,0 +1,75 @@
+#pragma once
+
+#include <llarp/util/aligned.hpp>
+
+#include <iterator>
+#include <vector>
+
+namespace llarp::dht
+{
+  /// visit what is in map, a map from 32 byte keys in key order, closest first by xor distance to
+  /// target, until visit(const value_type&) returns false.
+  ///
+  /// keys in order are the leaves of a binary trie on their bits, and keys sharing a prefix are a
+  /// range of the map.  so we walk the trie over the map: split a range where its keys first
+  /// differ, found with one lower_bound, and go into the half matching target's bit there before
+  /// the other.  the k closest cost O(k log n) however big the map is.
+  template <typename Map_t, typename Visit_t>
+  void
+  VisitClosest(const Map_t& map, const AlignedBuffer<32>& target, Visit_t&& visit)
+  {
+    using Iter_t = typename Map_t::const_iterator;
+    using Key_t = typename Map_t::key_type;
+    constexpr size_t Bits = 32 * 8;
+
+    const auto bit_at = [](const auto& key, size_t bit) -> bool {
+      return (key[bit / 8] >> (7 - bit % 8)) & 1;
+    };
+
+    // ranges still to visit, the nearest last.  all keys in one share every bit before the one
+    // they first differ at, so a range is never split on a bit twice.
+    std::vector<std::pair<Iter_t, Iter_t>> ranges;
+    ranges.emplace_back(map.begin(), map.end());
+    while (not ranges.empty())
+    {
+      const auto [begin, end] = ranges.back();
+      ranges.pop_back();
+      if (begin == end)
+        continue;
+      const auto& first = begin->first;
+      const auto& last = std::prev(end)->first;
+      if (begin == std::prev(end))
+      {
+        if (not visit(*begin))
+          return;
+        continue;
+      }
+
+      // the first and last keys differ first where any two keys in the range do
+      size_t bit = 0;
+      while (bit < Bits and first[bit / 8] == last[bit / 8])
+        bit += 8;
+      while (bit_at(first, bit) == bit_at(last, bit))
+        ++bit;
+
+      // the smallest key with the range's common prefix and a 1 at bit
+      Key_t bound{first};
+      bound[bit / 8] |= byte_t(0x80 >> (bit % 8));
+      bound[bit / 8] &= byte_t(0xff << (7 - bit % 8));
+      for (size_t idx = bit / 8 + 1; idx < 32; ++idx)
+        bound[idx] = 0;
+      const Iter_t mid = map.lower_bound(bound);
+
+      if (bit_at(target, bit))
+      {
+        ranges.emplace_back(begin, mid);
+        ranges.emplace_back(mid, end);
+      }
+      else
+      {
+        ranges.emplace_back(mid, end);
+        ranges.emplace_back(begin, mid);
+      }
+    }
+  }
+}  // namespace llarp::dht
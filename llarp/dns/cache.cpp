@@ -0,0 +1,163 @@
+#include "cache.hpp"
+#include "dns.hpp"
+
+#include <oxenc/endian.h>
+
+#include <algorithm>
+#include <cctype>
+
+namespace llarp::dns
+{
+  namespace
+  {
+    constexpr uint16_t qTypeSOA = 6;
+    constexpr uint16_t flags_Opcode = 0x7800;
+
+    /// a question as a cache key: the name lower cased, then qtype and qclass as they are
+    std::string
+    question_key(byte_view_t question)
+    {
+      std::string key{reinterpret_cast<const char*>(question.data()), question.size()};
+      std::transform(key.begin(), key.end() - 4, key.begin(), [](unsigned char ch) {
+        return std::tolower(ch);
+      });
+      return key;
+    }
+  }  // namespace
+
+  AnswerCache::AnswerCache(size_t maxEntries) : m_MaxEntries{maxEntries}
+  {}
+
+  std::optional<std::string>
+  AnswerCache::QuestionKey(const MessageView& query)
+  {
+    if (query.Fields() & (flags_QR | flags_Opcode))
+      return std::nullopt;
+    // one question and nothing but maybe an edns record after it
+    if (query.QuestionCount() != 1 or query.AnswerCount() != 0 or query.AuthorityCount() != 0
+        or query.AdditionalCount() > 1)
+      return std::nullopt;
+    auto key = question_key(query.FirstQuestionBytes());
+    // the edns record decides what the reply can have in it (rfc 6891): how big it can be, its own
+    // opt record, and with the DO bit dnssec records.  so only a query with the same one, or with
+    // none, gets the same reply.
+    key += '\0';
+    bool other = false;
+    query.ForEachRecord([&](const RecordView& rec) {
+      if (rec.type != qTypeOPT)
+      {
+        other = true;
+        return;
+      }
+      key.back() = 1;
+      byte_t fields[6];
+      oxenc::write_host_as_big(rec.cls, fields);
+      oxenc::write_host_as_big(rec.ttl, fields + 2);
+      key.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+      key.append(reinterpret_cast<const char*>(rec.rdata.data()), rec.rdata.size());
+    });
+    if (other)
+      return std::nullopt;
+    return key;
+  }
+
+  std::optional<OwnedBuffer>
+  AnswerCache::Lookup(const std::string& key, const MessageView& query, llarp_time_t now)
+  {
+    auto itr = m_Entries.find(key);
+    if (itr == m_Entries.end())
+      return std::nullopt;
+    auto& entry = itr->second;
+    if (now >= entry.expires)
+    {
+      Erase(itr);
+      return std::nullopt;
+    }
+    const auto question = query.FirstQuestionBytes();
+    if (question.size() >= key.size())
+      return std::nullopt;
+    m_LRU.splice(m_LRU.end(), m_LRU, entry.lru);
+
+    OwnedBuffer reply{entry.reply.data(), entry.reply.size()};
+    auto* ptr = reply.buf.get();
+    // their id, and their question as they cased it
+    oxenc::write_host_as_big(query.ID(), ptr);
+    std::copy(question.begin(), question.end(), ptr + MessageView::HeaderSize);
+
+    const auto elapsed =
+        static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now - entry.stored)
+                                  .count());
+    for (const auto off : entry.ttls)
+    {
+      const auto ttl = oxenc::load_big_to_host<uint32_t>(ptr + off);
+      oxenc::write_host_as_big(ttl > elapsed ? ttl - elapsed : 0, ptr + off);
+    }
+    return reply;
+  }
+
+  void
+  AnswerCache::Put(const std::string& key, byte_view_t data, llarp_time_t now)
+  {
+    if (m_MaxEntries == 0 or data.size() > 0xffff)
+      return;
+    const auto reply = MessageView::Parse(data);
+    if (not reply or reply->IsQuery() or (reply->Fields() & flags_TC))
+      return;
+    const auto rcode = reply->RCode();
+    if (rcode != flags_RCODENoError and rcode != flags_RCODENameError)
+      return;
+    if (reply->QuestionCount() != 1)
+      return;
+    if (const auto question = question_key(reply->FirstQuestionBytes());
+        key.compare(0, question.size(), question) != 0)
+      return;
+
+    std::vector<uint16_t> ttls;
+    std::optional<uint32_t> positive, negative;
+    reply->ForEachRecord([&](const RecordView& rec) {
+      // the ttl field of an edns record is not a ttl
+      if (rec.type == qTypeOPT)
+        return;
+      ttls.push_back(rec.ttl_offset);
+      if (rec.section == RecordView::Section::Answer)
+        positive = std::min(positive.value_or(rec.ttl), rec.ttl);
+      // rfc 2308: negative replies last as long as the lower of the soa's ttl and its minimum
+      else if (
+          rec.section == RecordView::Section::Authority and rec.type == qTypeSOA
+          and rec.rdata.size() >= 22)
+      {
+        const auto minimum =
+            oxenc::load_big_to_host<uint32_t>(rec.rdata.data() + rec.rdata.size() - 4);
+        negative = std::min({negative.value_or(rec.ttl), rec.ttl, minimum});
+      }
+    });
+
+    llarp_time_t ttl = NegativeTTL;
+    if (rcode == flags_RCODENoError and positive)
+      ttl = std::chrono::seconds{*positive};
+    else if (negative)
+      ttl = std::chrono::seconds{*negative};
+    ttl = std::min<llarp_time_t>(ttl, MaxTTL);
+    if (ttl == 0s)
+      return;
+
+    if (auto itr = m_Entries.find(key); itr != m_Entries.end())
+      Erase(itr);
+    while (m_Entries.size() >= m_MaxEntries)
+      Erase(m_Entries.find(m_LRU.front()));
+
+    auto& entry = m_Entries[key];
+    entry.reply.assign(data.begin(), data.end());
+    entry.ttls = std::move(ttls);
+    entry.stored = now;
+    entry.expires = now + ttl;
+    entry.lru = m_LRU.insert(m_LRU.end(), key);
+  }
+
+  void
+  AnswerCache::Erase(std::unordered_map<std::string, Entry>::iterator itr)
+  {
+    m_LRU.erase(itr->second.lru);
+    m_Entries.erase(itr);
+  }
+}  // namespace llarp::dns
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "message_view.hpp"
+#include <llarp/util/buffer.hpp>
+#include <llarp/util/types.hpp>
+
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::dns
+{
+  /// the dns replies we sent recently, kept as they went out on the wire so a repeat of a query
+  /// can be answered without building a dns::Message or asking a resolver.  replies are kept for
+  /// as long as the lowest ttl in them says; negative replies for as long as their soa record
+  /// says, or NegativeTTL without one.  server failures and truncated replies are not kept.
+  ///
+  /// all of this is only ever touched from the main loop.
+  class AnswerCache
+  {
+   public:
+    /// how long we keep a negative reply without an soa record to tell us
+    static constexpr auto NegativeTTL = 1s;
+    /// longest we keep any reply, whatever its ttl
+    static constexpr auto MaxTTL = 1h;
+
+    explicit AnswerCache(size_t maxEntries);
+
+    /// the key we keep answers to query under: its one question, lower cased, and its edns
+    /// record if it has one.  std::nullopt if query is not a standard query with one question.
+    static std::optional<std::string>
+    QuestionKey(const MessageView& query);
+
+    /// if we have an answer for query, whose key is key, make a copy of it with query's id and
+    /// question, and its ttls counted down by how long we had it
+    std::optional<OwnedBuffer>
+    Lookup(const std::string& key, const MessageView& query, llarp_time_t now);
+
+    /// remember reply as the answer to queries with key, if it is one we can keep
+    void
+    Put(const std::string& key, byte_view_t reply, llarp_time_t now);
+
+    size_t
+    Size() const
+    {
+      return m_Entries.size();
+    }
+
+   private:
+    using LRU_t = std::list<std::string>;
+
+    struct Entry
+    {
+      std::vector<byte_t> reply;
+      /// where the ttls of the records in reply are that we count down
+      std::vector<uint16_t> ttls;
+      llarp_time_t stored;
+      llarp_time_t expires;
+      LRU_t::iterator lru;
+    };
+
+    void
+    Erase(std::unordered_map<std::string, Entry>::iterator itr);
+
+    const size_t m_MaxEntries;
+    std::unordered_map<std::string, Entry> m_Entries;
+    /// least recently used first
+    LRU_t m_LRU;
+  };
+}  // namespace llarp::dns
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "message.hpp"
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp::dns
+{
+  /// the key queries asking the same thing coalesce under: the name exactly as asked, type and
+  /// class of its one question, and what its edns record asks of the reply if it has one.
+  /// std::nullopt if query is not something we would coalesce, i.e. has more or fewer than one
+  /// question or carries answers of its own.
+  inline std::optional<std::string>
+  CoalesceKey(const Message& query)
+  {
+    if (query.questions.size() != 1 or not query.answers.empty())
+      return std::nullopt;
+    const auto& q = query.questions[0];
+    if (query.edns)
+      return fmt::format(
+          "{}/{}/{}/edns/{}/{}",
+          q.qname,
+          q.qtype,
+          q.qclass,
+          query.edns->payload,
+          query.edns->flags);
+    return fmt::format("{}/{}/{}", q.qname, q.qtype, q.qclass);
+  }
+
+  /// the lookups we have in flight, by what they ask.  a query asking the same as one in flight
+  /// waits on that lookup instead of starting its own, and whoever did the lookup answers everyone
+  /// waiting on it when it is done.  a lookup going for longer than the timeout is taken to be lost
+  /// and the next query asking the same starts a new one.
+  ///
+  /// Waiter_t is whatever the user needs to answer a query later.  main loop only.
+  template <typename Waiter_t>
+  class Coalescer
+  {
+   public:
+    struct Lookup
+    {
+      std::string key;
+      llarp_time_t started;
+      std::vector<Waiter_t> waiters;
+    };
+
+    using Lookup_ptr = std::shared_ptr<Lookup>;
+
+    explicit Coalescer(llarp_time_t timeout) : m_Timeout{timeout}
+    {}
+
+    llarp_time_t
+    Timeout() const
+    {
+      return m_Timeout;
+    }
+
+    /// change how long lookups are given from here on, lookups in flight included
+    void
+    SetTimeout(llarp_time_t timeout)
+    {
+      m_Timeout = timeout;
+    }
+
+    /// wait on the lookup in flight for key, returning nullptr.  if there is none start one with
+    /// waiter as the first waiting on it and return it; the caller does the lookup and hands it to
+    /// Finish once done.
+    Lookup_ptr
+    Join(std::string key, Waiter_t waiter, llarp_time_t now)
+    {
+      auto& lookup = m_Lookups[key];
+      if (lookup and lookup->started + m_Timeout > now)
+      {
+        lookup->waiters.emplace_back(std::move(waiter));
+        ++m_Coalesced;
+        return nullptr;
+      }
+      // whoever was waiting on one we gave up on still gets answered if it ever finishes
+      lookup = std::make_shared<Lookup>(Lookup{std::move(key), now, {}});
+      lookup->waiters.emplace_back(std::move(waiter));
+      ++m_Started;
+      return lookup;
+    }
+
+    /// lookup is done, take everyone that was waiting on it to answer.  a second call with the
+    /// same lookup gets nobody.
+    std::vector<Waiter_t>
+    Finish(const Lookup_ptr& lookup)
+    {
+      if (auto itr = m_Lookups.find(lookup->key); itr != m_Lookups.end() and itr->second == lookup)
+        m_Lookups.erase(itr);
+      return std::exchange(lookup->waiters, {});
+    }
+
+    /// how many lookups we started and how many queries waited on one instead
+    util::StatusObject
+    ExtractStatus() const
+    {
+      const auto total = m_Started + m_Coalesced;
+      return util::StatusObject{
+          {"inFlight", m_Lookups.size()},
+          {"lookups", m_Started},
+          {"coalesced", m_Coalesced},
+          {"hitRate", total ? double(m_Coalesced) / total : 0.0}};
+    }
+
+   private:
+    llarp_time_t m_Timeout;
+    std::unordered_map<std::string, Lookup_ptr> m_Lookups;
+    uint64_t m_Started = 0;
+    uint64_t m_Coalesced = 0;
+  };
+}  // namespace llarp::dns
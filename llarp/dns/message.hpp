@@ -47,6 +47,15 @@ namespace llarp
 
     struct Message : public Serialize
     {
+      /// what the edns (opt) record of a query says about the reply it wants, rfc 6891
+      struct EDNS
+      {
+        /// the largest udp payload it takes
+        uint16_t payload;
+        /// extended rcode, version and flags, the DO bit among them, as in the record's ttl
+        uint32_t flags;
+      };
+
       explicit Message(const MessageHeader& hdr);
       explicit Message(const Question& question);
 
@@ -102,6 +111,8 @@ namespace llarp
       std::vector<ResourceRecord> answers;
       std::vector<ResourceRecord> authorities;
       std::vector<ResourceRecord> additional;
+      /// the query's edns record, which Decode does not read; whoever parsed the query sets it
+      std::optional<EDNS> edns;
     };
 
     std::optional<Message>
@@ -0,0 +1,367 @@
+#include "message_view.hpp"
+#include "dns.hpp"
+
+#include <oxenc/endian.h>
+
+#include <array>
+#include <cctype>
+#include <cstring>
+
+namespace llarp::dns
+{
+  namespace
+  {
+    constexpr size_t MaxNameSize = 255;
+    constexpr size_t MaxLabels = 128;
+
+    bool
+    is_pointer(byte_t len)
+    {
+      return (len & 0xc0) == 0xc0;
+    }
+
+    size_t
+    pointer_target(byte_view_t data, size_t off)
+    {
+      return (size_t(data[off] & 0x3f) << 8) | data[off + 1];
+    }
+
+    bool
+    same_char(char a, char b)
+    {
+      return std::tolower(static_cast<unsigned char>(a))
+          == std::tolower(static_cast<unsigned char>(b));
+    }
+
+    bool
+    same_label(std::string_view a, std::string_view b)
+    {
+      if (a.size() != b.size())
+        return false;
+      for (size_t idx = 0; idx < a.size(); ++idx)
+        if (not same_char(a[idx], b[idx]))
+          return false;
+      return true;
+    }
+
+    /// check the name at off is in bounds and ends, returning the offset just past it.  a
+    /// compression pointer has to point before where the part of the name it ends started, so
+    /// following them always gets us somewhere, and past the header.  so the first name in a
+    /// message, which ReplyBuilder and AnswerCache use as is, can have no pointers at all.
+    std::optional<size_t>
+    check_name(byte_view_t data, size_t off)
+    {
+      std::optional<size_t> end;
+      size_t limit = off;
+      size_t total = 0;
+      while (off < data.size())
+      {
+        const auto len = data[off];
+        if (is_pointer(len))
+        {
+          if (off + 2 > data.size())
+            return std::nullopt;
+          if (not end)
+            end = off + 2;
+          const auto target = pointer_target(data, off);
+          if (target < MessageView::HeaderSize or target >= limit)
+            return std::nullopt;
+          off = limit = target;
+          continue;
+        }
+        // the other two label types never took off
+        if (len > 63)
+          return std::nullopt;
+        total += 1 + len;
+        if (total > MaxNameSize or off + 1 + len > data.size())
+          return std::nullopt;
+        if (len == 0)
+          return end.value_or(off + 1);
+        off += 1 + len;
+      }
+      return std::nullopt;
+    }
+
+    std::string_view
+    trim_dot(std::string_view name)
+    {
+      if (not name.empty() and name.back() == '.')
+        name.remove_suffix(1);
+      return name;
+    }
+  }  // namespace
+
+  size_t
+  NameView::Follow(size_t off) const
+  {
+    while (is_pointer(m_Msg[off]))
+      off = pointer_target(m_Msg, off);
+    return off;
+  }
+
+  size_t
+  NameView::Length() const
+  {
+    size_t len = 0;
+    ForEachLabel([&len](std::string_view label) { len += label.size() + 1; });
+    return len ? len - 1 : 0;
+  }
+
+  std::string
+  NameView::ToString() const
+  {
+    std::string name;
+    name.reserve(Length() + 1);
+    ForEachLabel([&name](std::string_view label) {
+      name += label;
+      name += '.';
+    });
+    return name;
+  }
+
+  bool
+  NameView::EndsWithDotted(std::string_view suffix) const
+  {
+    const auto len = Length();
+    if (suffix.size() > len)
+      return false;
+    // walk the dotted name without making it, comparing from where the suffix would start
+    const size_t start = len - suffix.size();
+    size_t pos = 0;
+    bool matches = true;
+    ForEachLabel([&](std::string_view label) {
+      if (pos > 0)
+      {
+        if (pos >= start and suffix[pos - start] != '.')
+          matches = false;
+        ++pos;
+      }
+      for (const auto ch : label)
+      {
+        if (pos >= start and not same_char(ch, suffix[pos - start]))
+          matches = false;
+        ++pos;
+      }
+    });
+    return matches;
+  }
+
+  bool
+  NameView::EndsWith(std::string_view suffix) const
+  {
+    return EndsWithDotted(trim_dot(suffix));
+  }
+
+  bool
+  NameView::Equals(std::string_view name) const
+  {
+    name = trim_dot(name);
+    return Length() == name.size() and EndsWithDotted(name);
+  }
+
+  std::optional<MessageView>
+  MessageView::Parse(byte_view_t msg)
+  {
+    if (msg.size() < HeaderSize)
+      return std::nullopt;
+    const auto count = [msg](size_t off) { return oxenc::load_big_to_host<uint16_t>(&msg[off]); };
+
+    size_t off = HeaderSize;
+    for (size_t idx = 0; idx < count(4); ++idx)
+    {
+      const auto end = check_name(msg, off);
+      if (not end or *end + 4 > msg.size())
+        return std::nullopt;
+      off = *end + 4;
+    }
+    const auto recordsAt = off;
+    const size_t records = size_t{count(6)} + count(8) + count(10);
+    for (size_t idx = 0; idx < records; ++idx)
+    {
+      const auto end = check_name(msg, off);
+      if (not end or *end + 10 > msg.size())
+        return std::nullopt;
+      off = *end + 10 + count(*end + 8);
+      if (off > msg.size())
+        return std::nullopt;
+    }
+    return MessageView{msg, recordsAt};
+  }
+
+  bool
+  MessageView::IsQuery() const
+  {
+    return not(Fields() & flags_QR);
+  }
+
+  std::optional<QuestionView>
+  MessageView::FirstQuestion() const
+  {
+    if (QuestionCount() == 0)
+      return std::nullopt;
+    const auto end = SkipName(m_Data, HeaderSize);
+    return QuestionView{NameView{m_Data, HeaderSize}, Get16(end), Get16(end + 2)};
+  }
+
+  byte_view_t
+  MessageView::FirstQuestionBytes() const
+  {
+    if (QuestionCount() == 0)
+      return {};
+    const auto end = SkipName(m_Data, HeaderSize) + 4;
+    return m_Data.substr(HeaderSize, end - HeaderSize);
+  }
+
+  uint16_t
+  MessageView::Get16(size_t off) const
+  {
+    return oxenc::load_big_to_host<uint16_t>(m_Data.data() + off);
+  }
+
+  uint32_t
+  MessageView::Get32(size_t off) const
+  {
+    return oxenc::load_big_to_host<uint32_t>(m_Data.data() + off);
+  }
+
+  size_t
+  MessageView::SkipName(byte_view_t data, size_t off)
+  {
+    while (data[off] != 0)
+    {
+      if (is_pointer(data[off]))
+        return off + 2;
+      off += 1 + data[off];
+    }
+    return off + 1;
+  }
+
+  ReplyBuilder::ReplyBuilder(const MessageView& query) : m_Buf{MaxSize}
+  {
+    auto* ptr = m_Buf.buf.get();
+    const auto question = query.FirstQuestionBytes();
+    std::memset(ptr, 0, MessageView::HeaderSize);
+    oxenc::write_host_as_big(query.ID(), ptr);
+    const uint16_t fields = (query.Fields() | flags_QR | flags_AA | flags_RA) & ~flags_TC;
+    oxenc::write_host_as_big(static_cast<uint16_t>(fields & ~0x000f), ptr + 2);
+    m_Size = MessageView::HeaderSize;
+    if (question.empty())
+      return;
+    Put16(4, 1);
+    std::copy(question.begin(), question.end(), ptr + m_Size);
+    m_Size += question.size();
+    m_QuestionNameEnd = m_Size - 4;
+  }
+
+  void
+  ReplyBuilder::SetRCode(uint16_t rcode)
+  {
+    auto* ptr = m_Buf.buf.get() + 2;
+    const auto fields = oxenc::load_big_to_host<uint16_t>(ptr);
+    oxenc::write_host_as_big(static_cast<uint16_t>((fields & ~0x000f) | (rcode & 0x000f)), ptr);
+  }
+
+  void
+  ReplyBuilder::Put16(size_t off, uint16_t val)
+  {
+    oxenc::write_host_as_big(val, m_Buf.buf.get() + off);
+  }
+
+  bool
+  ReplyBuilder::PutRecordHeader(uint16_t type, uint16_t cls, uint32_t ttl)
+  {
+    // the owner is the question's name, which always starts right after the header
+    if (m_QuestionNameEnd == 0)
+      return false;
+    auto* ptr = m_Buf.buf.get() + m_Size;
+    ptr[0] = 0xc0;
+    ptr[1] = MessageView::HeaderSize;
+    oxenc::write_host_as_big(type, ptr + 2);
+    oxenc::write_host_as_big(cls, ptr + 4);
+    oxenc::write_host_as_big(ttl, ptr + 6);
+    m_Size += 10;
+    return true;
+  }
+
+  bool
+  ReplyBuilder::AddRecord(uint16_t type, uint32_t ttl, byte_view_t rdata, uint16_t cls)
+  {
+    if (m_Size + 12 + rdata.size() > MaxSize or not PutRecordHeader(type, cls, ttl))
+      return false;
+    Put16(m_Size, rdata.size());
+    std::copy(rdata.begin(), rdata.end(), m_Buf.buf.get() + m_Size + 2);
+    m_Size += 2 + rdata.size();
+    Put16(6, oxenc::load_big_to_host<uint16_t>(m_Buf.buf.get() + 6) + 1);
+    return true;
+  }
+
+  bool
+  ReplyBuilder::AddNameRecord(uint16_t type, uint32_t ttl, std::string_view name)
+  {
+    if (m_QuestionNameEnd == 0)
+      return false;
+    std::array<std::string_view, MaxLabels> labels;
+    size_t numLabels = 0;
+    name = trim_dot(name);
+    while (not name.empty())
+    {
+      const auto dot = name.find('.');
+      const auto label = name.substr(0, dot);
+      if (label.empty() or label.size() > 63 or numLabels == labels.size())
+        return false;
+      labels[numLabels++] = label;
+      name.remove_prefix(dot == std::string_view::npos ? name.size() : dot + 1);
+    }
+
+    // the question's labels, uncompressed as they are the first name in the message
+    const auto* buf = m_Buf.buf.get();
+    std::array<size_t, MaxLabels> questionLabels;
+    size_t numQuestionLabels = 0;
+    for (size_t off = MessageView::HeaderSize; buf[off] != 0; off += 1 + buf[off])
+      questionLabels[numQuestionLabels++] = off;
+
+    // how many labels at the end we share with the question
+    size_t shared = 0;
+    while (shared < numLabels and shared < numQuestionLabels)
+    {
+      const auto off = questionLabels[numQuestionLabels - 1 - shared];
+      const std::string_view label{reinterpret_cast<const char*>(buf + off + 1), buf[off]};
+      if (not same_label(labels[numLabels - 1 - shared], label))
+        break;
+      ++shared;
+    }
+
+    size_t rdlen = shared ? 2 : 1;
+    for (size_t idx = 0; idx < numLabels - shared; ++idx)
+      rdlen += 1 + labels[idx].size();
+    if (rdlen > MaxNameSize + 1 or m_Size + 12 + rdlen > MaxSize
+        or not PutRecordHeader(type, qClassIN, ttl))
+      return false;
+
+    Put16(m_Size, rdlen);
+    auto* ptr = m_Buf.buf.get() + m_Size + 2;
+    for (size_t idx = 0; idx < numLabels - shared; ++idx)
+    {
+      *ptr++ = labels[idx].size();
+      ptr = std::copy(labels[idx].begin(), labels[idx].end(), ptr);
+    }
+    if (shared)
+    {
+      const auto target = questionLabels[numQuestionLabels - shared];
+      *ptr++ = 0xc0 | (target >> 8);
+      *ptr++ = target & 0xff;
+    }
+    else
+      *ptr++ = 0;
+    m_Size += 2 + rdlen;
+    Put16(6, oxenc::load_big_to_host<uint16_t>(m_Buf.buf.get() + 6) + 1);
+    return true;
+  }
+
+  OwnedBuffer
+  ReplyBuilder::Finish()
+  {
+    m_Buf.sz = m_Size;
+    return std::move(m_Buf);
+  }
+}  // namespace llarp::dns
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <llarp/util/buffer.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace llarp::dns
+{
+  /// a name in a dns message, left where it is in the message's buffer.  its labels are read,
+  /// following any compression pointers, only when asked for.  only valid for as long as the
+  /// buffer it is in, and only made by MessageView, which has already checked it is well formed.
+  class NameView
+  {
+    byte_view_t m_Msg;
+    size_t m_Offset = 0;
+
+    /// where the next label is, following compression pointers, given where the last one ended
+    size_t
+    Follow(size_t off) const;
+
+    /// EndsWith once any trailing dot is off suffix
+    bool
+    EndsWithDotted(std::string_view suffix) const;
+
+   public:
+    NameView() = default;
+
+    NameView(byte_view_t msg, size_t offset) : m_Msg{msg}, m_Offset{offset}
+    {}
+
+    /// call visit with each label of the name in order as a std::string_view
+    template <typename Visit>
+    void
+    ForEachLabel(Visit&& visit) const
+    {
+      for (auto off = Follow(m_Offset); m_Msg[off] != 0; off = Follow(off + 1 + m_Msg[off]))
+        visit(std::string_view{reinterpret_cast<const char*>(m_Msg.data() + off + 1), m_Msg[off]});
+    }
+
+    /// the length of the name dotted, without the trailing dot
+    size_t
+    Length() const;
+
+    /// the name dotted with a trailing dot, the way Question::qname has it
+    std::string
+    ToString() const;
+
+    /// case insensitive check that the dotted name ends with suffix, e.g. ".loki".  a trailing dot
+    /// on suffix is ignored.
+    bool
+    EndsWith(std::string_view suffix) const;
+
+    /// case insensitive check that this is the dotted name, with or without its trailing dot
+    bool
+    Equals(std::string_view name) const;
+  };
+
+  struct QuestionView
+  {
+    NameView name;
+    uint16_t qtype;
+    uint16_t qclass;
+  };
+
+  struct RecordView
+  {
+    enum class Section
+    {
+      Answer,
+      Authority,
+      Additional
+    };
+
+    Section section;
+    NameView name;
+    uint16_t type;
+    uint16_t cls;
+    uint32_t ttl;
+    /// where ttl is in the message
+    size_t ttl_offset;
+    byte_view_t rdata;
+  };
+
+  /// a dns message parsed in place in the buffer it came in: Parse checks every name and record is
+  /// well formed and in bounds, and nothing is copied out until asked for.  only valid for as long
+  /// as that buffer.
+  class MessageView
+  {
+   public:
+    static constexpr size_t HeaderSize = 12;
+
+    static std::optional<MessageView>
+    Parse(byte_view_t msg);
+
+    byte_view_t
+    Data() const
+    {
+      return m_Data;
+    }
+
+    uint16_t
+    ID() const
+    {
+      return Get16(0);
+    }
+
+    uint16_t
+    Fields() const
+    {
+      return Get16(2);
+    }
+
+    /// the response code in the low bits of the fields
+    uint16_t
+    RCode() const
+    {
+      return Fields() & 0x000f;
+    }
+
+    bool
+    IsQuery() const;
+
+    uint16_t
+    QuestionCount() const
+    {
+      return Get16(4);
+    }
+
+    uint16_t
+    AnswerCount() const
+    {
+      return Get16(6);
+    }
+
+    uint16_t
+    AuthorityCount() const
+    {
+      return Get16(8);
+    }
+
+    uint16_t
+    AdditionalCount() const
+    {
+      return Get16(10);
+    }
+
+    /// the first question, std::nullopt if there are none
+    std::optional<QuestionView>
+    FirstQuestion() const;
+
+    /// the first question as it is on the wire, empty if there are none
+    byte_view_t
+    FirstQuestionBytes() const;
+
+    template <typename Visit>
+    void
+    ForEachQuestion(Visit&& visit) const
+    {
+      size_t off = HeaderSize;
+      for (size_t idx = 0; idx < QuestionCount(); ++idx)
+      {
+        const auto end = SkipName(m_Data, off);
+        visit(QuestionView{NameView{m_Data, off}, Get16(end), Get16(end + 2)});
+        off = end + 4;
+      }
+    }
+
+    /// call visit with every answer, authority and additional record in order
+    template <typename Visit>
+    void
+    ForEachRecord(Visit&& visit) const
+    {
+      const size_t answers = AnswerCount();
+      const size_t authorities = AuthorityCount();
+      const size_t records = answers + authorities + AdditionalCount();
+      size_t off = m_RecordsAt;
+      for (size_t idx = 0; idx < records; ++idx)
+      {
+        const auto end = SkipName(m_Data, off);
+        RecordView rec;
+        if (idx < answers)
+          rec.section = RecordView::Section::Answer;
+        else if (idx < answers + authorities)
+          rec.section = RecordView::Section::Authority;
+        else
+          rec.section = RecordView::Section::Additional;
+        rec.name = NameView{m_Data, off};
+        rec.type = Get16(end);
+        rec.cls = Get16(end + 2);
+        rec.ttl = Get32(end + 4);
+        rec.ttl_offset = end + 4;
+        rec.rdata = m_Data.substr(end + 10, Get16(end + 8));
+        off = end + 10 + rec.rdata.size();
+        visit(rec);
+      }
+    }
+
+   private:
+    explicit MessageView(byte_view_t data, size_t recordsAt) : m_Data{data}, m_RecordsAt{recordsAt}
+    {}
+
+    uint16_t
+    Get16(size_t off) const;
+
+    uint32_t
+    Get32(size_t off) const;
+
+    /// the offset just past the name at off, which is known to be well formed
+    static size_t
+    SkipName(byte_view_t data, size_t off);
+
+    byte_view_t m_Data;
+    /// where the answers start
+    size_t m_RecordsAt;
+  };
+
+  /// builds the reply to a query straight into the buffer it is sent in: the query's header and
+  /// first question copied as they are, then records whose names point back at the question's,
+  /// compressed the same way.
+  class ReplyBuilder
+  {
+   public:
+    /// the most we will put in one reply
+    static constexpr size_t MaxSize = 1500;
+
+    /// start a reply to query with no records and no error.  query must have a question.
+    explicit ReplyBuilder(const MessageView& query);
+
+    /// set the response code, e.g. flags_RCODENameError
+    void
+    SetRCode(uint16_t rcode);
+
+    /// add an answer for the question's name with rdata as it is.  returns false, adding nothing,
+    /// if it does not fit.
+    bool
+    AddRecord(uint16_t type, uint32_t ttl, byte_view_t rdata, uint16_t cls = 1);
+
+    /// add an answer for the question's name whose rdata is the dotted name, e.g. a CNAME, PTR or
+    /// NS record, compressing any part of it that it shares with the question.  returns false,
+    /// adding nothing, if it does not fit or name is not a valid name.
+    bool
+    AddNameRecord(uint16_t type, uint32_t ttl, std::string_view name);
+
+    /// the finished reply
+    OwnedBuffer
+    Finish();
+
+   private:
+    bool
+    PutRecordHeader(uint16_t type, uint16_t cls, uint32_t ttl);
+
+    void
+    Put16(size_t off, uint16_t val);
+
+    OwnedBuffer m_Buf;
+    size_t m_Size = 0;
+    /// where the name in the question ends
+    size_t m_QuestionNameEnd = 0;
+  };
+}  // namespace llarp::dns
@@ -2,12 +2,16 @@
 #include <llarp/constants/platform.hpp>
 #include <llarp/constants/apple.hpp>
 #include "dns.hpp"
+#include "coalesce.hpp"
+#include "message_view.hpp"
 #include <iterator>
 #include <llarp/crypto/crypto.hpp>
 #include <array>
 #include <stdexcept>
 #include <utility>
 #include <llarp/ev/udp_handle.hpp>
+#include <llarp/util/time.hpp>
+#include <oxenc/endian.h>
 #include <optional>
 #include <memory>
 #include <unbound.h>
@@ -82,6 +86,48 @@ namespace llarp::dns
     }
   };
 
+  /// keeps the replies sent back through a packet source in our answer cache on the way
+  class CachingPacketSource : public PacketSource_Base
+  {
+    std::shared_ptr<PacketSource_Base> m_Wrapped;
+    std::weak_ptr<AnswerCache> m_Cache;
+    std::string m_Key;
+
+   public:
+    explicit CachingPacketSource(
+        std::shared_ptr<PacketSource_Base> wrapped,
+        std::weak_ptr<AnswerCache> cache,
+        std::string key)
+        : m_Wrapped{std::move(wrapped)}, m_Cache{std::move(cache)}, m_Key{std::move(key)}
+    {}
+
+    bool
+    WouldLoop(const SockAddr& to, const SockAddr& from) const override
+    {
+      return m_Wrapped->WouldLoop(to, from);
+    }
+
+    void
+    SendTo(const SockAddr& to, const SockAddr& from, OwnedBuffer buf) const override
+    {
+      if (auto cache = m_Cache.lock())
+        cache->Put(m_Key, byte_view_t{buf.buf.get(), buf.sz}, time_now_ms());
+      m_Wrapped->SendTo(to, from, std::move(buf));
+    }
+
+    void
+    Stop() override
+    {
+      m_Wrapped->Stop();
+    }
+
+    std::optional<SockAddr>
+    BoundOn() const override
+    {
+      return m_Wrapped->BoundOn();
+    }
+  };
+
   namespace libunbound
   {
     class Resolver;
@@ -107,6 +153,8 @@ namespace llarp::dns
       {}
       std::weak_ptr<Resolver> parent;
       int id{};
+      /// the lookup we did for ourselves and anyone asking the same, if we did one
+      Coalescer<std::shared_ptr<Query>>::Lookup_ptr lookup;
 
       void
       SendReply(llarp::OwnedBuffer replyBuf) override;
@@ -127,6 +175,8 @@ namespace llarp::dns
 
       std::optional<SockAddr> m_LocalAddr;
       std::unordered_set<std::shared_ptr<Query>> m_Pending;
+      /// what we have asked unbound and not heard back on yet; unbound gives up well before this
+      Coalescer<std::shared_ptr<Query>> m_InFlight{30s};
 
       struct ub_result_deleter
       {
@@ -161,14 +211,16 @@ namespace llarp::dns
 
         log::trace(logcat, "queueing dns response from libunbound to userland");
 
-        // rewrite response
+        if (result->answer_len < int(MessageView::HeaderSize))
+        {
+          log::warning(logcat, "Upstream DNS reply too short");
+          query->Cancel();
+          return;
+        }
+
+        // rewrite response, which needs nothing but the id put back
         OwnedBuffer pkt{(const byte_t*)result->answer_packet, (size_t)result->answer_len};
-        llarp_buffer_t buf{pkt};
-        MessageHeader hdr;
-        hdr.Decode(&buf);
-        hdr.id = query->Underlying().hdr_id;
-        buf.cur = buf.base;
-        hdr.Encode(&buf);
+        oxenc::write_host_as_big(query->Underlying().hdr_id, pkt.buf.get());
 
         // send reply
         query->SendReply(std::move(pkt));
@@ -346,6 +398,29 @@ namespace llarp::dns
         m_Pending.erase(query);
       }
 
+      /// send reply, the reply to query, to everyone else that was waiting on query's lookup
+      void
+      AnswerWaiting(const std::shared_ptr<Query>& query, const std::vector<byte_t>& reply)
+      {
+        if (not query->lookup)
+          return;
+        for (const auto& waiter : m_InFlight.Finish(query->lookup))
+        {
+          if (waiter == query)
+            continue;
+          // they asked exactly what query did, so all that differs is the id
+          OwnedBuffer buf{reply.data(), reply.size()};
+          oxenc::write_host_as_big(waiter->Underlying().hdr_id, buf.buf.get());
+          waiter->SendReply(std::move(buf));
+        }
+      }
+
+      util::StatusObject
+      ResolverStatus() const override
+      {
+        return util::StatusObject{{"lookups", m_InFlight.ExtractStatus()}};
+      }
+
       void
       Up(const llarp::DnsConfig& conf)
       {
@@ -524,6 +599,15 @@ namespace llarp::dns
           return true;
         }
 #endif
+        if (auto key = CoalesceKey(query))
+        {
+          tmp->lookup = m_InFlight.Join(std::move(*key), tmp, time_now_ms());
+          if (not tmp->lookup)
+          {
+            log::trace(logcat, "dns from {} to {} waiting on the same query to unbound", from, to);
+            return true;
+          }
+        }
         const auto& q = query.questions[0];
         if (auto err = ub_resolve_async(
                 m_ctx,
@@ -567,6 +651,7 @@ namespace llarp::dns
               self->src->SendTo(self->askerAddr, self->resolverAddr, OwnedBuffer::copy_from(buf));
               // remove query
               parent_ptr->RemovePending(self);
+              parent_ptr->AnswerWaiting(self, buf);
             });
       }
       else
@@ -579,7 +664,10 @@ namespace llarp::dns
       , m_Config{std::move(conf)}
       , m_Platform{CreatePlatform()}
       , m_NetIfIndex{std::move(netif)}
-  {}
+  {
+    if (m_Config.m_CacheSize)
+      m_Cache = std::make_shared<AnswerCache>(m_Config.m_CacheSize);
+  }
 
   std::vector<std::weak_ptr<Resolver_Base>>
   Server::GetAllResolvers() const
@@ -713,6 +801,25 @@ namespace llarp::dns
       m_Platform->set_resolver(m_NetIfIndex, *maybe_addr, all_queries);
   }
 
+  util::StatusObject
+  Server::ExtractStatus() const
+  {
+    util::StatusObject obj{};
+    if (m_Cache)
+      obj["cacheSize"] = m_Cache->Size();
+    util::StatusObject resolvers{};
+    for (const auto& weak : m_Resolvers)
+    {
+      if (auto ptr = weak.lock())
+      {
+        if (auto status = ptr->ResolverStatus(); not status.empty())
+          resolvers[std::string{ptr->ResolverName()}] = std::move(status);
+      }
+    }
+    obj["resolvers"] = resolvers;
+    return obj;
+  }
+
   bool
   Server::MaybeHandlePacket(
       std::shared_ptr<PacketSource_Base> ptr,
@@ -727,32 +834,61 @@ namespace llarp::dns
       return false;
     }
 
-    auto maybe = MaybeParseDNSMessage(buf);
-    if (not maybe)
+    // look it over in place first, so what we turn away or answer here costs no copies
+    const auto view = MessageView::Parse(byte_view_t{buf.buf.get(), buf.sz});
+    if (not view)
     {
       log::warning(logcat, "invalid dns message format from {} to dns listener on {}", from, to);
       return false;
     }
 
-    auto& msg = *maybe;
+    if (m_Cache)
+    {
+      if (auto key = AnswerCache::QuestionKey(*view))
+      {
+        if (auto reply = m_Cache->Lookup(*key, *view, time_now_ms()))
+        {
+          log::trace(logcat, "answering dns from {} to {} from our cache", from, to);
+          ptr->SendTo(from, to, std::move(*reply));
+          return true;
+        }
+        ptr = std::make_shared<CachingPacketSource>(std::move(ptr), m_Cache, std::move(*key));
+      }
+    }
+
     // we don't provide a DoH resolver because it requires verified TLS
     // TLS needs X509/ASN.1-DER and opting into the Root CA Cabal
     // thankfully mozilla added a backdoor that allows ISPs to turn it off
     // so we disable DoH for firefox using mozilla's ISP backdoor
     // see: https://github.com/oxen-io/lokinet/issues/832
-    for (const auto& q : msg.questions)
-    {
+    bool doh_canary = false;
+    view->ForEachQuestion([&doh_canary](const QuestionView& q) {
       // is this firefox looking for their backdoor record?
-      if (q.IsName("use-application-dns.net"))
-      {
-        // yea it is, let's turn off DoH because god is dead.
-        msg.AddNXReply();
-        // press F to pay respects and send it back where it came from
-        ptr->SendTo(from, to, msg.ToBuffer());
-        return true;
-      }
+      doh_canary = doh_canary or q.name.Equals("use-application-dns.net");
+    });
+    if (doh_canary)
+    {
+      // yea it is, let's turn off DoH because god is dead.
+      ReplyBuilder reply{*view};
+      reply.SetRCode(flags_RCODENameError);
+      // press F to pay respects and send it back where it came from
+      ptr->SendTo(from, to, reply.Finish());
+      return true;
     }
 
+    auto maybe = MaybeParseDNSMessage(buf);
+    if (not maybe)
+    {
+      log::warning(logcat, "invalid dns message format from {} to dns listener on {}", from, to);
+      return false;
+    }
+
+    auto& msg = *maybe;
+    view->ForEachRecord([&msg](const RecordView& rec) {
+      if (rec.type == qTypeOPT)
+        msg.edns = Message::EDNS{rec.cls, rec.ttl};
+    });
+
     for (const auto& resolver : m_Resolvers)
     {
       if (auto res_ptr = resolver.lock())
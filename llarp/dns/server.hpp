@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cache.hpp"
 #include "message.hpp"
 #include "platform.hpp"
 #include <llarp/config/config.hpp>
@@ -189,6 +190,14 @@ namespace llarp::dns
     Down()
     {}
 
+    /// anything this resolver has to report for the endpoint status.  The default base
+    /// implementation has nothing.
+    virtual util::StatusObject
+    ResolverStatus() const
+    {
+      return util::StatusObject{};
+    }
+
     /// attempt to handle a dns message
     /// returns true if we consumed this query and it should not be processed again
     virtual bool
@@ -267,6 +276,11 @@ namespace llarp::dns
         const SockAddr& resolver,
         const SockAddr& from,
         llarp::OwnedBuffer buf);
+
+    /// what our cache and resolvers have to report for the endpoint status
+    util::StatusObject
+    ExtractStatus() const;
+
     /// set which dns mode we are in.
     /// true for intercepting all queries. false for just .loki and .snode
     void
@@ -285,6 +299,9 @@ namespace llarp::dns
 
     std::vector<std::weak_ptr<PacketSource_Base>> m_PacketSources;
     std::vector<std::shared_ptr<PacketSource_Base>> m_OwnedPacketSources;
+
+    /// the replies we sent recently, nullptr if we are not keeping them
+    std::shared_ptr<AnswerCache> m_Cache;
   };
 
 }  // namespace llarp::dns
@@ -20,6 +20,7 @@ namespace llarp
 {
   struct SockAddr;
   struct UDPHandle;
+  struct UDPPacket;
 
   namespace vpn
   {
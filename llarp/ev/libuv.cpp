@@ -1,4 +1,5 @@
 #include "libuv.hpp"
+#include <array>
 #include <memory>
 #include <thread>
 #include <type_traits>
@@ -6,10 +7,24 @@
 
 #include <llarp/util/exceptions.hpp>
 #include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
 #include <llarp/vpn/platform.hpp>
 
 #include <uvw.hpp>
 
+#ifdef __linux__
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+#endif
+
 namespace llarp::uv
 {
   std::shared_ptr<uvw::Loop>
@@ -72,6 +87,11 @@ namespace llarp::uv
     bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) override;
 
+#ifdef __linux__
+    size_t
+    send_batch(const SockAddr& dest, const std::vector<byte_view_t>& bufs) override;
+#endif
+
     std::optional<SockAddr>
     LocalAddr() const override
     {
@@ -102,6 +122,35 @@ namespace llarp::uv
 
     void
     reset_handle(uvw::Loop& loop);
+
+#ifdef __linux__
+    // When a batch receiver is set we poll the socket ourselves and drain it with recvmmsg into a
+    // slab that is reused for every read, rather than letting libuv allocate a buffer and invoke a
+    // callback per datagram.  If the kernel supports UDP_GRO the slab slots are sized to hold
+    // coalesced datagrams which we split back up before handing them off.
+    struct alignas(cmsghdr) CMsgBuf
+    {
+      byte_t data[CMSG_SPACE(sizeof(int))];
+    };
+    std::shared_ptr<uvw::PollHandle> batch_poll;
+    std::vector<byte_t> batch_slab;
+    size_t batch_slot_size = udp_batch_slot_size;
+    std::vector<mmsghdr> batch_msgs;
+    std::vector<iovec> batch_iovs;
+    std::vector<sockaddr_storage> batch_addrs;
+    std::vector<CMsgBuf> batch_cmsgs;
+    std::vector<UDPPacket> batch_pkts;
+    bool gro_enabled = false;
+    // set if the kernel accepts UDP_SEGMENT sends on this socket; cleared if a segmented send
+    // fails (e.g. the egress device cannot do it) so that we fall back to one datagram per packet.
+    std::atomic<bool> gso_enabled{false};
+
+    void
+    start_batch_recv();
+
+    void
+    recv_batch();
+#endif
   };
 
   void
@@ -144,6 +193,11 @@ namespace llarp::uv
     m_WakeUp->on<uvw::AsyncEvent>([this](const auto&, auto&) { tick_event_loop(); });
   }
 
+  Loop::~Loop()
+  {
+    stop_netif_queues();
+  }
+
   bool
   Loop::running() const
   {
@@ -219,6 +273,8 @@ namespace llarp::uv
         return call_soon([this] { stop(); });
 
       llarp::LogInfo("stopping event loop");
+      // the queue loops post to us, so they go before anything of ours is closed
+      stop_netif_queues();
       m_Impl->walk([](auto&& handle) {
         if constexpr (!std::is_pointer_v<std::remove_reference_t<decltype(handle)>>)
           handle.close();
@@ -239,6 +295,9 @@ namespace llarp::uv
     return true;
   }
 
+  /// most packets we read from one interface queue before handing them to the event loop
+  static constexpr size_t NetIfQueueBatch = 64;
+
   bool
   Loop::add_network_interface(
       std::shared_ptr<llarp::vpn::NetworkInterface> netif,
@@ -258,9 +317,66 @@ namespace llarp::uv
     if (!handle)
       return false;
 
+#ifdef __linux__
+    // every queue past the first is read on a loop and thread of its own, which hands what it
+    // reads to us in batches.  the kernel keeps each flow on one queue and we run batches in the
+    // order they were read, so packets of a flow reach the handler in order.
+    for (size_t idx = 1; idx < netif->NumQueues(); ++idx)
+    {
+      auto queue = std::make_shared<Loop>(llarp::event_loop_queue_size);
+      auto poll = queue->m_Impl->resource<uvw::PollHandle>(netif->QueuePollFD(idx));
+      if (!poll)
+        return false;
+      poll->on<uvw::PollEvent>([this, netif, handler, idx](const auto&, auto&) {
+        while (m_Run)
+        {
+          std::vector<llarp::net::IPPacket> batch;
+          try
+          {
+            while (batch.size() < NetIfQueueBatch)
+            {
+              auto pkt = netif->ReadQueuePacket(idx);
+              if (pkt.empty())
+                break;
+              batch.emplace_back(std::move(pkt));
+            }
+          }
+          catch (std::error_code& ec)
+          {
+            LogError("failed to read ", netif->Info().ifname, " queue ", idx, ": ", ec.message());
+          }
+          if (batch.empty())
+            return;
+          const bool more = batch.size() == NetIfQueueBatch;
+          const bool posted = try_call_soon([netif, handler, batch = std::move(batch)]() mutable {
+            for (auto& pkt : batch)
+            {
+              if (handler)
+                handler(std::move(pkt));
+            }
+            netif->MaybeWakeUpperLayers();
+          });
+          // the event loop is backed up, shed load here like the kernel would if we did not read
+          if (not posted)
+            LogDebug("dropped packets from ", netif->Info().ifname, " queue ", idx);
+          if (not more)
+            return;
+        }
+      });
+      poll->start(uvw::PollHandle::Event::READABLE);
+      auto thread = std::thread{[queue, name = netif->Info().ifname, idx] {
+        util::SetThreadName(fmt::format("lokinet-{}-{}", name, idx));
+        queue->run();
+      }};
+      m_NetIfQueues.push_back(NetIfQueue{std::move(queue), std::move(thread)});
+    }
+    if (netif->NumQueues() > 1)
+      LogInfo("reading ", netif->Info().ifname, " on ", netif->NumQueues(), " threads");
+#endif
+
     handle->on<event_t>([netif = std::move(netif), handler = std::move(handler)](
                             const event_t&, [[maybe_unused]] auto& handle) {
-      for (auto pkt = netif->ReadNextPacket(); true; pkt = netif->ReadNextPacket())
+      for (auto pkt = netif->ReadQueuePacket(0); true; pkt = netif->ReadQueuePacket(0))
       {
         if (pkt.empty())
           return;
@@ -282,6 +398,30 @@ namespace llarp::uv
     return true;
   }
 
+  void
+  Loop::stop_netif_queues()
+  {
+    for (auto& queue : m_NetIfQueues)
+      queue.loop->stop();
+    for (auto& queue : m_NetIfQueues)
+    {
+      if (queue.thread.joinable())
+        queue.thread.join();
+    }
+    m_NetIfQueues.clear();
+  }
+
+  bool
+  Loop::try_call_soon(std::function<void(void)> f)
+  {
+    if (not m_Run)
+      return false;
+    if (m_LogicCalls.tryPushBack(std::move(f)) != llarp::thread::QueueReturn::Success)
+      return false;
+    m_WakeUp->send();
+    return true;
+  }
+
   void
   Loop::call_soon(std::function<void(void)> f)
   {
@@ -305,6 +445,13 @@ namespace llarp::uv
   void
   UDPHandle::reset_handle(uvw::Loop& loop)
   {
+#ifdef __linux__
+    if (batch_poll)
+    {
+      batch_poll->close();
+      batch_poll.reset();
+    }
+#endif
     if (handle)
       handle->close();
     handle = loop.resource<uvw::UDPHandle>();
@@ -332,11 +479,176 @@ namespace llarp::uv
           fmt::format("failed to bind udp socket on {}: {}", addr, event.what())};
     });
     handle->bind(*static_cast<const sockaddr*>(addr));
-    handle->recv();
+#ifdef __linux__
+    if (on_recv_batch)
+      start_batch_recv();
+    else
+#endif
+      handle->recv();
     handle->erase(err);
     return true;
   }
 
+#ifdef __linux__
+  void
+  UDPHandle::start_batch_recv()
+  {
+    const int fd = handle->fd();
+
+    int val = 0;
+    socklen_t len = sizeof(val);
+    gso_enabled = ::getsockopt(fd, SOL_UDP, UDP_SEGMENT, &val, &len) == 0;
+    val = 1;
+    gro_enabled = ::setsockopt(fd, SOL_UDP, UDP_GRO, &val, sizeof(val)) == 0;
+    LogDebug("udp segmentation offload: gso=", gso_enabled.load(), " gro=", gro_enabled);
+
+    // as many slots either way, so a burst of packets GRO could not coalesce is still read in
+    // one go
+    const size_t num = udp_batch_size;
+    batch_slot_size = gro_enabled ? udp_gro_slot_size : udp_batch_slot_size;
+    batch_slab.resize(num * batch_slot_size);
+    batch_msgs.resize(num);
+    batch_iovs.resize(num);
+    batch_addrs.resize(num);
+    batch_cmsgs.resize(num);
+    batch_pkts.reserve(udp_batch_size);
+
+    batch_poll = handle->loop().resource<uvw::PollHandle>(fd);
+    batch_poll->on<uvw::PollEvent>([this](const auto&, auto&) { recv_batch(); });
+    batch_poll->start(uvw::PollHandle::Event::READABLE);
+  }
+
+  void
+  UDPHandle::recv_batch()
+  {
+    for (size_t idx = 0; idx < batch_msgs.size(); ++idx)
+    {
+      batch_iovs[idx].iov_base = batch_slab.data() + (idx * batch_slot_size);
+      batch_iovs[idx].iov_len = batch_slot_size;
+      auto& hdr = batch_msgs[idx].msg_hdr;
+      hdr = msghdr{};
+      hdr.msg_name = &batch_addrs[idx];
+      hdr.msg_namelen = sizeof(sockaddr_storage);
+      hdr.msg_iov = &batch_iovs[idx];
+      hdr.msg_iovlen = 1;
+      if (gro_enabled)
+      {
+        hdr.msg_control = batch_cmsgs[idx].data;
+        hdr.msg_controllen = sizeof(batch_cmsgs[idx].data);
+      }
+      batch_msgs[idx].msg_len = 0;
+    }
+    const int fd = handle->fd();
+    const int num = ::recvmmsg(fd, batch_msgs.data(), batch_msgs.size(), MSG_DONTWAIT, nullptr);
+    if (num <= 0)
+      return;
+
+    batch_pkts.clear();
+    for (int idx = 0; idx < num; ++idx)
+    {
+      auto& msg = batch_msgs[idx];
+      if (msg.msg_hdr.msg_flags & MSG_TRUNC)
+        continue;
+      const SockAddr from{*reinterpret_cast<const sockaddr*>(&batch_addrs[idx])};
+      const auto* data = static_cast<const byte_t*>(batch_iovs[idx].iov_base);
+      size_t segsize = msg.msg_len;
+      if (gro_enabled)
+      {
+        for (auto* cmsg = CMSG_FIRSTHDR(&msg.msg_hdr); cmsg; cmsg = CMSG_NXTHDR(&msg.msg_hdr, cmsg))
+        {
+          if (cmsg->cmsg_level == SOL_UDP and cmsg->cmsg_type == UDP_GRO)
+          {
+            int gso_size = 0;
+            std::memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            if (gso_size > 0)
+              segsize = gso_size;
+          }
+        }
+      }
+      // split coalesced datagrams back into the packets the remote sent
+      for (size_t pos = 0; pos < msg.msg_len; pos += segsize)
+        batch_pkts.push_back(
+            UDPPacket{from, byte_view_t{data + pos, std::min<size_t>(segsize, msg.msg_len - pos)}});
+    }
+    if (not batch_pkts.empty())
+      on_recv_batch(*this, batch_pkts);
+  }
+
+  size_t
+  UDPHandle::send_batch(const SockAddr& to, const std::vector<byte_view_t>& bufs)
+  {
+    if (not handle)
+      return 0;
+    const int fd = handle->fd();
+    std::array<mmsghdr, udp_batch_size> msgs;
+    std::array<iovec, udp_batch_size> iovs;
+    std::array<CMsgBuf, udp_batch_size> cmsgs;
+    size_t sent = 0;
+    while (sent < bufs.size())
+    {
+      const bool gso = gso_enabled;
+      size_t pos = sent;
+      size_t num_iovs = 0;
+      size_t num_msgs = 0;
+      while (pos < bufs.size() and num_iovs < udp_batch_size)
+      {
+        // With segmentation offload, a run of packets of equal size (where only the last may be
+        // shorter) goes out as one datagram that the kernel splits up for us.
+        const size_t segsize = bufs[pos].size();
+        const size_t first = num_iovs;
+        size_t total = 0;
+        while (pos < bufs.size() and num_iovs < udp_batch_size)
+        {
+          const auto& buf = bufs[pos];
+          if (num_iovs > first
+              and (not gso or buf.size() > segsize or total + buf.size() > udp_gso_max_size))
+            break;
+          iovs[num_iovs].iov_base = const_cast<byte_t*>(buf.data());
+          iovs[num_iovs].iov_len = buf.size();
+          total += buf.size();
+          ++num_iovs;
+          ++pos;
+          if (buf.size() < segsize)
+            break;
+        }
+        auto& hdr = msgs[num_msgs].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = const_cast<sockaddr*>(static_cast<const sockaddr*>(to));
+        hdr.msg_namelen = to.sockaddr_len();
+        hdr.msg_iov = &iovs[first];
+        hdr.msg_iovlen = num_iovs - first;
+        if (hdr.msg_iovlen > 1)
+        {
+          hdr.msg_control = cmsgs[num_msgs].data;
+          hdr.msg_controllen = CMSG_SPACE(sizeof(uint16_t));
+          auto* cmsg = CMSG_FIRSTHDR(&hdr);
+          cmsg->cmsg_level = SOL_UDP;
+          cmsg->cmsg_type = UDP_SEGMENT;
+          cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+          const auto gso_size = static_cast<uint16_t>(segsize);
+          std::memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+        }
+        msgs[num_msgs].msg_len = 0;
+        ++num_msgs;
+      }
+      const int result = ::sendmmsg(fd, msgs.data(), num_msgs, MSG_DONTWAIT);
+      if (result <= 0)
+      {
+        if (gso and msgs[0].msg_hdr.msg_iovlen > 1 and (errno == EIO or errno == EINVAL))
+        {
+          LogWarn("udp segmentation offload send failed, disabling it: ", strerror(errno));
+          gso_enabled = false;
+          continue;
+        }
+        break;
+      }
+      for (int idx = 0; idx < result; ++idx)
+        sent += msgs[idx].msg_hdr.msg_iovlen;
+    }
+    return sent;
+  }
+#endif
+
   bool
   UDPHandle::send(const SockAddr& to, const llarp_buffer_t& buf)
   {
@@ -350,6 +662,15 @@ namespace llarp::uv
   void
   UDPHandle::close()
   {
+#ifdef __linux__
+    if (batch_poll)
+    {
+      batch_poll->close();
+      batch_poll.reset();
+    }
+#endif
+    if (not handle)
+      return;
     handle->close();
     handle.reset();
   }
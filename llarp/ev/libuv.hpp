@@ -25,6 +25,8 @@ namespace llarp::uv
 
     Loop(size_t queue_size);
 
+    ~Loop() override;
+
     virtual void
     run() override;
 
@@ -95,6 +97,23 @@ namespace llarp::uv
 
     std::unordered_map<int, std::shared_ptr<uvw::PollHandle>> m_Polls;
 
+    /// a network interface queue read on a loop of its own
+    struct NetIfQueue
+    {
+      std::shared_ptr<Loop> loop;
+      std::thread thread;
+    };
+    std::vector<NetIfQueue> m_NetIfQueues;
+
+    /// like call_soon, but never blocks: returns false instead if the logic queue is full or we
+    /// are stopping.
+    bool
+    try_call_soon(std::function<void(void)> f);
+
+    /// stop and join all the loops reading our network interface queues
+    void
+    stop_netif_queues();
+
     void
     wakeup() override;
   };
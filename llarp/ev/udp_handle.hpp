@@ -1,12 +1,25 @@
+#pragma once
 #include "ev.hpp"
 #include "../util/buffer.hpp"
+#include <llarp/net/sock_addr.hpp>
+
+#include <vector>
 
 namespace llarp
 {
+  // A single datagram within a received batch.  `data` refers into a receive slab owned by the
+  // UDPHandle and is only valid for the duration of the batch receive callback.
+  struct UDPPacket
+  {
+    SockAddr from;
+    byte_view_t data;
+  };
+
   // Base type for UDP handling; constructed via EventLoop::make_udp().
   struct UDPHandle
   {
     using ReceiveFunc = EventLoop::UDPReceiveFunc;
+    using ReceiveBatchFunc = std::function<void(UDPHandle&, const std::vector<UDPPacket>&)>;
 
     // Starts listening for incoming UDP packets on the given address. Returns true on success,
     // false if the address could not be bound. If you send without calling this first then the
@@ -20,6 +33,31 @@ namespace llarp
     virtual bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) = 0;
 
+    // Sends several packets to the same recipient, immediately.  Implementations that support it
+    // write the whole batch with as few syscalls as possible; the default just calls send() for
+    // each packet.  Returns the number of packets that were sent.
+    virtual size_t
+    send_batch(const SockAddr& dest, const std::vector<byte_view_t>& bufs)
+    {
+      size_t sent = 0;
+      for (const auto& buf : bufs)
+      {
+        if (send(dest, llarp_buffer_t{buf.data(), buf.size()}))
+          sent++;
+      }
+      return sent;
+    }
+
+    // Sets a function to receive datagrams in batches.  Implementations that can read many
+    // datagrams per syscall (i.e. recvmmsg on linux) invoke this instead of the per-packet receive
+    // function; others ignore it and keep using the per-packet function.  Must be called before
+    // listen().
+    void
+    set_batch_recv(ReceiveBatchFunc f)
+    {
+      on_recv_batch = std::move(f);
+    }
+
     // Closes the listening UDP socket (if opened); this is typically called (automatically) during
     // destruction.  Does nothing if the UDP socket is already closed.
     virtual void
@@ -49,5 +87,7 @@ namespace llarp
 
     // Callback to invoke when data is received
     ReceiveFunc on_recv;
+    // Optional callback to invoke when a batch of datagrams is received
+    ReceiveBatchFunc on_recv_batch;
   };
 }  // namespace llarp
@@ -27,6 +27,7 @@ namespace llarp
 
     Endpoint::~Endpoint()
     {
+      m_Parent->UncacheEndpoint(this);
       if (m_CurrentPath)
         m_Parent->DelEndpointInfo(m_CurrentPath->RXID());
     }
@@ -0,0 +1,194 @@
+#include "flow_queue.hpp"
+
+#include <oxenc/endian.h>
+
+#include <algorithm>
+
+namespace llarp::exit
+{
+  std::optional<FlowKey>
+  FlowKey::FromPacket(const net::IPPacket& pkt)
+  {
+    const auto* buf = pkt.data();
+    const auto size = pkt.size();
+    FlowKey key{};
+    size_t l4;
+    bool fragment;
+    if (size >= 20 and pkt.IsV4())
+    {
+      key.proto = buf[9];
+      l4 = size_t{buf[0] & 0x0fu} * 4;
+      // more fragments set or an offset
+      fragment = (oxenc::load_big_to_host<uint16_t>(buf + 6) & 0x3fff) != 0;
+    }
+    else if (size >= 40 and pkt.IsV6())
+    {
+      key.proto = buf[6];
+      l4 = 40;
+      fragment = key.proto == 44;
+    }
+    else
+      return std::nullopt;
+    key.src = pkt.srcv6();
+    key.dst = pkt.dstv6();
+
+    const auto proto = net::IPProtocol{key.proto};
+    if (not fragment and (proto == net::IPProtocol::TCP or proto == net::IPProtocol::UDP)
+        and size >= l4 + 4)
+    {
+      key.srcPort = oxenc::load_big_to_host<uint16_t>(buf + l4);
+      key.dstPort = oxenc::load_big_to_host<uint16_t>(buf + l4 + 2);
+    }
+    return key;
+  }
+
+  std::string
+  FlowKey::ToString() const
+  {
+    return fmt::format("{}:{} -> {}:{} proto {}", src, srcPort, dst, dstPort, int{proto});
+  }
+
+  util::StatusObject
+  FlowQueue::Stats::ExtractStatus() const
+  {
+    return util::StatusObject{{"packets", packets}, {"bytes", bytes}, {"dropped", dropped}};
+  }
+
+  bool
+  FlowQueue::Push(net::IPPacket pkt, llarp_time_t now)
+  {
+    const auto key = FlowKey::FromPacket(pkt);
+    if (not key)
+      return false;
+
+    auto [itr, inserted] = m_Flows.try_emplace(*key);
+    auto& flow = itr->second;
+    if (inserted)
+    {
+      auto& session = m_Sessions[key->dst];
+      session.ip = key->dst;
+      ++session.m_Flows;
+      flow.m_Session = &session;
+    }
+    auto& session = *flow.m_Session;
+    flow.m_LastActive = now;
+    flow.m_Bytes += pkt.size();
+    flow.m_Packets.emplace_back(std::move(pkt));
+    ++m_Queued;
+
+    if (flow.m_Packets.size() == 1)
+      session.m_Active.push_back(&flow);
+    if (not session.m_Scheduled)
+    {
+      session.m_Scheduled = true;
+      m_Scheduled.push_back(&session);
+    }
+
+    if (m_Queued > MaxQueuedPackets)
+      DropFromFattest();
+    return true;
+  }
+
+  net::IPPacket
+  FlowQueue::PopFront(Flow& flow)
+  {
+    auto pkt = std::move(flow.m_Packets.front());
+    flow.m_Packets.pop_front();
+    flow.m_Bytes -= pkt.size();
+    --m_Queued;
+    for (auto* stats : {&flow.m_Stats, &flow.m_Session->m_Stats})
+    {
+      ++stats->packets;
+      stats->bytes += pkt.size();
+    }
+    return pkt;
+  }
+
+  void
+  FlowQueue::DropFromFattest()
+  {
+    // only when we are over, so a scan of what is queued is fine
+    Flow* fattest = nullptr;
+    for (const auto* session : m_Scheduled)
+    {
+      for (auto* flow : session->m_Active)
+      {
+        if (fattest == nullptr or flow->m_Bytes > fattest->m_Bytes)
+          fattest = flow;
+      }
+    }
+    if (fattest == nullptr)
+      return;
+
+    auto& session = *fattest->m_Session;
+    const auto drop = (fattest->m_Packets.size() + 1) / 2;
+    for (size_t idx = 0; idx < drop; ++idx)
+    {
+      fattest->m_Bytes -= fattest->m_Packets.front().size();
+      fattest->m_Packets.pop_front();
+      --m_Queued;
+      ++fattest->m_Stats.dropped;
+      ++session.m_Stats.dropped;
+    }
+    if (not fattest->m_Packets.empty())
+      return;
+
+    fattest->m_Deficit = 0;
+    session.m_Active.erase(std::find(session.m_Active.begin(), session.m_Active.end(), fattest));
+    if (session.m_Active.empty())
+    {
+      session.m_Deficit = 0;
+      session.m_Scheduled = false;
+      m_Scheduled.erase(std::find(m_Scheduled.begin(), m_Scheduled.end(), &session));
+    }
+  }
+
+  void
+  FlowQueue::Uncache(huint128_t ip, const Endpoint* ep)
+  {
+    if (auto itr = m_Sessions.find(ip); itr != m_Sessions.end() and itr->second.endpoint == ep)
+      itr->second.endpoint = nullptr;
+  }
+
+  void
+  FlowQueue::Expire(llarp_time_t now)
+  {
+    for (auto itr = m_Flows.begin(); itr != m_Flows.end();)
+    {
+      auto& flow = itr->second;
+      if (flow.m_Packets.empty() and flow.m_LastActive + IdleTimeout <= now)
+      {
+        --flow.m_Session->m_Flows;
+        itr = m_Flows.erase(itr);
+      }
+      else
+        ++itr;
+    }
+    for (auto itr = m_Sessions.begin(); itr != m_Sessions.end();)
+    {
+      if (itr->second.m_Flows == 0)
+        itr = m_Sessions.erase(itr);
+      else
+        ++itr;
+    }
+  }
+
+  util::StatusObject
+  FlowQueue::ExtractStatus() const
+  {
+    util::StatusObject sessions{};
+    for (const auto& [ip, session] : m_Sessions)
+    {
+      auto obj = session.m_Stats.ExtractStatus();
+      obj["flows"] = util::StatusObject{};
+      sessions[ip.ToString()] = std::move(obj);
+    }
+    for (const auto& [key, flow] : m_Flows)
+    {
+      auto obj = flow.m_Stats.ExtractStatus();
+      obj["queued"] = flow.m_Packets.size();
+      sessions[key.dst.ToString()]["flows"][key.ToString()] = std::move(obj);
+    }
+    return util::StatusObject{{"queued", m_Queued}, {"sessions", sessions}};
+  }
+}  // namespace llarp::exit
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/net_int.hpp>
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace llarp::exit
+{
+  struct Endpoint;
+
+  /// the 5-tuple an ip packet belongs to.  ports are 0 for anything but tcp and udp, and for
+  /// fragments, so that all of a packet's fragments stay in one flow.
+  struct FlowKey
+  {
+    huint128_t src;
+    huint128_t dst;
+    uint16_t srcPort;
+    uint16_t dstPort;
+    uint8_t proto;
+
+    /// std::nullopt if pkt is too short to be an ip packet
+    static std::optional<FlowKey>
+    FromPacket(const net::IPPacket& pkt);
+
+    std::string
+    ToString() const;
+
+    bool
+    operator==(const FlowKey& other) const
+    {
+      return src == other.src and dst == other.dst and srcPort == other.srcPort
+          and dstPort == other.dstPort and proto == other.proto;
+    }
+  };
+}  // namespace llarp::exit
+
+namespace std
+{
+  template <>
+  struct hash<llarp::exit::FlowKey>
+  {
+    size_t
+    operator()(const llarp::exit::FlowKey& key) const
+    {
+      const hash<llarp::huint128_t> h{};
+      return h(key.src) ^ (h(key.dst) << 1)
+          ^ ((size_t{key.srcPort} << 24) | (size_t{key.dstPort} << 8) | key.proto);
+    }
+  };
+}  // namespace std
+
+namespace llarp::exit
+{
+  /// packets from the internet on their way to our exit sessions, queued per flow and sent deficit
+  /// round robin: first across sessions, each getting a quantum of bytes a round, then across the
+  /// flows within a session the same way.  one session's bulk download can then only take its share
+  /// of what we send however many flows it opens, and when we are holding too much it is the flow
+  /// holding the most that loses packets.
+  ///
+  /// a session is everything sent to one of our client addresses.  each carries an exit::Endpoint
+  /// pointer for the sender to look up once and keep, until Uncache says it is gone.
+  ///
+  /// main loop only.
+  class FlowQueue
+  {
+   public:
+    /// most packets we hold across all flows
+    static constexpr size_t MaxQueuedPackets = 4096;
+    /// bytes a session or a flow gets to send each round
+    static constexpr int64_t Quantum = 1500;
+    /// most bytes we send in one go before giving the event loop back
+    static constexpr size_t DrainBudget = 512 * 1024;
+    /// flows and sessions with nothing queued for this long are forgotten
+    static constexpr auto IdleTimeout = 30s;
+
+    struct Stats
+    {
+      uint64_t packets = 0;
+      uint64_t bytes = 0;
+      uint64_t dropped = 0;
+
+      util::StatusObject
+      ExtractStatus() const;
+    };
+
+    struct Flow;
+
+    struct Session
+    {
+      huint128_t ip;
+      /// where we send for this session, nullptr until the sender finds it
+      Endpoint* endpoint = nullptr;
+
+     private:
+      friend class FlowQueue;
+
+      /// flows with packets queued, in the order they get their turn
+      std::deque<Flow*> m_Active;
+      int64_t m_Deficit = 0;
+      bool m_Scheduled = false;
+      size_t m_Flows = 0;
+      Stats m_Stats;
+    };
+
+    struct Flow
+    {
+     private:
+      friend class FlowQueue;
+
+      Session* m_Session = nullptr;
+      std::deque<net::IPPacket> m_Packets;
+      size_t m_Bytes = 0;
+      int64_t m_Deficit = 0;
+      llarp_time_t m_LastActive = 0s;
+      Stats m_Stats;
+    };
+
+    /// queue pkt on its flow.  if that leaves us holding too much the flow holding the most drops
+    /// packets.  returns false if pkt is not an ip packet and was dropped.
+    bool
+    Push(net::IPPacket pkt, llarp_time_t now);
+
+    /// send at most budget bytes, give or take a packet, with send(Session&, net::IPPacket)
+    template <typename Send_t>
+    void
+    Drain(size_t budget, Send_t&& send)
+    {
+      while (budget > 0 and not m_Scheduled.empty())
+      {
+        auto* session = m_Scheduled.front();
+        m_Scheduled.pop_front();
+        session->m_Deficit += Quantum;
+        while (budget > 0 and not session->m_Active.empty())
+        {
+          auto* flow = session->m_Active.front();
+          const auto size = static_cast<int64_t>(flow->m_Packets.front().size());
+          if (flow->m_Deficit < size)
+          {
+            // out of credit for its next packet, it gets more and waits for the others
+            flow->m_Deficit += Quantum;
+            session->m_Active.pop_front();
+            session->m_Active.push_back(flow);
+            continue;
+          }
+          // the session is out of credit for this round
+          if (session->m_Deficit < size)
+            break;
+          flow->m_Deficit -= size;
+          session->m_Deficit -= size;
+          budget -= std::min<size_t>(budget, size);
+          auto pkt = PopFront(*flow);
+          if (flow->m_Packets.empty())
+          {
+            flow->m_Deficit = 0;
+            session->m_Active.pop_front();
+          }
+          send(*session, std::move(pkt));
+        }
+        if (session->m_Active.empty())
+        {
+          session->m_Deficit = 0;
+          session->m_Scheduled = false;
+        }
+        else
+          m_Scheduled.push_back(session);
+      }
+    }
+
+    /// ep is going away, stop handing it out for ip
+    void
+    Uncache(huint128_t ip, const Endpoint* ep);
+
+    /// forget flows and sessions that have been idle too long
+    void
+    Expire(llarp_time_t now);
+
+    /// packets we are holding
+    size_t
+    Queued() const
+    {
+      return m_Queued;
+    }
+
+    /// counts for each session and each flow within it
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    net::IPPacket
+    PopFront(Flow& flow);
+
+    /// drop the oldest half of what the flow holding the most bytes has queued
+    void
+    DropFromFattest();
+
+    std::unordered_map<FlowKey, Flow> m_Flows;
+    std::unordered_map<huint128_t, Session> m_Sessions;
+    /// sessions with packets queued, in the order they get their turn
+    std::deque<Session*> m_Scheduled;
+    size_t m_Queued = 0;
+  };
+}  // namespace llarp::exit
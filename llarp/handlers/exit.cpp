@@ -175,6 +175,7 @@ namespace llarp
         exitsObj[item.first.ToString()] = item.second->ExtractStatus();
       }
       obj["exits"] = exitsObj;
+      obj["flows"] = m_InetFlows.ExtractStatus();
       return obj;
     }
 
@@ -372,64 +373,79 @@ namespace llarp
     void
     ExitEndpoint::Flush()
     {
-      while (not m_InetToNetwork.empty())
-      {
-        auto& top = m_InetToNetwork.top();
-
-        // get a session by public key
-        std::optional<PubKey> maybe_pk;
-        {
-          auto itr = m_IPToKey.find(top.dstv6());
-          if (itr != m_IPToKey.end())
-            maybe_pk = itr->second;
-        }
+      m_InetFlows.Drain(
+          exit::FlowQueue::DrainBudget, [this](exit::FlowQueue::Session& session, auto pkt) {
+            auto buf = pkt.steal();
+            if (auto* ep = session.endpoint)
+            {
+              if (ep->QueueInboundTraffic(std::move(buf), service::ProtocolType::TrafficV4))
+                return;
+              LogWarn(
+                  Name(),
+                  " dropped inbound traffic for session ",
+                  ep->PubKey(),
+                  " as we are overloaded (probably)");
+              // look again next time
+              session.endpoint = nullptr;
+              return;
+            }
 
-        auto buf = const_cast<net::IPPacket&>(top).steal();
-        m_InetToNetwork.pop();
-        // we have no session for public key so drop
-        if (not maybe_pk)
-          continue;  // we are in a while loop
+            // get a session by public key
+            const auto itr = m_IPToKey.find(session.ip);
+            // we have no session for public key so drop
+            if (itr == m_IPToKey.end())
+              return;
+            const auto& pk = itr->second;
 
-        const auto& pk = *maybe_pk;
+            // check if this key is a service node
+            if (m_SNodeKeys.count(pk))
+            {
+              // check if it's a service node session we made and queue it via our
+              // snode session that we made otherwise use an inbound session that
+              // was made by the other service node
+              if (auto snode = m_SNodeSessions.find(pk); snode != m_SNodeSessions.end())
+              {
+                snode->second->SendPacketToRemote(
+                    std::move(buf), service::ProtocolType::TrafficV4);
+                return;
+              }
+            }
+            auto tryFlushingTraffic = [&](exit::Endpoint* const ep) -> bool {
+              if (!ep->QueueInboundTraffic(buf, service::ProtocolType::TrafficV4))
+              {
+                LogWarn(
+                    Name(),
+                    " dropped inbound traffic for session ",
+                    pk,
+                    " as we are overloaded (probably)");
+                // continue iteration
+                return true;
+              }
+              // the rest of this session's packets go straight to it
+              session.endpoint = ep;
+              // break iteration
+              return false;
+            };
+            if (!VisitEndpointsFor(pk, tryFlushingTraffic))
+            {
+              // we may have all dead sessions, wtf now?
+              LogWarn(
+                  Name(),
+                  " dropped inbound traffic for session ",
+                  pk,
+                  " as we have no working endpoints");
+            }
+          });
 
-        // check if this key is a service node
-        if (m_SNodeKeys.count(pk))
-        {
-          // check if it's a service node session we made and queue it via our
-          // snode session that we made otherwise use an inbound session that
-          // was made by the other service node
-          auto itr = m_SNodeSessions.find(pk);
-          if (itr != m_SNodeSessions.end())
-          {
-            itr->second->SendPacketToRemote(std::move(buf), service::ProtocolType::TrafficV4);
-            // we are in a while loop
-            continue;
-          }
-        }
-        auto tryFlushingTraffic =
-            [this, buf = std::move(buf), pk](exit::Endpoint* const ep) -> bool {
-          if (!ep->QueueInboundTraffic(buf, service::ProtocolType::TrafficV4))
-          {
-            LogWarn(
-                Name(),
-                " dropped inbound traffic for session ",
-                pk,
-                " as we are overloaded (probably)");
-            // continue iteration
-            return true;
-          }
-          // break iteration
-          return false;
-        };
-        if (!VisitEndpointsFor(pk, tryFlushingTraffic))
-        {
-          // we may have all dead sessions, wtf now?
-          LogWarn(
-              Name(),
-              " dropped inbound traffic for session ",
-              pk,
-              " as we have no working endpoints");
-        }
+      // the ticker only runs once something else wakes the loop, so come back for what is left
+      // over as soon as the loop has seen to everything else waiting on it
+      if (m_InetFlows.Queued() > 0 and not m_FlushQueued)
+      {
+        m_FlushQueued = true;
+        m_Router->loop()->call_soon([this] {
+          m_FlushQueued = false;
+          Flush();
+        });
       }
 
       for (auto& [pubkey, endpoint] : m_ActiveExits)
@@ -454,13 +470,15 @@ namespace llarp
       const huint128_t ip = GetIfAddr();
       m_KeyToIP[us] = ip;
       m_IPToKey[ip] = us;
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_IPPool.MarkActiveForever(ip);
       m_SNodeKeys.insert(us);
 
       if (m_ShouldInitTun)
       {
         vpn::InterfaceInfo info;
         info.ifname = m_ifname;
+        info.queues = m_TunQueues;
+        info.offload = m_TunOffload;
         info.addrs.emplace_back(m_OurRange);
 
         m_NetIf = GetRouter()->GetVPNPlatform()->CreateInterface(std::move(info), m_Router);
@@ -557,26 +575,20 @@ namespace llarp
     huint128_t
     ExitEndpoint::AllocateNewAddress()
     {
-      if (m_NextAddr < m_HigestAddr)
-        return ++m_NextAddr;
+      const auto now = GetRouter()->Now();
+      if (auto ip = m_IPPool.Allocate(now))
+        return *ip;
 
-      // find oldest activity ip address
-      huint128_t found = {0};
-      llarp_time_t min = std::numeric_limits<llarp_time_t>::max();
-      for (const auto& [addr, time] : m_IPActivity)
+      // kick whoever went unused the longest off the exit and take their address
+      // TODO: DoS
+      if (auto oldest = m_IPPool.Oldest())
       {
-        if (time < min)
-        {
-          found.h = addr.h;
-          min = time;
-        }
+        if (auto itr = m_IPToKey.find(*oldest); itr != m_IPToKey.end())
+          KickIdentOffExit(PubKey{itr->second});
+        else
+          m_IPPool.Release(*oldest);
       }
-      // kick old ident off exit
-      // TODO: DoS
-      PubKey pk = m_IPToKey[found];
-      KickIdentOffExit(pk);
-
-      return found;
+      return m_IPPool.Allocate(now).value_or(huint128_t{0});
     }
 
     EndpointBase::AddressVariant_t
@@ -644,6 +656,7 @@ namespace llarp
       huint128_t ip = m_KeyToIP[pk];
       m_KeyToIP.erase(pk);
       m_IPToKey.erase(ip);
+      m_IPPool.Release(ip);
       for (auto [exit_itr, end] = m_ActiveExits.equal_range(pk); exit_itr != end;)
         exit_itr = m_ActiveExits.erase(exit_itr);
     }
@@ -651,13 +664,14 @@ namespace llarp
     void
     ExitEndpoint::MarkIPActive(huint128_t ip)
     {
-      m_IPActivity[ip] = GetRouter()->Now();
+      m_IPPool.MarkActive(ip, GetRouter()->Now());
     }
 
     void
     ExitEndpoint::OnInetPacket(net::IPPacket pkt)
     {
-      m_InetToNetwork.emplace(std::move(pkt));
+      if (not m_InetFlows.Push(std::move(pkt), Now()))
+        LogDebug(Name(), " dropped inbound packet that is not ip");
     }
 
     bool
@@ -739,11 +753,12 @@ namespace llarp
       const auto host_str = m_OurRange.BaseAddressString();
       // string, or just a plain char array?
       m_IfAddr = m_OurRange.addr;
-      m_NextAddr = m_IfAddr;
-      m_HigestAddr = m_OurRange.HighestAddr();
+      m_IPPool.SetRange(m_IfAddr, m_OurRange.HighestAddr());
       m_UseV6 = not m_OurRange.IsV4();
 
       m_ifname = networkConfig.m_ifname;
+      m_TunQueues = networkConfig.m_TunQueues;
+      m_TunOffload = networkConfig.m_TunOffload;
       if (m_ifname.empty())
       {
         const auto maybe = m_Router->Net().FindFreeTun();
@@ -842,9 +857,16 @@ namespace llarp
       }
     }
 
+    void
+    ExitEndpoint::UncacheEndpoint(const exit::Endpoint* ep)
+    {
+      m_InetFlows.Uncache(ep->LocalIP(), ep);
+    }
+
     void
     ExitEndpoint::Tick(llarp_time_t now)
     {
+      m_InetFlows.Expire(now);
       {
         auto itr = m_SNodeSessions.begin();
         while (itr != m_SNodeSessions.end())
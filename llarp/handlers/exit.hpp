@@ -1,6 +1,7 @@
 #pragma once
 
 #include <llarp/exit/endpoint.hpp>
+#include <llarp/exit/flow_queue.hpp>
 #include "tun.hpp"
 #include <llarp/dns/server.hpp>
 #include <unordered_map>
@@ -137,6 +138,10 @@ namespace llarp
       void
       RemoveExit(const exit::Endpoint* ep);
 
+      /// DO NOT CALL ME
+      void
+      UncacheEndpoint(const exit::Endpoint* ep);
+
       bool
       QueueOutboundTraffic(net::IPPacket pkt);
 
@@ -201,6 +206,12 @@ namespace llarp
 
       std::unordered_map<PubKey, exit::Endpoint*> m_ChosenExits;
 
+      /// internet to llarp packets, queued per flow.  declared before m_ActiveExits as the
+      /// endpoints in there uncache themselves from it as they go.
+      exit::FlowQueue m_InetFlows;
+      /// set while we have a Flush queued on the loop for what one drain left over
+      bool m_FlushQueued = false;
+
       std::unordered_multimap<PubKey, std::unique_ptr<exit::Endpoint>> m_ActiveExits;
 
       using KeyMap_t = std::unordered_map<PubKey, huint128_t>;
@@ -218,13 +229,13 @@ namespace llarp
       std::unordered_map<huint128_t, PubKey> m_IPToKey;
 
       huint128_t m_IfAddr;
-      huint128_t m_HigestAddr;
-
-      huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
+      size_t m_TunQueues = 1;
+      bool m_TunOffload = false;
 
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      /// the addresses we hand out to clients and when each was last active
+      net::IPPool m_IPPool;
 
       std::shared_ptr<vpn::NetworkInterface> m_NetIf;
 
@@ -233,11 +244,6 @@ namespace llarp
 
       std::shared_ptr<quic::TunnelManager> m_QUIC;
 
-      using PacketQueue_t = std::
-          priority_queue<net::IPPacket, std::vector<net::IPPacket>, net::IPPacket::CompareOrder>;
-
-      /// internet to llarp packet queue
-      PacketQueue_t m_InetToNetwork;
       bool m_UseV6;
       DnsConfig m_DNSConf;
     };
@@ -37,6 +37,22 @@ namespace llarp
   {
     static auto logcat = log::Cat("tun");
 
+    namespace
+    {
+      /// calls hook, if it is still set, when the last reply function holding it goes.  a hooked
+      /// dns lookup that drops its reply without calling it still answers whoever is waiting.
+      struct OnUnanswered
+      {
+        std::function<void()> hook;
+
+        ~OnUnanswered()
+        {
+          if (hook)
+            hook();
+        }
+      };
+    }  // namespace
+
     bool
     TunEndpoint::MaybeHookDNS(
         std::shared_ptr<dns::PacketSource_Base> source,
@@ -48,10 +64,51 @@ namespace llarp
         return false;
 
       auto job = std::make_shared<dns::QueryJob>(source, query, to, from);
-      if (HandleHookedDNSMessage(query, [job](auto msg) { job->SendReply(msg.ToBuffer()); }))
+      // not every way through HandleHookedDNSMessage ends in a reply, those that do not send a
+      // server failure instead when the last copy of reply goes
+      auto unanswered = std::make_shared<OnUnanswered>();
+      auto key = dns::CoalesceKey(query);
+      if (not key)
+      {
+        unanswered->hook = [job] { job->Cancel(); };
+        auto reply = [job, unanswered](dns::Message msg) {
+          unanswered->hook = nullptr;
+          job->SendReply(msg.ToBuffer());
+        };
+        if (HandleHookedDNSMessage(query, std::move(reply)))
+          Router()->TriggerPump();
+        else if (auto fail = std::exchange(unanswered->hook, nullptr))
+          fail();
+        return true;
+      }
+
+      auto lookup = m_DNSLookups.Join(std::move(*key), job, Now());
+      if (not lookup)
+      {
+        LogTrace(Name(), " dns query from ", from, " waiting on the same lookup in flight");
+        return true;
+      }
+      // the last copy of reply can outlive us, by which time there is nobody left to answer
+      unanswered->hook = [self = weak_from_this(), lookup] {
+        if (auto ep = self.lock())
+        {
+          for (const auto& waiter : ep->m_DNSLookups.Finish(lookup))
+            waiter->Cancel();
+        }
+      };
+      auto reply = [this, lookup, unanswered](dns::Message msg) {
+        unanswered->hook = nullptr;
+        // everyone waiting asked the same question, all that differs is the id
+        for (const auto& waiter : m_DNSLookups.Finish(lookup))
+        {
+          msg.hdr_id = waiter->Underlying().hdr_id;
+          waiter->SendReply(msg.ToBuffer());
+        }
+      };
+      if (HandleHookedDNSMessage(query, std::move(reply)))
         Router()->TriggerPump();
-      else
-        job->Cancel();
+      else if (auto fail = std::exchange(unanswered->hook, nullptr))
+        fail();
       return true;
     }
 
@@ -235,23 +292,26 @@ namespace llarp
         obj["localResolver"] = localRes[0];
 
       util::StatusObject ips{};
-      for (const auto& item : m_IPActivity)
+      for (const auto& [ip, addr] : m_IPToAddr)
       {
-        util::StatusObject ipObj{{"lastActive", to_json(item.second)}};
+        util::StatusObject ipObj{
+            {"lastActive", to_json(m_IPPool.LastActive(ip).value_or(0s))}};
         std::string remoteStr;
-        AlignedBuffer<32> addr = m_IPToAddr.at(item.first);
         if (m_SNodes.at(addr))
           remoteStr = RouterID(addr.as_array()).ToString();
         else
           remoteStr = service::Address(addr.as_array()).ToString();
         ipObj["remote"] = remoteStr;
-        std::string ipaddr = item.first.ToString();
+        std::string ipaddr = ip.ToString();
         ips[ipaddr] = ipObj;
       }
       obj["addrs"] = ips;
       obj["ourIP"] = m_OurIP.ToString();
-      obj["nextIP"] = m_NextIP.ToString();
-      obj["maxIP"] = m_MaxIP.ToString();
+      obj["nextIP"] = m_IPPool.Next().ToString();
+      obj["maxIP"] = m_IPPool.Last().ToString();
+      obj["dnsLookups"] = m_DNSLookups.ExtractStatus();
+      if (m_DNS)
+        obj["dns"] = m_DNS->ExtractStatus();
       return obj;
     }
 
@@ -324,6 +384,8 @@ namespace llarp
       }
       else
         m_PathAlignmentTimeout = service::Endpoint::PathAlignmentTimeout();
+      // no hooked lookup waits on a path for longer than that
+      m_DNSLookups.SetTimeout(std::min(m_DNSLookups.Timeout(), m_PathAlignmentTimeout));
 
       for (const auto& item : conf.m_mapAddrs)
       {
@@ -332,6 +394,8 @@ namespace llarp
       }
 
       m_IfName = conf.m_ifname;
+      m_TunQueues = conf.m_TunQueues;
+      m_TunOffload = conf.m_TunOffload;
       if (m_IfName.empty())
       {
         const auto maybe = m_router->Net().FindFreeTun();
@@ -352,6 +416,7 @@ namespace llarp
       }
 
       m_OurIP = m_OurRange.addr;
+      m_IPPool.SetRange(m_OurIP, m_OurRange.HighestAddr());
       m_UseV6 = false;
 
       m_PersistAddrMapFile = conf.m_AddrMapPersistFile;
@@ -444,8 +509,6 @@ namespace llarp
                 m_SNodes[*snode] = true;
                 LogInfo(Name(), " remapped ", ip, " to ", *snode);
               }
-              if (m_NextIP < ip)
-                m_NextIP = ip;
               // make sure we dont unmap this guy
               MarkIPActive(ip);
             }
@@ -476,12 +539,20 @@ namespace llarp
     void
     TunEndpoint::Pump(llarp_time_t now)
     {
-      // flush network to user
+      // flush network to user, rewriting addresses for the whole lot at once
       while (not m_NetworkToUserPktQueue.empty())
       {
-        m_NetIf->WritePacket(m_NetworkToUserPktQueue.top().pkt);
+        m_WriteBatch.emplace_back(
+            std::move(const_cast<WritePacket&>(m_NetworkToUserPktQueue.top())));
         m_NetworkToUserPktQueue.pop();
       }
+      for (auto& write : m_WriteBatch)
+        m_WriteRewrites.push_back(net::AddressRewrite{&write.pkt, write.src, write.dst});
+      net::RewriteAddresses(m_WriteRewrites);
+      for (auto& write : m_WriteBatch)
+        m_NetIf->WritePacket(std::move(write.pkt));
+      m_WriteRewrites.clear();
+      m_WriteBatch.clear();
 
       service::Endpoint::Pump(now);
     }
@@ -576,7 +647,11 @@ namespace llarp
             addr,
             [msg, addr, reply](const Address&, OutboundContext* ctx) {
               if (ctx == nullptr)
+              {
+                msg->AddNXReply();
+                reply(*msg);
                 return;
+              }
 
               const auto& introset = ctx->GetCurrentIntroSet();
               msg->AddSRVReply(introset.GetMatchingSRVRecords(addr.subdomain));
@@ -995,10 +1070,8 @@ namespace llarp
     bool
     TunEndpoint::SetupTun()
     {
-      m_NextIP = m_OurIP;
-      m_MaxIP = m_OurRange.HighestAddr();
       llarp::LogInfo(Name(), " set ", m_IfName, " to have address ", m_OurIP);
-      llarp::LogInfo(Name(), " allocated up to ", m_MaxIP, " on range ", m_OurRange);
+      llarp::LogInfo(Name(), " allocated up to ", m_IPPool.Last(), " on range ", m_OurRange);
 
       const service::Address ourAddr = m_Identity.pub.Addr();
 
@@ -1019,6 +1092,8 @@ namespace llarp
       }
 
       info.ifname = m_IfName;
+      info.queues = m_TunQueues;
+      info.offload = m_TunOffload;
 
       LogInfo(Name(), " setting up network...");
 
@@ -1426,14 +1501,9 @@ namespace llarp
       {
         return false;
       }
-      if (pkt.IsV4())
-      {
-        pkt.UpdateIPv4Address(xhtonl(net::TruncateV6(src)), xhtonl(net::TruncateV6(dst)));
-      }
-      else if (pkt.IsV6())
-      {
-        pkt.UpdateIPv6Address(src, dst);
-      }
+      // addresses are rewritten in Pump with everything else we flush
+      write.src = src;
+      write.dst = dst;
       m_NetworkToUserPktQueue.push(std::move(write));
       // wake up so we ensure that all packets are written to user
       Router()->TriggerPump();
@@ -1471,54 +1541,31 @@ namespace llarp
           return itr->second;
         }
       }
-      // allocate new address
-      if (m_NextIP < m_MaxIP)
+      auto maybe = m_IPPool.Allocate(now);
+      if (not maybe)
       {
-        do
-        {
-          nextIP = ++m_NextIP;
-        } while (m_IPToAddr.find(nextIP) != m_IPToAddr.end() && m_NextIP < m_MaxIP);
-        if (nextIP < m_MaxIP)
+        // we are full, take back the address that went unused the longest
+        // TODO: prevent DoS
+        maybe = m_IPPool.Oldest();
+        if (not maybe)
         {
-          m_AddrToIP[ident] = nextIP;
-          m_IPToAddr[nextIP] = ident;
-          m_SNodes[ident] = snode;
-          var::visit(
-              [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", nextIP); },
-              addr);
-          MarkIPActive(nextIP);
+          LogError(Name(), " cannot map a new address, every address in ", m_OurRange, " is fixed");
           return nextIP;
         }
-      }
-
-      // we are full
-      // expire least active ip
-      // TODO: prevent DoS
-      std::pair<huint128_t, llarp_time_t> oldest = {huint128_t{0}, 0s};
-
-      // find oldest entry
-      auto itr = m_IPActivity.begin();
-      while (itr != m_IPActivity.end())
-      {
-        if (itr->second <= now)
+        if (auto itr = m_IPToAddr.find(*maybe); itr != m_IPToAddr.end())
         {
-          if ((now - itr->second) > oldest.second)
-          {
-            oldest.first = itr->first;
-            oldest.second = itr->second;
-          }
+          m_AddrToIP.erase(itr->second);
+          m_SNodes.erase(itr->second);
         }
-        ++itr;
+        MarkIPActive(*maybe);
       }
-      // remap address
-      m_IPToAddr[oldest.first] = ident;
-      m_AddrToIP[ident] = oldest.first;
+      nextIP = *maybe;
+      m_AddrToIP[ident] = nextIP;
+      m_IPToAddr[nextIP] = ident;
       m_SNodes[ident] = snode;
-      nextIP = oldest.first;
-
-      // mark ip active
-      m_IPActivity[nextIP] = std::max(m_IPActivity[nextIP], now);
-
+      var::visit(
+          [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", nextIP); },
+          addr);
       return nextIP;
     }
 
@@ -1532,13 +1579,13 @@ namespace llarp
     TunEndpoint::MarkIPActive(huint128_t ip)
     {
       llarp::LogDebug(Name(), " address ", ip, " is active");
-      m_IPActivity[ip] = std::max(Now(), m_IPActivity[ip]);
+      m_IPPool.MarkActive(ip, Now());
     }
 
     void
     TunEndpoint::MarkIPActiveForever(huint128_t ip)
     {
-      m_IPActivity[ip] = std::numeric_limits<llarp_time_t>::max();
+      m_IPPool.MarkActiveForever(ip);
     }
 
     TunEndpoint::~TunEndpoint() = default;
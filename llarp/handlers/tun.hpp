@@ -1,9 +1,11 @@
 #pragma once
 
+#include <llarp/dns/coalesce.hpp>
 #include <llarp/dns/server.hpp>
 #include <llarp/ev/ev.hpp>
 #include <llarp/net/ip.hpp>
 #include <llarp/net/ip_packet.hpp>
+#include <llarp/net/ip_pool.hpp>
 #include <llarp/net/net.hpp>
 #include <llarp/service/endpoint.hpp>
 #include <llarp/service/protocol_type.hpp>
@@ -208,6 +210,9 @@ namespace llarp
       {
         uint64_t seqno;
         net::IPPacket pkt;
+        /// the addresses pkt gets rewritten to as it is written
+        huint128_t src;
+        huint128_t dst;
 
         bool
         operator>(const WritePacket& other) const
@@ -218,6 +223,9 @@ namespace llarp
 
       /// queue for sending packets to user from network
       util::ascending_priority_queue<WritePacket> m_NetworkToUserPktQueue;
+      /// what we flush from it each pump, kept to reuse their storage
+      std::vector<WritePacket> m_WriteBatch;
+      std::vector<net::AddressRewrite> m_WriteRewrites;
 
       void
       Pump(llarp_time_t now) override;
@@ -283,20 +291,19 @@ namespace llarp
 
       /// dns subsystem for this endpoint
       std::shared_ptr<dns::Server> m_DNS;
+      /// hooked dns lookups in flight, so a name many apps ask for at once is looked up once.  its
+      /// timeout comes down to the path alignment timeout in Configure.
+      dns::Coalescer<std::shared_ptr<dns::QueryJob>> m_DNSLookups{1min};
 
       DnsConfig m_DnsConfig;
 
-      /// maps ip address to timestamp last active
-      std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
+      /// the addresses we hand out to remotes and when each was last active
+      net::IPPool m_IPPool;
       /// our ip address (host byte order)
       huint128_t m_OurIP;
       /// our network interface's ipv6 address
       huint128_t m_OurIPv6;
 
-      /// next ip address to allocate (host byte order)
-      huint128_t m_NextIP;
-      /// highest ip address to allocate (host byte order)
-      huint128_t m_MaxIP;
       /// our ip range we are using
       llarp::IPRange m_OurRange;
       /// list of strict connect addresses for hooks
@@ -304,6 +311,10 @@ namespace llarp
       /// use v6?
       bool m_UseV6;
       std::string m_IfName;
+      /// how many queues we open on our interface
+      size_t m_TunQueues = 1;
+      /// whether we ask the kernel for offloaded packets on our interface
+      bool m_TunOffload = false;
 
       std::optional<huint128_t> m_BaseV6Address;
 
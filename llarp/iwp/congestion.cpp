@@ -0,0 +1,201 @@
+#include "congestion.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// reno's additive increase for a flow using our Beta, RFC 8312 section 4.2
+    static constexpr double RenoAlpha =
+        3 * (1 - CongestionControl::Beta) / (1 + CongestionControl::Beta);
+
+    static double
+    to_seconds(llarp_time_t t)
+    {
+      return std::chrono::duration<double>(t).count();
+    }
+
+    bool
+    CongestionControl::CanSend(size_t packets, llarp_time_t now)
+    {
+      if (m_InFlight > 0 and m_InFlight + packets > m_Window)
+        return false;
+      Refill(now);
+      return m_Tokens >= std::min<double>(packets, Burst());
+    }
+
+    llarp_time_t
+    CongestionControl::PacingDelay(size_t packets, llarp_time_t now)
+    {
+      Refill(now);
+      const auto need = std::min<double>(packets, Burst()) - m_Tokens;
+      const auto rate = PacingRate();
+      if (need <= 0 or rate <= 0)
+        return 0s;
+      return std::max<llarp_time_t>(1ms, llarp_time_t{int64_t(std::ceil(need / rate))});
+    }
+
+    void
+    CongestionControl::OnSent(size_t packets, llarp_time_t now)
+    {
+      Refill(now);
+      m_InFlight += packets;
+      m_Tokens -= packets;
+    }
+
+    void
+    CongestionControl::OnRetransmit(size_t packets, llarp_time_t now)
+    {
+      Refill(now);
+      m_Tokens -= packets;
+      m_Retransmits += packets;
+    }
+
+    void
+    CongestionControl::OnAcked(size_t packets, llarp_time_t now)
+    {
+      m_InFlight -= std::min(packets, m_InFlight);
+      // acks for what was in flight when we lost something say nothing about the new window
+      if (now < m_RecoveryUntil)
+        return;
+      if (InSlowStart())
+      {
+        m_Window = std::min(m_Window + packets, MaxWindow);
+        return;
+      }
+      if (not m_InEpoch)
+      {
+        m_InEpoch = true;
+        m_EpochStart = now;
+        if (m_Window < m_WMax)
+          m_K = std::cbrt((m_WMax - m_Window) / C);
+        else
+        {
+          m_K = 0;
+          m_WMax = m_Window;
+        }
+        m_WEst = m_Window;
+      }
+      const auto t = to_seconds(now - m_EpochStart) + (m_HaveRTT ? m_SRTT / 1000 : 0);
+      const auto target = C * std::pow(t - m_K, 3) + m_WMax;
+      m_WEst += RenoAlpha * packets / m_Window;
+      double next;
+      if (target > m_Window)
+        next = m_Window + ((target - m_Window) * packets / m_Window);
+      else
+        next = m_Window + (0.01 * packets / m_Window);
+      m_Window = std::clamp(std::max(next, m_WEst), MinWindow, MaxWindow);
+    }
+
+    void
+    CongestionControl::OnDropped(size_t packets, llarp_time_t now)
+    {
+      m_InFlight -= std::min(packets, m_InFlight);
+      EnterRecovery(now);
+    }
+
+    void
+    CongestionControl::OnTimeout(llarp_time_t now)
+    {
+      if (now < m_RecoveryUntil)
+        return;
+      m_Backoff = std::min(m_Backoff + 1, 3u);
+      EnterRecovery(now);
+    }
+
+    void
+    CongestionControl::OnLoss(llarp_time_t now)
+    {
+      EnterRecovery(now);
+    }
+
+    void
+    CongestionControl::OnRTTSample(llarp_time_t rtt)
+    {
+      const double r = std::max<double>(rtt.count(), 1);
+      if (m_HaveRTT)
+      {
+        m_RTTVar = (0.75 * m_RTTVar) + (0.25 * std::abs(m_SRTT - r));
+        m_SRTT = (0.875 * m_SRTT) + (0.125 * r);
+      }
+      else
+      {
+        m_HaveRTT = true;
+        m_SRTT = r;
+        m_RTTVar = r / 2;
+      }
+      m_Backoff = 0;
+    }
+
+    llarp_time_t
+    CongestionControl::RTO() const
+    {
+      auto rto = MaxRTO;
+      if (m_HaveRTT)
+        rto = llarp_time_t{int64_t(std::ceil(m_SRTT + std::max(1.0, 4 * m_RTTVar)))};
+      rto = std::clamp(rto, MinRTO, MaxRTO);
+      return std::min(rto * (1 << m_Backoff), MaxRTO);
+    }
+
+    void
+    CongestionControl::EnterRecovery(llarp_time_t now)
+    {
+      if (now < m_RecoveryUntil)
+        return;
+      m_LossEvents++;
+      // fast convergence: if we lost before getting back to the last peak, someone else wants
+      // the bandwidth, so give up some more of it
+      if (m_Window < m_WMax)
+        m_WMax = m_Window * (1 + Beta) / 2;
+      else
+        m_WMax = m_Window;
+      m_Window = std::max(m_Window * Beta, MinWindow);
+      m_SSThresh = m_Window;
+      m_InEpoch = false;
+      m_RecoveryUntil = now + (m_HaveRTT ? llarp_time_t{int64_t(std::ceil(m_SRTT))} : RTO());
+    }
+
+    double
+    CongestionControl::PacingRate() const
+    {
+      if (not m_HaveRTT)
+        return 0;
+      const auto gain = InSlowStart() ? SlowStartPacingGain : PacingGain;
+      return gain * m_Window / m_SRTT;
+    }
+
+    double
+    CongestionControl::Burst() const
+    {
+      return std::max(MinBurst, m_Window / 4);
+    }
+
+    void
+    CongestionControl::Refill(llarp_time_t now)
+    {
+      const auto rate = PacingRate();
+      if (rate <= 0)
+        m_Tokens = Burst();
+      else if (now > m_LastRefill)
+        m_Tokens = std::min(Burst(), m_Tokens + (rate * (now - m_LastRefill).count()));
+      m_LastRefill = std::max(m_LastRefill, now);
+    }
+
+    util::StatusObject
+    CongestionControl::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"window", m_Window},
+          {"ssthresh", m_SSThresh},
+          {"inFlight", m_InFlight},
+          {"srtt", m_SRTT},
+          {"rttvar", m_RTTVar},
+          {"rto", RTO().count()},
+          {"pacingRate", PacingRate() * 1000},
+          {"lossEvents", m_LossEvents},
+          {"retransmits", m_Retransmits}};
+    }
+  }  // namespace iwp
+}  // namespace llarp
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// congestion control for one iwp session, counted in packets (fragments) rather than bytes.
+    ///
+    /// the window follows CUBIC (RFC 8312): slow start until the first loss, then a multiplicative
+    /// decrease and a cubic climb back towards the window we lost at.  round trip time is
+    /// estimated as in RFC 6298 from messages acked without ever being retransmitted, and sets
+    /// both the retransmit timeout and the rate new packets are paced out at, so a full window is
+    /// spread over a round trip instead of leaving in one burst.
+    class CongestionControl
+    {
+     public:
+      /// window we start out with, enough for a few full size messages
+      static constexpr double InitialWindow = 32;
+      /// we never shrink the window below this
+      static constexpr double MinWindow = 4;
+      static constexpr double MaxWindow = 8192;
+      /// CUBIC multiplicative decrease and scaling constants
+      static constexpr double Beta = 0.7;
+      static constexpr double C = 0.4;
+      /// pacing gain while in slow start and after it
+      static constexpr double SlowStartPacingGain = 2.0;
+      static constexpr double PacingGain = 1.25;
+      /// how many packets pacing lets out back to back, at least one full size message
+      static constexpr double MinBurst = 8;
+
+      static constexpr llarp_time_t MinRTO = 100ms;
+      /// messages are given up on after 500ms, a later retransmit would not help any
+      static constexpr llarp_time_t MaxRTO = 400ms;
+
+      /// can we put `packets` more new packets on the wire right now.  a message is never held
+      /// back by the window while nothing is in flight, however large it is.
+      bool
+      CanSend(size_t packets, llarp_time_t now);
+
+      /// how long until pacing would let `packets` more packets out, zero if it would now
+      llarp_time_t
+      PacingDelay(size_t packets, llarp_time_t now);
+
+      /// we sent `packets` new packets
+      void
+      OnSent(size_t packets, llarp_time_t now);
+
+      /// we sent `packets` packets again; they are still counted in flight from their first send
+      void
+      OnRetransmit(size_t packets, llarp_time_t now);
+
+      /// `packets` of the packets in flight were acked
+      void
+      OnAcked(size_t packets, llarp_time_t now);
+
+      /// we gave up on `packets` packets in flight
+      void
+      OnDropped(size_t packets, llarp_time_t now);
+
+      /// a retransmit timer fired
+      void
+      OnTimeout(llarp_time_t now);
+
+      /// the remote told us something we sent was lost
+      void
+      OnLoss(llarp_time_t now);
+
+      /// a round trip measured on a message that was never retransmitted
+      void
+      OnRTTSample(llarp_time_t rtt);
+
+      /// how long we wait for an ack before retransmitting
+      llarp_time_t
+      RTO() const;
+
+      double
+      Window() const
+      {
+        return m_Window;
+      }
+
+      size_t
+      InFlight() const
+      {
+        return m_InFlight;
+      }
+
+      bool
+      InSlowStart() const
+      {
+        return m_Window < m_SSThresh;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      /// shrink the window, at most once a round trip
+      void
+      EnterRecovery(llarp_time_t now);
+
+      /// top up pacing tokens for the time since we last did
+      void
+      Refill(llarp_time_t now);
+
+      /// current pacing rate in packets per millisecond, zero while unpaced
+      double
+      PacingRate() const;
+
+      double
+      Burst() const;
+
+      double m_Window = InitialWindow;
+      double m_SSThresh = MaxWindow;
+      /// window at the last loss and when the cubic curve gets back to it
+      double m_WMax = 0;
+      double m_K = 0;
+      /// what a reno flow would have grown to, the window never grows slower than this
+      double m_WEst = 0;
+      bool m_InEpoch = false;
+      llarp_time_t m_EpochStart = 0s;
+      llarp_time_t m_RecoveryUntil = 0s;
+      size_t m_InFlight = 0;
+
+      bool m_HaveRTT = false;
+      /// smoothed rtt and its variance, in milliseconds
+      double m_SRTT = 0;
+      double m_RTTVar = 0;
+      /// how many times the rto has doubled since our last rtt sample
+      unsigned m_Backoff = 0;
+
+      double m_Tokens = MinBurst;
+      llarp_time_t m_LastRefill = 0s;
+
+      uint64_t m_LossEvents = 0;
+      uint64_t m_Retransmits = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -1,6 +1,7 @@
 #include "linklayer.hpp"
 #include "session.hpp"
 #include <llarp/config/key_manager.hpp>
+#include <llarp/ev/udp_handle.hpp>
 #include <memory>
 #include <unordered_set>
 
@@ -49,6 +50,27 @@ namespace llarp::iwp
 
   void
   LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+  {
+    if (HandleRecv(from, std::move(pkt)))
+      WakeupPlaintext();
+  }
+
+  void
+  LinkLayer::RecvFromBatch(const std::vector<UDPPacket>& pkts)
+  {
+    // only wake up once for the whole batch
+    bool wakeup = false;
+    for (const auto& pkt : pkts)
+    {
+      if (HandleRecv(pkt.from, ILinkSession::Packet_t{pkt.data.begin(), pkt.data.end()}))
+        wakeup = true;
+    }
+    if (wakeup)
+      WakeupPlaintext();
+  }
+
+  bool
+  LinkLayer::HandleRecv(const SockAddr& from, ILinkSession::Packet_t pkt)
   {
     std::shared_ptr<ILinkSession> session;
     auto itr = m_AuthedAddrs.find(from);
@@ -60,7 +82,7 @@ namespace llarp::iwp
       if (it == m_Pending.end())
       {
         if (not m_Inbound)
-          return;
+          return false;
         isNewSession = true;
         it = m_Pending.emplace(from, std::make_shared<Session>(this, from)).first;
       }
@@ -79,8 +101,9 @@ namespace llarp::iwp
         LogDebug("Brand new session failed; removing from pending sessions list");
         m_Pending.erase(from);
       }
-      WakeupPlaintext();
+      return true;
     }
+    return false;
   }
 
   std::shared_ptr<ILinkSession>
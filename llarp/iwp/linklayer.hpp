@@ -44,6 +44,9 @@ namespace llarp::iwp
     void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) override;
 
+    void
+    RecvFromBatch(const std::vector<UDPPacket>& pkts) override;
+
     void
     WakeupPlaintext();
 
@@ -51,6 +54,10 @@ namespace llarp::iwp
     PrintableName() const;
 
    private:
+    /// hand a packet to the session it belongs to, returns true if a session took it
+    bool
+    HandleRecv(const SockAddr& from, ILinkSession::Packet_t pkt);
+
     void
     HandleWakeupPlaintext();
 
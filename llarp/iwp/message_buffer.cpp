@@ -49,9 +49,28 @@ namespace llarp
     }
 
     bool
-    OutboundMessage::ShouldFlush(llarp_time_t now) const
+    OutboundMessage::ShouldFlush(llarp_time_t now, llarp_time_t rto) const
     {
-      return now - m_LastFlush >= TXFlushInterval;
+      return now - m_LastFlush >= rto;
+    }
+
+    size_t
+    OutboundMessage::NumFragments() const
+    {
+      return std::max<size_t>((m_Data.size() + FragmentSize - 1) / FragmentSize, 1);
+    }
+
+    size_t
+    OutboundMessage::NumUnAcked() const
+    {
+      size_t unacked = 0;
+      const auto num = std::min(NumFragments(), m_Acks.size());
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        if (not m_Acks.test(idx))
+          unacked++;
+      }
+      return unacked;
     }
 
     void
@@ -60,13 +79,14 @@ namespace llarp
       m_Acks = std::bitset<8>(bitmask);
     }
 
-    void
+    size_t
     OutboundMessage::FlushUnAcked(
         std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
     {
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
       uint16_t idx = 0;
+      size_t sent = 0;
       const auto datasz = m_Data.size();
       while (idx < datasz)
       {
@@ -81,10 +101,12 @@ namespace llarp
               m_Data.begin() + idx + fragsz,
               frag.data() + PacketOverhead + Overhead + 2);
           sendpkt(std::move(frag));
+          sent++;
         }
         idx += FragmentSize;
       }
       m_LastFlush = now;
+      return sent;
     }
 
     bool
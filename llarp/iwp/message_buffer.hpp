@@ -50,6 +50,12 @@ namespace llarp
       llarp_time_t m_LastFlush = 0s;
       ShortHash m_Digest;
       llarp_time_t m_StartedAt = 0s;
+      /// when we first put this message on the wire, zero while it waits on congestion control
+      llarp_time_t m_FirstSentAt = 0s;
+      /// packets of this message we count as in flight
+      uint16_t m_InFlight = 0;
+      /// once retransmitted an ack no longer gives a usable rtt sample
+      bool m_Retransmitted = false;
       uint16_t m_ResendPriority;
 
       bool
@@ -67,11 +73,21 @@ namespace llarp
       void
       Ack(byte_t bitmask);
 
-      void
+      /// send every fragment not yet acked, returns how many we sent
+      size_t
       FlushUnAcked(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
 
+      /// have we gone `rto` since we last sent fragments without hearing they all arrived
       bool
-      ShouldFlush(llarp_time_t now) const;
+      ShouldFlush(llarp_time_t now, llarp_time_t rto) const;
+
+      /// how many packets it takes to send this message, the XMIT carries the first fragment
+      size_t
+      NumFragments() const;
+
+      /// how many fragments have not been acked
+      size_t
+      NumUnAcked() const;
 
       void
       Completed();
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <bitset>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// the in flight messages of a session, keyed by their (monotonic) message id.
+    ///
+    /// messages live contiguously in a dense vector so iterating them in Pump and Tick is a linear
+    /// scan, and a ring of indices into it addressed by `msgid % capacity` gives O(1) lookup with
+    /// no per message node allocation.  because ids are handed out in order the messages in flight
+    /// at once almost never collide in the ring; when they do it doubles, up to MaxCapacity.
+    template <typename Msg_t, size_t MaxCapacity, size_t InitialCapacity = 64>
+    class MessageWindow
+    {
+      static_assert(InitialCapacity > 0 and (InitialCapacity & (InitialCapacity - 1)) == 0);
+      static_assert(MaxCapacity >= InitialCapacity and (MaxCapacity & (MaxCapacity - 1)) == 0);
+
+      static constexpr uint32_t Empty = std::numeric_limits<uint32_t>::max();
+
+      std::vector<uint32_t> m_Ring = std::vector<uint32_t>(InitialCapacity, Empty);
+      std::vector<Msg_t> m_Msgs;
+
+      uint32_t&
+      Slot(uint64_t id)
+      {
+        return m_Ring[id & (m_Ring.size() - 1)];
+      }
+
+      const uint32_t&
+      Slot(uint64_t id) const
+      {
+        return m_Ring[id & (m_Ring.size() - 1)];
+      }
+
+      /// double the ring, returns false if we are already as big as we get
+      bool
+      Grow()
+      {
+        if (m_Ring.size() >= MaxCapacity)
+          return false;
+        // distinct ids in distinct slots stay distinct with one more bit of the id
+        m_Ring.assign(m_Ring.size() * 2, Empty);
+        for (uint32_t idx = 0; idx < m_Msgs.size(); ++idx)
+          Slot(m_Msgs[idx].m_MsgID) = idx;
+        return true;
+      }
+
+      /// remove the message at idx by swapping the last message into its place
+      void
+      EraseAt(uint32_t idx)
+      {
+        Slot(m_Msgs[idx].m_MsgID) = Empty;
+        if (idx + 1 != m_Msgs.size())
+        {
+          m_Msgs[idx] = std::move(m_Msgs.back());
+          Slot(m_Msgs[idx].m_MsgID) = idx;
+        }
+        m_Msgs.pop_back();
+      }
+
+     public:
+      size_t
+      size() const
+      {
+        return m_Msgs.size();
+      }
+
+      bool
+      empty() const
+      {
+        return m_Msgs.empty();
+      }
+
+      /// current ring size, for stats
+      size_t
+      capacity() const
+      {
+        return m_Ring.size();
+      }
+
+      Msg_t*
+      find(uint64_t id)
+      {
+        const auto idx = Slot(id);
+        if (idx == Empty or m_Msgs[idx].m_MsgID != id)
+          return nullptr;
+        return &m_Msgs[idx];
+      }
+
+      const Msg_t*
+      find(uint64_t id) const
+      {
+        return const_cast<MessageWindow*>(this)->find(id);
+      }
+
+      /// add a message for msg.m_MsgID, which must not already be in the window.  returns nullptr
+      /// if the window is full: another message sits in its slot and we cannot grow any more.
+      /// pointers to messages are invalidated by any insert or erase.
+      Msg_t*
+      insert(Msg_t msg)
+      {
+        const auto id = msg.m_MsgID;
+        while (Slot(id) != Empty)
+        {
+          if (not Grow())
+            return nullptr;
+        }
+        Slot(id) = m_Msgs.size();
+        return &m_Msgs.emplace_back(std::move(msg));
+      }
+
+      /// remove the message with this id, if we have one
+      void
+      erase(uint64_t id)
+      {
+        const auto idx = Slot(id);
+        if (idx != Empty and m_Msgs[idx].m_MsgID == id)
+          EraseAt(idx);
+      }
+
+      /// remove the message with this id and hand it back, std::nullopt if we have none.  for when
+      /// what is done with it next might insert into or erase from the window.
+      std::optional<Msg_t>
+      take(uint64_t id)
+      {
+        const auto idx = Slot(id);
+        if (idx == Empty or m_Msgs[idx].m_MsgID != id)
+          return std::nullopt;
+        std::optional<Msg_t> msg{std::move(m_Msgs[idx])};
+        EraseAt(idx);
+        return msg;
+      }
+
+      /// remove every message for which pred returns true
+      template <typename Pred_t>
+      void
+      erase_if(Pred_t pred)
+      {
+        uint32_t idx = 0;
+        while (idx < m_Msgs.size())
+        {
+          if (pred(m_Msgs[idx]))
+            EraseAt(idx);
+          else
+            ++idx;
+        }
+      }
+
+      auto
+      begin()
+      {
+        return m_Msgs.begin();
+      }
+
+      auto
+      end()
+      {
+        return m_Msgs.end();
+      }
+
+      auto
+      begin() const
+      {
+        return m_Msgs.begin();
+      }
+
+      auto
+      end() const
+      {
+        return m_Msgs.end();
+      }
+    };
+
+    /// remembers which of the last WindowSize message ids we have already handled.  anything older
+    /// than that is reported as seen, the sender will have given up on it long before it could
+    /// fall that far behind.
+    template <size_t WindowSize>
+    class ReplayWindow
+    {
+      std::bitset<WindowSize> m_Seen;
+      /// one past the highest id we have inserted
+      uint64_t m_Top = 0;
+
+     public:
+      bool
+      Contains(uint64_t id) const
+      {
+        if (id >= m_Top)
+          return false;
+        if (m_Top - id > WindowSize)
+          return true;
+        return m_Seen[id % WindowSize];
+      }
+
+      /// mark id as seen, returns false if it was already seen
+      bool
+      Insert(uint64_t id)
+      {
+        if (id >= m_Top)
+        {
+          // slide the window forward, forgetting whatever was in the slots we move over
+          if (id - m_Top >= WindowSize)
+            m_Seen.reset();
+          else
+          {
+            for (auto n = m_Top; n < id; ++n)
+              m_Seen.reset(n % WindowSize);
+          }
+          m_Top = id + 1;
+          m_Seen.set(id % WindowSize);
+          return true;
+        }
+        if (m_Top - id > WindowSize)
+          return false;
+        const auto bit = id % WindowSize;
+        if (m_Seen[bit])
+          return false;
+        m_Seen.set(bit);
+        return true;
+      }
+
+      /// how many ids inside the window we have seen
+      size_t
+      Size() const
+      {
+        return m_Seen.count();
+      }
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -72,6 +72,25 @@ namespace llarp
       m_TXRate += sz;
     }
 
+    void
+    Session::SendBatch_LL(const std::vector<Packet_t>& pkts)
+    {
+      if (pkts.empty())
+        return;
+      LogTrace("send ", pkts.size(), " packets to ", m_RemoteAddr);
+      std::vector<byte_view_t> bufs;
+      bufs.reserve(pkts.size());
+      size_t sz = 0;
+      for (const auto& pkt : pkts)
+      {
+        bufs.emplace_back(pkt.data(), pkt.size());
+        sz += pkt.size();
+      }
+      m_Parent->SendBatchTo_LL(m_RemoteAddr, bufs);
+      m_LastTX = time_now_ms();
+      m_TXRate += sz;
+    }
+
     bool
     Session::GotInboundLIM(const LinkIntroMessage* msg)
     {
@@ -165,8 +184,8 @@ namespace llarp
         pktbuf.base = pkt.data() + HMACSIZE;
         pktbuf.sz = pkt.size() - HMACSIZE;
         CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
-        Send_LL(pkt.data(), pkt.size());
       }
+      SendBatch_LL(msgs);
     }
 
     void
@@ -195,22 +214,92 @@ namespace llarp
         return false;
       }
       const auto now = m_Parent->Now();
-      const auto msgid = m_TXID++;
-      const auto bufsz = buf.size();
-      auto& msg =
-          m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed, priority})
-              .first->second;
-      TriggerPump();
-      EncryptAndSend(msg.XMIT());
-      if (bufsz > FragmentSize)
+      const auto msgid = m_TXID;
+      auto* msg = m_TXMsgs.insert(OutboundMessage{msgid, std::move(buf), now, completed, priority});
+      if (not msg)
       {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        // a message from long ago is still in flight where this one would go
+        if (completed)
+          completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
+        return false;
       }
+      m_TXID++;
       m_Stats.totalInFlightTX++;
       LogDebug("send message ", msgid, " to ", m_RemoteAddr);
+      // never overtake messages already waiting their turn
+      if (m_TXPending.empty() and m_Congestion.CanSend(msg->NumFragments(), now))
+        Transmit(*msg, now);
+      else
+      {
+        m_TXPending.push_back(msgid);
+        TriggerPump();
+      }
       return true;
     }
 
+    void
+    Session::Transmit(OutboundMessage& msg, llarp_time_t now)
+    {
+      EncryptAndSend(msg.XMIT());
+      if (msg.m_Data.size() > FragmentSize)
+        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+      msg.m_LastFlush = now;
+      msg.m_FirstSentAt = now;
+      msg.m_InFlight = msg.NumFragments();
+      m_Congestion.OnSent(msg.m_InFlight, now);
+    }
+
+    void
+    Session::Retransmit(OutboundMessage& msg, llarp_time_t now)
+    {
+      size_t sent = 0;
+      // if nothing was acked yet we cannot tell the XMIT arrived; a small message is nothing but
+      // its XMIT, and without one the remote cannot nack the fragments of a larger one
+      if (msg.m_InFlight >= msg.NumFragments())
+      {
+        EncryptAndSend(msg.XMIT());
+        sent++;
+      }
+      sent += msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+      msg.m_Retransmitted = true;
+      m_Congestion.OnRetransmit(sent, now);
+    }
+
+    void
+    Session::SendPending(llarp_time_t now)
+    {
+      while (not m_TXPending.empty())
+      {
+        auto* msg = m_TXMsgs.find(m_TXPending.front());
+        if (not msg)
+        {
+          // timed out while it waited
+          m_TXPending.pop_front();
+          continue;
+        }
+        const auto frags = msg->NumFragments();
+        if (not m_Congestion.CanSend(frags, now))
+        {
+          // acks opening the window pump us anyway, but nothing will when pacing runs dry
+          const auto delay = m_Congestion.PacingDelay(frags, now);
+          if (delay > 0s and not m_PacingWakeup)
+          {
+            m_PacingWakeup = true;
+            m_Parent->Router()->loop()->call_later(delay, [self = weak_from_this()]() {
+              if (auto ptr = self.lock())
+              {
+                ptr->m_PacingWakeup = false;
+                ptr->TriggerPump();
+              }
+            });
+          }
+          return;
+        }
+        m_TXPending.pop_front();
+        Transmit(*msg, now);
+      }
+    }
+
     void
     Session::SendMACK()
     {
@@ -250,7 +339,7 @@ namespace llarp
       {
         if (ShouldPing())
           SendKeepAlive();
-        for (auto& [id, msg] : m_RXMsgs)
+        for (auto& msg : m_RXMsgs)
         {
           if (msg.ShouldSendACKS(now))
           {
@@ -262,27 +351,32 @@ namespace llarp
             std::vector<OutboundMessage*>,
             ComparePtr<OutboundMessage*>>
             to_resend;
-        for (auto& [id, msg] : m_TXMsgs)
+        const auto rto = m_Congestion.RTO();
+        for (auto& msg : m_TXMsgs)
         {
-          if (msg.ShouldFlush(now))
+          if (msg.m_FirstSentAt > 0s and msg.ShouldFlush(now, rto))
             to_resend.push(&msg);
         }
         if (not to_resend.empty())
         {
-          for (auto& msg = to_resend.top(); not to_resend.empty(); to_resend.pop())
-            msg->FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+          m_Congestion.OnTimeout(now);
+          for (; not to_resend.empty(); to_resend.pop())
+            Retransmit(*to_resend.top(), now);
         }
+        SendPending(now);
       }
       if (not m_EncryptNext.empty())
       {
-        m_Parent->QueueWork(
+        m_Parent->Router()->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
             [self = shared_from_this(), data = m_EncryptNext] { self->EncryptWorker(data); });
         m_EncryptNext.clear();
       }
 
       if (not m_DecryptNext.empty())
       {
-        m_Parent->QueueWork(
+        m_Parent->Router()->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
             [self = shared_from_this(), data = m_DecryptNext] { self->DecryptWorker(data); });
         m_DecryptNext.clear();
       }
@@ -340,8 +434,10 @@ namespace llarp
 
           {"state", StateToString(m_State)},
           {"inbound", m_Inbound},
-          {"replayFilter", m_ReplayFilter.size()},
+          {"replayFilter", m_ReplayFilter.Size()},
           {"txMsgQueueSize", m_TXMsgs.size()},
+          {"txMsgsPending", m_TXPending.size()},
+          {"congestion", m_Congestion.ExtractStatus()},
           {"rxMsgQueueSize", m_RXMsgs.size()},
           {"remoteAddr", m_RemoteAddr.ToString()},
           {"remoteRC", m_RemoteRC.ExtractStatus()},
@@ -385,51 +481,32 @@ namespace llarp
         ResetRates();
         m_ResetRatesAt = now + 1s;
       }
-      // remove pending outbound messsages that timed out
-      // inform waiters
-      {
-        auto itr = m_TXMsgs.begin();
-        while (itr != m_TXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_Stats.totalDroppedTX++;
-            m_Stats.totalInFlightTX--;
-            LogTrace("Dropped unacked packet to ", m_RemoteAddr);
-            itr->second.InformTimeout();
-            itr = m_TXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
+      // remove pending outbound messsages that timed out and inform waiters, taking them out
+      // first as the handlers may queue more messages on us
+      std::vector<OutboundMessage> timedOut;
+      m_TXMsgs.erase_if([&](auto& msg) {
+        if (not msg.IsTimedOut(now))
+          return false;
+        timedOut.emplace_back(std::move(msg));
+        return true;
+      });
+      for (auto& msg : timedOut)
       {
-        // remove pending inbound messages that timed out
-        auto itr = m_RXMsgs.begin();
-        while (itr != m_RXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_ReplayFilter.emplace(itr->first, now);
-            itr = m_RXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
-      }
-      {
-        // decay replay window
-        auto itr = m_ReplayFilter.begin();
-        while (itr != m_ReplayFilter.end())
-        {
-          if (itr->second + ReplayWindow <= now)
-          {
-            itr = m_ReplayFilter.erase(itr);
-          }
-          else
-            ++itr;
-        }
+        // a message that timed out waiting to be sent says nothing about the path
+        if (msg.m_FirstSentAt > 0s)
+          m_Congestion.OnDropped(msg.m_InFlight, now);
+        m_Stats.totalDroppedTX++;
+        m_Stats.totalInFlightTX--;
+        LogTrace("Dropped unacked packet to ", m_RemoteAddr);
+        msg.InformTimeout();
       }
+      // remove pending inbound messages that timed out
+      m_RXMsgs.erase_if([&](const auto& msg) {
+        if (not msg.IsTimedOut(now))
+          return false;
+        m_ReplayFilter.Insert(msg.m_MsgID);
+        return true;
+      });
     }
 
     using Introduction =
@@ -727,18 +804,20 @@ namespace llarp
         return;
       }
       LogTrace("got ", int(numAcks), " mack from ", m_RemoteAddr);
+      const auto now = m_Parent->Now();
       byte_t* ptr = data.data() + CommandOverhead + PacketOverhead + 1;
       while (numAcks > 0)
       {
         auto acked = oxenc::load_big_to_host<uint64_t>(ptr);
         LogTrace("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
-        if (itr != m_TXMsgs.end())
+        // out of the window before we inform the waiter, who may queue more messages on us
+        if (auto msg = m_TXMsgs.take(acked))
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
-          itr->second.Completed();
-          m_TXMsgs.erase(itr);
+          // a mack answers a replay, so it gives no rtt sample
+          m_Congestion.OnAcked(msg->m_InFlight, now);
+          msg->Completed();
         }
         else
         {
@@ -747,6 +826,8 @@ namespace llarp
         ptr += sizeof(uint64_t);
         numAcks--;
       }
+      if (not m_TXPending.empty())
+        TriggerPump();
     }
 
     void
@@ -759,12 +840,16 @@ namespace llarp
       }
       auto txid = oxenc::load_big_to_host<uint64_t>(data.data() + CommandOverhead + PacketOverhead);
       LogTrace("got nack on ", txid, " from ", m_RemoteAddr);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      const auto now = m_Parent->Now();
+      if (auto* msg = m_TXMsgs.find(txid))
       {
-        EncryptAndSend(itr->second.XMIT());
+        // the remote got fragments but never the XMIT
+        m_Congestion.OnLoss(now);
+        EncryptAndSend(msg->XMIT());
+        msg->m_Retransmitted = true;
+        m_Congestion.OnRetransmit(1, now);
       }
-      m_LastRX = m_Parent->Now();
+      m_LastRX = now;
     }
 
     void
@@ -787,47 +872,46 @@ namespace llarp
       assert(p2 == data.data() + XMITOverhead);
       LogTrace("rxid=", rxid, " sz=", sz, " h=", oxenc::to_hex(pos, p2), " from ", m_RemoteAddr);
       m_LastRX = m_Parent->Now();
+      // check for replay
+      if (m_ReplayFilter.Contains(rxid))
       {
-        // check for replay
-        auto itr = m_ReplayFilter.find(rxid);
-        if (itr != m_ReplayFilter.end())
-        {
-          m_SendMACKs.emplace(rxid);
-          LogTrace("duplicate rxid=", rxid, " from ", m_RemoteAddr);
-          return;
-        }
+        m_SendMACKs.emplace(rxid);
+        LogTrace("duplicate rxid=", rxid, " from ", m_RemoteAddr);
+        return;
       }
+      if (m_RXMsgs.find(rxid))
       {
-        const auto now = m_Parent->Now();
-        auto itr = m_RXMsgs.find(rxid);
-        if (itr == m_RXMsgs.end())
-        {
-          itr = m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, ShortHash{pos}, m_Parent->Now()})
-                    .first;
-          TriggerPump();
+        LogTrace("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
+        return;
+      }
+      const auto now = m_Parent->Now();
+      auto* msg = m_RXMsgs.insert(InboundMessage{rxid, sz, ShortHash{pos}, now});
+      if (not msg)
+      {
+        // no room, they will nack and retransmit once we have caught up
+        LogTrace("rx window full, dropping xmit on ", rxid, " from ", m_RemoteAddr);
+        return;
+      }
+      TriggerPump();
 
-          sz = std::min(sz, uint16_t{FragmentSize});
-          if ((data.size() - XMITOverhead) == sz)
+      sz = std::min(sz, uint16_t{FragmentSize});
+      if ((data.size() - XMITOverhead) == sz)
+      {
+        {
+          const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
+          msg->HandleData(0, buf, now);
+          if (not msg->IsCompleted())
           {
-            {
-              const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
-              itr->second.HandleData(0, buf, now);
-              if (not itr->second.IsCompleted())
-              {
-                return;
-              }
+            return;
+          }
 
-              if (not itr->second.Verify())
-              {
-                LogError("bad short xmit hash from ", m_RemoteAddr);
-                return;
-              }
-            }
-            HandleRecvMsgCompleted(itr->second);
+          if (not msg->Verify())
+          {
+            LogError("bad short xmit hash from ", m_RemoteAddr);
+            return;
           }
         }
-        else
-          LogTrace("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
+        HandleRecvMsgCompleted(*msg);
       }
     }
 
@@ -843,10 +927,10 @@ namespace llarp
       auto sz = oxenc::load_big_to_host<uint16_t>(data.data() + CommandOverhead + PacketOverhead);
       auto rxid = oxenc::load_big_to_host<uint64_t>(
           data.data() + CommandOverhead + sizeof(uint16_t) + PacketOverhead);
-      auto itr = m_RXMsgs.find(rxid);
-      if (itr == m_RXMsgs.end())
+      auto* msg = m_RXMsgs.find(rxid);
+      if (not msg)
       {
-        if (m_ReplayFilter.find(rxid) == m_ReplayFilter.end())
+        if (not m_ReplayFilter.Contains(rxid))
         {
           LogTrace("no rxid=", rxid, " for ", m_RemoteAddr);
           auto nack = CreatePacket(Command::eNACK, 8);
@@ -864,18 +948,18 @@ namespace llarp
       {
         const llarp_buffer_t buf(
             data.data() + PacketOverhead + 12, data.size() - (PacketOverhead + 12));
-        itr->second.HandleData(sz, buf, m_Parent->Now());
+        msg->HandleData(sz, buf, m_Parent->Now());
       }
 
-      if (itr->second.IsCompleted())
+      if (msg->IsCompleted())
       {
-        if (itr->second.Verify())
+        if (msg->Verify())
         {
-          HandleRecvMsgCompleted(itr->second);
+          HandleRecvMsgCompleted(*msg);
         }
         else
         {
-          LogError("hash mismatch for message ", itr->first);
+          LogError("hash mismatch for message ", rxid);
         }
       }
     }
@@ -884,7 +968,7 @@ namespace llarp
     Session::HandleRecvMsgCompleted(const InboundMessage& msg)
     {
       const auto rxid = msg.m_MsgID;
-      if (m_ReplayFilter.emplace(rxid, m_Parent->Now()).second)
+      if (m_ReplayFilter.Insert(rxid))
       {
         m_Parent->HandleMessage(this, msg.m_Data);
         EncryptAndSend(msg.ACKS());
@@ -904,24 +988,35 @@ namespace llarp
       const auto now = m_Parent->Now();
       m_LastRX = now;
       auto txid = oxenc::load_big_to_host<uint64_t>(data.data() + 2 + PacketOverhead);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr == m_TXMsgs.end())
+      auto* msg = m_TXMsgs.find(txid);
+      if (not msg)
       {
         LogTrace("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      msg->Ack(data[10 + PacketOverhead]);
 
-      if (itr->second.IsTransmitted())
+      const bool done = msg->IsTransmitted();
+      if (done and not msg->m_Retransmitted and msg->m_FirstSentAt > 0s)
+        m_Congestion.OnRTTSample(now - msg->m_FirstSentAt);
+      const size_t unacked = done ? 0 : msg->NumUnAcked();
+      if (msg->m_InFlight > unacked)
       {
-        LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
+        m_Congestion.OnAcked(msg->m_InFlight - unacked, now);
+        msg->m_InFlight = unacked;
       }
-      else
+      if (done)
       {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        LogDebug("sent message ", txid, " to ", m_RemoteAddr);
+        m_Stats.totalAckedTX++;
+        m_Stats.totalInFlightTX--;
+        // out of the window before we inform the waiter, who may queue more messages on us
+        m_TXMsgs.take(txid)->Completed();
       }
+      // the remote acks as soon as it sees the XMIT, so a partial ack usually means the rest is
+      // still on its way rather than lost; anything really missing goes again once the rto is up
+      if (not m_TXPending.empty())
+        TriggerPump();
     }
 
     void
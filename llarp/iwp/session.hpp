@@ -1,11 +1,12 @@
 #pragma once
 
 #include <llarp/link/session.hpp>
+#include "congestion.hpp"
 #include "linklayer.hpp"
 #include "message_buffer.hpp"
+#include "message_window.hpp"
 #include <llarp/net/ip_address.hpp>
 
-#include <map>
 #include <unordered_set>
 #include <deque>
 
@@ -25,12 +26,8 @@ namespace llarp
     static constexpr std::chrono::milliseconds DeliveryTimeout = 500ms;
     /// Time how long we wait to recieve a message
     static constexpr auto ReceivalTimeout = (DeliveryTimeout * 8) / 5;
-    /// How long to keep a replay window for
-    static constexpr auto ReplayWindow = (ReceivalTimeout * 3) / 2;
     /// How often to acks RX messages
     static constexpr auto ACKResendInterval = DeliveryTimeout / 2;
-    /// How often to retransmit TX fragments
-    static constexpr auto TXFlushInterval = (DeliveryTimeout / 5) * 4;
     /// How often we send a keepalive
     static constexpr std::chrono::milliseconds PingInterval = 5s;
     /// How long we wait for a session to die with no tx from them
@@ -68,6 +65,10 @@ namespace llarp
       void
       Send_LL(const byte_t* buf, size_t sz);
 
+      /// send a batch of already encrypted packets to the remote endpoint
+      void
+      SendBatch_LL(const std::vector<Packet_t>& pkts);
+
       void EncryptAndSend(ILinkSession::Packet_t);
 
       void
@@ -191,11 +192,20 @@ namespace llarp
       void
       ResetRates();
 
-      std::map<uint64_t, InboundMessage> m_RXMsgs;
-      std::map<uint64_t, OutboundMessage> m_TXMsgs;
+      /// how far behind our newest rxid we still remember which rxids we have handled
+      static constexpr size_t ReplayWindowSize = 8192;
+
+      MessageWindow<InboundMessage, MaxSendQueueSize> m_RXMsgs;
+      MessageWindow<OutboundMessage, MaxSendQueueSize> m_TXMsgs;
 
-      /// maps rxid to time recieved
-      std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
+      /// rxids we have already handled
+      ReplayWindow<ReplayWindowSize> m_ReplayFilter;
+
+      CongestionControl m_Congestion;
+      /// txids of messages waiting for congestion control to let them out, oldest first
+      std::deque<uint64_t> m_TXPending;
+      /// have we asked the loop to pump us once pacing lets more out
+      bool m_PacingWakeup = false;
       /// rx messages to send in next round of multiacks
       util::ascending_priority_queue<uint64_t> m_SendMACKs;
 
@@ -235,6 +245,18 @@ namespace llarp
       void
       SendMACK();
 
+      /// put a message on the wire for the first time
+      void
+      Transmit(OutboundMessage& msg, llarp_time_t now);
+
+      /// send whatever is unacked of a message we already sent
+      void
+      Retransmit(OutboundMessage& msg, llarp_time_t now);
+
+      /// send as many messages waiting on the window and pacing as they allow
+      void
+      SendPending(llarp_time_t now);
+
       void
       HandleRecvMsgCompleted(const InboundMessage& msg);
 
@@ -143,6 +143,9 @@ namespace llarp
           std::copy_n(buf.base, buf.sz, pkt.data());
           RecvFrom(from, std::move(pkt));
         });
+    m_udp->set_batch_recv([this]([[maybe_unused]] UDPHandle& udp, const auto& pkts) {
+      RecvFromBatch(pkts);
+    });
 
     if (m_udp->listen(m_ourAddr))
       return;
@@ -151,6 +154,13 @@ namespace llarp
         fmt::format("failed to listen {} udp socket on {}", Name(), m_ourAddr)};
   }
 
+  void
+  ILinkLayer::RecvFromBatch(const std::vector<UDPPacket>& pkts)
+  {
+    for (const auto& pkt : pkts)
+      RecvFrom(pkt.from, ILinkSession::Packet_t{pkt.data.begin(), pkt.data.end()});
+  }
+
   void
   ILinkLayer::Pump()
   {
@@ -428,6 +438,13 @@ namespace llarp
       LogError("could not send udp packet to ", to);
   }
 
+  void
+  ILinkLayer::SendBatchTo_LL(const SockAddr& to, const std::vector<byte_view_t>& pkts)
+  {
+    if (const auto sent = m_udp->send_batch(to, pkts); sent != pkts.size())
+      LogError("could only send ", sent, " of ", pkts.size(), " udp packets to ", to);
+  }
+
   bool
   ILinkLayer::SendTo(
       const RouterID& remote,
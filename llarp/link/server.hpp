@@ -107,6 +107,10 @@ namespace llarp
     void
     SendTo_LL(const SockAddr& to, const llarp_buffer_t& pkt);
 
+    /// send several packets to the same remote address with as few syscalls as we can
+    void
+    SendBatchTo_LL(const SockAddr& to, const std::vector<byte_view_t>& pkts);
+
     void
     Bind(AbstractRouter* router, SockAddr addr);
 
@@ -123,6 +127,11 @@ namespace llarp
     virtual void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
 
+    /// handle a batch of packets read off the socket in one go; the default hands each packet to
+    /// RecvFrom individually
+    virtual void
+    RecvFromBatch(const std::vector<UDPPacket>& pkts);
+
     bool
     PickAddress(const RouterContact& rc, AddressInfo& picked) const;
 
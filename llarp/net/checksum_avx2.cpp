@@ -0,0 +1,51 @@
+#include "checksum_avx2.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+namespace llarp::avx2
+{
+  namespace
+  {
+    constexpr size_t BlockSize = 32;
+    /// each 32 bit lane takes a 16 bit word a block, so we widen them before they could carry out
+    constexpr size_t BlocksPerSpill = 0x8000;
+
+    /// add the 8 32 bit lanes of x into the 4 64 bit lanes of acc
+    inline __m256i
+    widen_add(__m256i acc, __m256i x)
+    {
+      acc = _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(x)));
+      return _mm256_add_epi64(acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(x, 1)));
+    }
+  }  // namespace
+
+  uint64_t
+  ipchksum_blocks(const uint8_t* buf, size_t sz)
+  {
+    const __m256i low_words = _mm256_set1_epi32(0xFFff);
+    __m256i total = _mm256_setzero_si256();
+    size_t blocks = sz / BlockSize;
+    while (blocks > 0)
+    {
+      const auto chunk = std::min(blocks, BlocksPerSpill);
+      __m256i lo = _mm256_setzero_si256();
+      __m256i hi = _mm256_setzero_si256();
+      for (size_t idx = 0; idx < chunk; ++idx)
+      {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf));
+        // both halves of every lane, so each 16 bit word lands in the sum as it sits in memory
+        lo = _mm256_add_epi32(lo, _mm256_and_si256(x, low_words));
+        hi = _mm256_add_epi32(hi, _mm256_srli_epi32(x, 16));
+        buf += BlockSize;
+      }
+      total = widen_add(widen_add(total, lo), hi);
+      blocks -= chunk;
+    }
+
+    alignas(BlockSize) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), total);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+}  // namespace llarp::avx2
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp::avx2
+{
+  /// the one's complement sum of sz bytes at buf as native order 16 bit words, 32 bytes at a time
+  /// across the avx2 lanes.  sz must be a multiple of 32.  the sum is not folded, fold it to 16
+  /// bits with whatever else the checksum covers.
+  /// this translation unit is built with -mavx2 so the caller must check the cpu supports avx2.
+  uint64_t
+  ipchksum_blocks(const uint8_t* buf, size_t sz);
+}  // namespace llarp::avx2
@@ -1,5 +1,8 @@
 #include "ip_packet.hpp"
 #include "ip.hpp"
+#ifdef LOKINET_AVX2_KERNELS
+#include "checksum_avx2.hpp"
+#endif
 #include <llarp/constants/net.hpp>
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/mem.hpp>
@@ -11,7 +14,11 @@
 #include <oxenc/endian.h>
 
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
 #include <map>
+#include <mutex>
 
 namespace llarp::net
 {
@@ -89,6 +96,59 @@ namespace llarp::net
     return ExpandV4(dstv4());
   }
 
+  namespace
+  {
+    /// the buffers we keep for reuse.  packets are read on one thread and usually let go of on
+    /// another, so this is shared between all of them.
+    struct RecycledBuffers
+    {
+      /// most buffers we hold on to, enough to cover a burst of packets in flight
+      static constexpr size_t MaxBuffers = 1024;
+      /// largest buffer we keep, anything bigger was grown for something unusual
+      static constexpr size_t MaxCapacity = IPPacket::MaxSize * 4;
+
+      std::mutex access;
+      std::vector<std::vector<byte_t>> buffers;
+
+      static RecycledBuffers&
+      instance()
+      {
+        static RecycledBuffers recycled;
+        return recycled;
+      }
+    };
+  }  // namespace
+
+  std::vector<byte_t>
+  IPPacket::AcquireBuffer()
+  {
+    auto& recycled = RecycledBuffers::instance();
+    {
+      std::lock_guard lock{recycled.access};
+      if (not recycled.buffers.empty())
+      {
+        auto buf = std::move(recycled.buffers.back());
+        recycled.buffers.pop_back();
+        return buf;
+      }
+    }
+    std::vector<byte_t> buf;
+    buf.reserve(MaxSize);
+    return buf;
+  }
+
+  void
+  IPPacket::RecycleBuffer(std::vector<byte_t> buf)
+  {
+    if (buf.capacity() < MaxSize or buf.capacity() > RecycledBuffers::MaxCapacity)
+      return;
+    buf.clear();
+    auto& recycled = RecycledBuffers::instance();
+    std::lock_guard lock{recycled.access};
+    if (recycled.buffers.size() < RecycledBuffers::MaxBuffers)
+      recycled.buffers.emplace_back(std::move(buf));
+  }
+
   IPPacket::IPPacket(byte_view_t view)
   {
     if (view.size() < MinSize)
@@ -96,6 +156,8 @@ namespace llarp::net
       _buf.resize(0);
       return;
     }
+    if (view.size() <= MaxSize)
+      _buf = AcquireBuffer();
     _buf.resize(view.size());
     std::copy_n(view.data(), size(), data());
   }
@@ -104,6 +166,8 @@ namespace llarp::net
   {
     if (sz and sz < MinSize)
       throw std::invalid_argument{"buffer size is too small to hold an ip packet"};
+    if (sz and sz <= MaxSize)
+      _buf = AcquireBuffer();
     _buf.resize(sz);
   }
 
@@ -128,7 +192,7 @@ namespace llarp::net
       return SockAddr{ToNet(dstv6()), port};
   }
 
-  IPPacket::IPPacket(std::vector<byte_t>&& stolen) : _buf{stolen}
+  IPPacket::IPPacket(std::vector<byte_t>&& stolen) : _buf{std::move(stolen)}
   {
     if (size() < MinSize)
       _buf.resize(0);
@@ -203,56 +267,108 @@ namespace llarp::net
     return ExpandV4Lan(srcv4());
   }
 
-  uint16_t
-  ipchksum(const byte_t* buf, size_t sz, uint32_t sum)
+  namespace
   {
-    while (sz > 1)
+    /// one's complement add, the carry out of the top going back in at the bottom
+    inline uint64_t
+    add_carry(uint64_t sum, uint64_t x)
     {
-      sum += *(const uint16_t*)buf;
-      sz -= sizeof(uint16_t);
-      buf += sizeof(uint16_t);
+      sum += x;
+      return sum + (sum < x);
     }
-    if (sz != 0)
+
+    /// fold a wide one's complement sum down to 16 bits
+    inline uint16_t
+    fold_sum(uint64_t sum)
     {
-      uint16_t x = 0;
+      // only need to do each 2 times to be sure
+      // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
+      sum = (sum & 0xFFff'FFff) + (sum >> 32);
+      sum = (sum & 0xFFff'FFff) + (sum >> 32);
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
+      return uint16_t(sum & 0xFFff);
+    }
 
-      *(byte_t*)&x = *(const byte_t*)buf;
-      sum += x;
+    inline uint64_t
+    load_word(const byte_t* buf)
+    {
+      uint64_t x;
+      std::memcpy(&x, buf, sizeof(x));
+      return x;
     }
 
-    // only need to do it 2 times to be sure
-    // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-    sum = (sum & 0xFFff) + (sum >> 16);
-    sum += sum >> 16;
+#ifdef LOKINET_AVX2_KERNELS
+    /// below this the scalar loop is done before the vector one has got going
+    constexpr size_t MinAVX2ChecksumSize = 128;
+
+    bool
+    has_avx2()
+    {
+      static const bool has = [] {
+        const char* disable = std::getenv("AVX2_FORCE_DISABLE");
+        return __builtin_cpu_supports("avx2") and not(disable and std::string{disable} == "1");
+      }();
+      return has;
+    }
+#endif
+  }  // namespace
 
-    return uint16_t((~sum) & 0xFFff);
+  uint16_t
+  ipchksum(const byte_t* buf, size_t sz, uint32_t sum)
+  {
+    // summing 16 bit words 8 bytes at a time gives the same sum once folded, as 2^16 = 1 in one's
+    // complement, so long as every word stays at an even offset
+    uint64_t wide = sum;
+#ifdef LOKINET_AVX2_KERNELS
+    if (sz >= MinAVX2ChecksumSize and has_avx2())
+    {
+      const auto blocks = sz & ~size_t{31};
+      // each lane is summed in 64 bits so it cannot carry out and needs no add_carry
+      wide = add_carry(wide, avx2::ipchksum_blocks(buf, blocks));
+      buf += blocks;
+      sz -= blocks;
+    }
+#endif
+    while (sz >= 32)
+    {
+      wide = add_carry(wide, load_word(buf));
+      wide = add_carry(wide, load_word(buf + 8));
+      wide = add_carry(wide, load_word(buf + 16));
+      wide = add_carry(wide, load_word(buf + 24));
+      sz -= 32;
+      buf += 32;
+    }
+    while (sz >= 8)
+    {
+      wide = add_carry(wide, load_word(buf));
+      sz -= 8;
+      buf += 8;
+    }
+    if (sz != 0)
+    {
+      // an odd last byte is the first byte of a word padded with 0
+      uint64_t x = 0;
+      std::memcpy(&x, buf, sz);
+      wide = add_carry(wide, x);
+    }
+    return uint16_t(~fold_sum(wide));
   }
 
 #define ADD32CS(x) ((uint32_t)(x & 0xFFff) + (uint32_t)(x >> 16))
 #define SUB32CS(x) ((uint32_t)((~x) & 0xFFff) + (uint32_t)((~x) >> 16))
 
-  static nuint16_t
-  deltaIPv4Checksum(
-      nuint16_t old_sum,
-      nuint32_t old_src_ip,
-      nuint32_t old_dst_ip,
-      nuint32_t new_src_ip,
-      nuint32_t new_dst_ip)
+  /// what changing the addresses from old to new adds to a checksum covering them, before folding
+  static uint32_t
+  deltaIPv4Addresses(
+      nuint32_t old_src_ip, nuint32_t old_dst_ip, nuint32_t new_src_ip, nuint32_t new_dst_ip)
   {
-    uint32_t sum = uint32_t(old_sum.n) + ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n)
-        + SUB32CS(new_src_ip.n) + SUB32CS(new_dst_ip.n);
-
-    // only need to do it 2 times to be sure
-    // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-    sum = (sum & 0xFFff) + (sum >> 16);
-    sum += sum >> 16;
-
-    return nuint16_t{uint16_t(sum & 0xFFff)};
+    return ADD32CS(old_src_ip.n) + ADD32CS(old_dst_ip.n) + SUB32CS(new_src_ip.n)
+        + SUB32CS(new_dst_ip.n);
   }
 
-  static nuint16_t
-  deltaIPv6Checksum(
-      nuint16_t old_sum,
+  static uint32_t
+  deltaIPv6Addresses(
       const uint32_t old_src_ip[4],
       const uint32_t old_dst_ip[4],
       const uint32_t new_src_ip[4],
@@ -268,64 +384,30 @@ namespace llarp::net
      * that'd suck for 32bit cpus */
 #define ADDN128CS(x) (ADD32CS(x[0]) + ADD32CS(x[1]) + ADD32CS(x[2]) + ADD32CS(x[3]))
 #define SUBN128CS(x) (SUB32CS(x[0]) + SUB32CS(x[1]) + SUB32CS(x[2]) + SUB32CS(x[3]))
-    uint32_t sum = uint32_t(old_sum.n) + ADDN128CS(old_src_ip) + ADDN128CS(old_dst_ip)
-        + SUBN128CS(new_src_ip) + SUBN128CS(new_dst_ip);
+    return ADDN128CS(old_src_ip) + ADDN128CS(old_dst_ip) + SUBN128CS(new_src_ip)
+        + SUBN128CS(new_dst_ip);
 #undef ADDN128CS
 #undef SUBN128CS
-
-    // only need to do it 2 times to be sure
-    // proof: 0xFFff + 0xFFff = 0x1FFfe -> 0xFFff
-    sum = (sum & 0xFFff) + (sum >> 16);
-    sum += sum >> 16;
-
-    return nuint16_t{uint16_t(sum & 0xFFff)};
   }
 
 #undef ADD32CS
 #undef SUB32CS
 
-  static void
-  deltaChecksumIPv4TCP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      size_t chksumoff,
-      nuint32_t oSrcIP,
-      nuint32_t oDstIP,
-      nuint32_t nSrcIP,
-      nuint32_t nDstIP)
+  static nuint16_t
+  deltaChecksum(nuint16_t old_sum, uint32_t delta)
   {
-    if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
-      return;
-
-    auto check = (nuint16_t*)(pld + chksumoff - fragoff);
-
-    *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // usually, TCP checksum field cannot be 0xFFff,
-    // because one's complement addition cannot result in 0x0000,
-    // and there's inversion in the end;
-    // emulate that.
-    if (check->n == 0xFFff)
-      check->n = 0x0000;
+    return nuint16_t{fold_sum(uint64_t{old_sum.n} + delta)};
   }
 
   static void
-  deltaChecksumIPv6TCP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      size_t chksumoff,
-      const uint32_t oSrcIP[4],
-      const uint32_t oDstIP[4],
-      const uint32_t nSrcIP[4],
-      const uint32_t nDstIP[4])
+  deltaChecksumTCP(byte_t* pld, size_t psz, size_t fragoff, size_t chksumoff, uint32_t delta)
   {
     if (fragoff > chksumoff || psz < chksumoff - fragoff + 2)
       return;
 
     auto check = (nuint16_t*)(pld + chksumoff - fragoff);
 
-    *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
+    *check = deltaChecksum(*check, delta);
     // usually, TCP checksum field cannot be 0xFFff,
     // because one's complement addition cannot result in 0x0000,
     // and there's inversion in the end;
@@ -335,42 +417,7 @@ namespace llarp::net
   }
 
   static void
-  deltaChecksumIPv4UDP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      nuint32_t oSrcIP,
-      nuint32_t oDstIP,
-      nuint32_t nSrcIP,
-      nuint32_t nDstIP)
-  {
-    if (fragoff > 6 || psz < 6 + 2)
-      return;
-
-    auto check = (nuint16_t*)(pld + 6);
-    if (check->n == 0x0000)
-      return;  // 0 is used to indicate "no checksum", don't change
-
-    *check = deltaIPv4Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
-    // 0 is used to indicate "no checksum"
-    // 0xFFff and 0 are equivalent in one's complement math
-    // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
-    // infact it's impossible to get 0 with such addition,
-    // when starting from non-0 value.
-    // inside deltachksum we don't invert so it's safe to skip check there
-    // if(check->n == 0x0000)
-    //   check->n = 0xFFff;
-  }
-
-  static void
-  deltaChecksumIPv6UDP(
-      byte_t* pld,
-      size_t psz,
-      size_t fragoff,
-      const uint32_t oSrcIP[4],
-      const uint32_t oDstIP[4],
-      const uint32_t nSrcIP[4],
-      const uint32_t nDstIP[4])
+  deltaChecksumUDP(byte_t* pld, size_t psz, size_t fragoff, uint32_t delta)
   {
     if (fragoff > 6 || psz < 6 + 2)
       return;
@@ -386,7 +433,7 @@ namespace llarp::net
     if (check->n == 0x0000)
       return;
 
-    *check = deltaIPv6Checksum(*check, oSrcIP, oDstIP, nSrcIP, nDstIP);
+    *check = deltaChecksum(*check, delta);
     // 0 is used to indicate "no checksum"
     // 0xFFff and 0 are equivalent in one's complement math
     // 0xFFff + 1 = 0x10000 -> 0x0001 (same as 0 + 1)
@@ -397,17 +444,14 @@ namespace llarp::net
     //   check->n = 0xFFff;
   }
 
-  void
-  IPPacket::UpdateIPv4Address(nuint32_t nSrcIP, nuint32_t nDstIP)
+  /// write new addresses into a v4 packet and patch its checksums by delta, the change in the sum
+  /// over the addresses
+  static void
+  rewriteIPv4(IPPacket& pkt, nuint32_t nSrcIP, nuint32_t nDstIP, uint32_t delta)
   {
-    llarp::LogDebug("set src=", nSrcIP, " dst=", nDstIP);
-
-    auto hdr = Header();
-
-    auto oSrcIP = nuint32_t{hdr->saddr};
-    auto oDstIP = nuint32_t{hdr->daddr};
-    auto* buf = data();
-    auto sz = size();
+    auto hdr = pkt.Header();
+    auto* buf = pkt.data();
+    auto sz = pkt.size();
     // L4 checksum
     auto ihs = size_t(hdr->ihl * 4);
     if (ihs <= sz)
@@ -420,56 +464,42 @@ namespace llarp::net
       switch (hdr->protocol)
       {
         case 6:  // TCP
-          deltaChecksumIPv4TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumTCP(pld, psz, fragoff, 16, delta);
           break;
         case 17:   // UDP
         case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-          deltaChecksumIPv4UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumUDP(pld, psz, fragoff, delta);
           break;
         case 33:  // DCCP
-          deltaChecksumIPv4TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
+          deltaChecksumTCP(pld, psz, fragoff, 6, delta);
           break;
       }
     }
 
     // IPv4 checksum
     auto v4chk = (nuint16_t*)&(hdr->check);
-    *v4chk = deltaIPv4Checksum(*v4chk, oSrcIP, oDstIP, nSrcIP, nDstIP);
+    *v4chk = deltaChecksum(*v4chk, delta);
 
     // write new IP addresses
     hdr->saddr = nSrcIP.n;
     hdr->daddr = nDstIP.n;
   }
 
-  void
-  IPPacket::UpdateIPv6Address(huint128_t src, huint128_t dst, std::optional<nuint32_t> flowlabel)
+  /// the same for v6, which has no header checksum.  the caller checks pkt is bigger than the v6
+  /// header.
+  static void
+  rewriteIPv6(IPPacket& pkt, const in6_addr& src, const in6_addr& dst, uint32_t delta)
   {
     const size_t ihs = 4 + 4 + 16 + 16;
-    const auto sz = size();
-    // XXX should've been checked at upper level?
-    if (sz <= ihs)
-      return;
-
-    auto hdr = HeaderV6();
-    if (flowlabel.has_value())
-    {
-      // set flow label if desired
-      hdr->FlowLabel(*flowlabel);
-    }
-
-    const auto oldSrcIP = hdr->srcaddr;
-    const auto oldDstIP = hdr->dstaddr;
-    const uint32_t* oSrcIP = in6_uint32_ptr(oldSrcIP);
-    const uint32_t* oDstIP = in6_uint32_ptr(oldDstIP);
+    const auto sz = pkt.size();
+    auto hdr = pkt.HeaderV6();
 
     // IPv6 address
-    hdr->srcaddr = HUIntToIn6(src);
-    hdr->dstaddr = HUIntToIn6(dst);
-    const uint32_t* nSrcIP = in6_uint32_ptr(hdr->srcaddr);
-    const uint32_t* nDstIP = in6_uint32_ptr(hdr->dstaddr);
+    hdr->srcaddr = src;
+    hdr->dstaddr = dst;
 
     // TODO IPv6 header options
-    auto* pld = data() + ihs;
+    auto* pld = pkt.data() + ihs;
     auto psz = sz - ihs;
 
     size_t fragoff = 0;
@@ -520,18 +550,101 @@ namespace llarp::net
     switch (nextproto)
     {
       case 6:  // TCP
-        deltaChecksumIPv6TCP(pld, psz, fragoff, 16, oSrcIP, oDstIP, nSrcIP, nDstIP);
+        deltaChecksumTCP(pld, psz, fragoff, 16, delta);
         break;
       case 17:   // UDP
       case 136:  // UDP-Lite - same checksum place, same 0->0xFFff condition
-        deltaChecksumIPv6UDP(pld, psz, fragoff, oSrcIP, oDstIP, nSrcIP, nDstIP);
+        deltaChecksumUDP(pld, psz, fragoff, delta);
         break;
       case 33:  // DCCP
-        deltaChecksumIPv6TCP(pld, psz, fragoff, 6, oSrcIP, oDstIP, nSrcIP, nDstIP);
+        deltaChecksumTCP(pld, psz, fragoff, 6, delta);
         break;
     }
   }
 
+  void
+  IPPacket::UpdateIPv4Address(nuint32_t nSrcIP, nuint32_t nDstIP)
+  {
+    llarp::LogDebug("set src=", nSrcIP, " dst=", nDstIP);
+
+    auto hdr = Header();
+    const auto delta =
+        deltaIPv4Addresses(nuint32_t{hdr->saddr}, nuint32_t{hdr->daddr}, nSrcIP, nDstIP);
+    rewriteIPv4(*this, nSrcIP, nDstIP, delta);
+  }
+
+  void
+  IPPacket::UpdateIPv6Address(huint128_t src, huint128_t dst, std::optional<nuint32_t> flowlabel)
+  {
+    const size_t ihs = 4 + 4 + 16 + 16;
+    // XXX should've been checked at upper level?
+    if (size() <= ihs)
+      return;
+
+    auto hdr = HeaderV6();
+    if (flowlabel.has_value())
+    {
+      // set flow label if desired
+      hdr->FlowLabel(*flowlabel);
+    }
+
+    const auto nSrcIP = HUIntToIn6(src);
+    const auto nDstIP = HUIntToIn6(dst);
+    const auto delta = deltaIPv6Addresses(
+        in6_uint32_ptr(hdr->srcaddr),
+        in6_uint32_ptr(hdr->dstaddr),
+        in6_uint32_ptr(nSrcIP),
+        in6_uint32_ptr(nDstIP));
+    rewriteIPv6(*this, nSrcIP, nDstIP, delta);
+  }
+
+  void
+  RewriteAddresses(const std::vector<AddressRewrite>& batch)
+  {
+    // the addresses the last delta of each kind was worked out for, consecutive packets of a flow
+    // reuse it
+    std::optional<std::array<nuint32_t, 4>> lastV4;
+    uint32_t deltaV4 = 0;
+    std::optional<std::array<in6_addr, 4>> lastV6;
+    uint32_t deltaV6 = 0;
+
+    for (const auto& rewrite : batch)
+    {
+      auto& pkt = *rewrite.pkt;
+      if (pkt.IsV4())
+      {
+        const auto* hdr = pkt.Header();
+        const std::array<nuint32_t, 4> addrs{
+            nuint32_t{hdr->saddr},
+            nuint32_t{hdr->daddr},
+            xhtonl(TruncateV6(rewrite.src)),
+            xhtonl(TruncateV6(rewrite.dst))};
+        if (addrs != lastV4)
+        {
+          deltaV4 = deltaIPv4Addresses(addrs[0], addrs[1], addrs[2], addrs[3]);
+          lastV4 = addrs;
+        }
+        rewriteIPv4(pkt, addrs[2], addrs[3], deltaV4);
+      }
+      else if (pkt.IsV6() and pkt.size() > 4 + 4 + 16 + 16)
+      {
+        const auto* hdr = pkt.HeaderV6();
+        const std::array<in6_addr, 4> addrs{
+            hdr->srcaddr, hdr->dstaddr, HUIntToIn6(rewrite.src), HUIntToIn6(rewrite.dst)};
+        if (not lastV6 or std::memcmp(addrs.data(), lastV6->data(), sizeof(addrs)) != 0)
+        {
+          deltaV6 = deltaIPv6Addresses(
+              in6_uint32_ptr(addrs[0]),
+              in6_uint32_ptr(addrs[1]),
+              in6_uint32_ptr(addrs[2]),
+              in6_uint32_ptr(addrs[3]));
+          lastV6 = addrs;
+        }
+        rewriteIPv6(pkt, addrs[2], addrs[3], deltaV6);
+      }
+    }
+  }
+
   void
   IPPacket::ZeroAddresses(std::optional<nuint32_t> flowlabel)
   {
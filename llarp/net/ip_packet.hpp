@@ -129,11 +129,33 @@ namespace llarp::net
     /// create an ip packet from a vector we then own
     IPPacket(std::vector<byte_t>&&);
 
-    ~IPPacket() = default;
+    IPPacket(const IPPacket&) = default;
+    IPPacket(IPPacket&&) = default;
+
+    IPPacket&
+    operator=(const IPPacket&) = default;
+    IPPacket&
+    operator=(IPPacket&&) = default;
+
+    ~IPPacket()
+    {
+      if (_buf.capacity() >= MaxSize)
+        RecycleBuffer(std::move(_buf));
+    }
 
     static constexpr size_t MaxSize = _max_size;
     static constexpr size_t MinSize = 20;
 
+    /// get an empty buffer with room for a whole packet, reusing the storage of a packet we
+    /// were done with when there is one.  safe to call from any thread.
+    static std::vector<byte_t>
+    AcquireBuffer();
+
+    /// hand back the storage of a packet we are done with so AcquireBuffer can reuse it.
+    /// buffers too small or too large to be worth keeping are just freed.
+    static void
+    RecycleBuffer(std::vector<byte_t> buf);
+
     [[deprecated("deprecated because of llarp_buffer_t")]] static IPPacket
     UDP(nuint32_t srcaddr,
         nuint16_t srcport,
@@ -166,7 +188,14 @@ namespace llarp::net
     [[deprecated("deprecated because of llarp_buffer_t")]] inline bool
     Load(const llarp_buffer_t& buf)
     {
-      _buf = buf.copy();
+      if (buf.sz <= MaxSize)
+      {
+        if (_buf.capacity() < buf.sz)
+          _buf = AcquireBuffer();
+        _buf.assign(buf.base, buf.base + buf.sz);
+      }
+      else
+        _buf = buf.copy();
       if (size() >= MinSize)
         return true;
       _buf.resize(0);
@@ -374,7 +403,21 @@ namespace llarp::net
     std::function<void(net::IPPacket)> reply;
   };
 
-  /// generate ip checksum
+  /// a packet and the addresses to rewrite it to
+  struct AddressRewrite
+  {
+    IPPacket* pkt;
+    huint128_t src;
+    huint128_t dst;
+  };
+
+  /// rewrite the addresses of each packet in batch as UpdateIPv4Address or UpdateIPv6Address
+  /// would, v4 packets taking the v4 part of src and dst.  consecutive packets going between the
+  /// same addresses share the checksum delta, so a run of one flow's packets works it out once.
+  void
+  RewriteAddresses(const std::vector<AddressRewrite>& batch);
+
+  /// generate ip checksum.  sum is added in first, e.g. a pseudo header's sum.
   uint16_t
   ipchksum(const byte_t* buf, size_t sz, uint32_t sum = 0);
 
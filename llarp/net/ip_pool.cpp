@@ -0,0 +1,98 @@
+#include "ip_pool.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace llarp::net
+{
+  void
+  IPPool::SetRange(huint128_t first, huint128_t last)
+  {
+    m_First = first;
+    m_Next = first;
+    m_Last = last;
+    m_Free.clear();
+  }
+
+  std::optional<huint128_t>
+  IPPool::Allocate(llarp_time_t now)
+  {
+    while (not m_Free.empty())
+    {
+      const auto ip = m_Free.back();
+      m_Free.pop_back();
+      // someone may have marked it active since we released it
+      if (IsTaken(ip))
+        continue;
+      MarkActive(ip, now);
+      return ip;
+    }
+    while (m_Next < m_Last)
+    {
+      const auto ip = ++m_Next;
+      if (ip < m_Last and not IsTaken(ip))
+      {
+        MarkActive(ip, now);
+        return ip;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void
+  IPPool::Release(huint128_t ip)
+  {
+    const auto itr = m_Entries.find(ip);
+    if (itr == m_Entries.end())
+      return;
+    if (itr->second.lru != m_LRU.end())
+      m_LRU.erase(itr->second.lru);
+    m_Entries.erase(itr);
+    // the ones past m_Next we get to when we hand out the rest of the range
+    if (InRange(ip) and not(m_Next < ip))
+      m_Free.push_back(ip);
+  }
+
+  void
+  IPPool::MarkActive(huint128_t ip, llarp_time_t now)
+  {
+    const auto [itr, inserted] = m_Entries.emplace(ip, Entry{now, m_LRU.end()});
+    auto& entry = itr->second;
+    if (inserted)
+    {
+      entry.lru = m_LRU.insert(m_LRU.end(), ip);
+      return;
+    }
+    if (entry.lru == m_LRU.end())
+      return;
+    entry.lastActive = std::max(entry.lastActive, now);
+    m_LRU.splice(m_LRU.end(), m_LRU, entry.lru);
+  }
+
+  void
+  IPPool::MarkActiveForever(huint128_t ip)
+  {
+    auto& entry = m_Entries.emplace(ip, Entry{0s, m_LRU.end()}).first->second;
+    if (entry.lru != m_LRU.end())
+      m_LRU.erase(entry.lru);
+    entry.lru = m_LRU.end();
+    entry.lastActive = std::numeric_limits<llarp_time_t>::max();
+  }
+
+  std::optional<huint128_t>
+  IPPool::Oldest() const
+  {
+    if (m_LRU.empty())
+      return std::nullopt;
+    return m_LRU.front();
+  }
+
+  std::optional<llarp_time_t>
+  IPPool::LastActive(huint128_t ip) const
+  {
+    const auto itr = m_Entries.find(ip);
+    if (itr == m_Entries.end())
+      return std::nullopt;
+    return itr->second.lastActive;
+  }
+}  // namespace llarp::net
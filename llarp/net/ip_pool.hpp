@@ -0,0 +1,103 @@
+#pragma once
+
+#include "net_int.hpp"
+#include <llarp/util/types.hpp>
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace llarp::net
+{
+  /// the addresses of a range that we hand out to remotes, and when each was last used so we know
+  /// which one to take back when we run out.  handing out an address and finding the one that went
+  /// unused the longest are O(1), and we only keep state for the addresses we have handed out.
+  ///
+  /// addresses are marked active with the current time, which must not go backwards; an address
+  /// marked active forever is never the one that went unused the longest.
+  class IPPool
+  {
+   public:
+    /// hand out the addresses after first, up to but not including last.  addresses already
+    /// marked active stay that way and are never handed out.
+    void
+    SetRange(huint128_t first, huint128_t last);
+
+    /// hand out an address nobody has, marking it active at now.  returns std::nullopt when every
+    /// address in the range is taken.
+    std::optional<huint128_t>
+    Allocate(llarp_time_t now);
+
+    /// forget ip, handing it out again later
+    void
+    Release(huint128_t ip);
+
+    /// mark ip as taken and last used at now, unless it is taken forever
+    void
+    MarkActive(huint128_t ip, llarp_time_t now);
+
+    /// mark ip as taken forever
+    void
+    MarkActiveForever(huint128_t ip);
+
+    /// the taken address that went unused the longest, std::nullopt if every address taken is
+    /// taken forever
+    std::optional<huint128_t>
+    Oldest() const;
+
+    /// when ip was last used, std::nullopt if it is not taken
+    std::optional<llarp_time_t>
+    LastActive(huint128_t ip) const;
+
+    bool
+    IsTaken(huint128_t ip) const
+    {
+      return m_Entries.count(ip) > 0;
+    }
+
+    size_t
+    NumTaken() const
+    {
+      return m_Entries.size();
+    }
+
+    /// the highest address we have handed out of the range so far
+    huint128_t
+    Next() const
+    {
+      return m_Next;
+    }
+
+    huint128_t
+    Last() const
+    {
+      return m_Last;
+    }
+
+   private:
+    using LRU_t = std::list<huint128_t>;
+
+    struct Entry
+    {
+      llarp_time_t lastActive;
+      /// where we are in m_LRU, its end if we are taken forever
+      LRU_t::iterator lru;
+    };
+
+    bool
+    InRange(huint128_t ip) const
+    {
+      return m_First < ip and ip < m_Last;
+    }
+
+    huint128_t m_First{0};
+    huint128_t m_Next{0};
+    huint128_t m_Last{0};
+    std::unordered_map<huint128_t, Entry> m_Entries;
+    /// least recently used first, not holding the addresses taken forever
+    LRU_t m_LRU;
+    /// released addresses at or below m_Next
+    std::vector<huint128_t> m_Free;
+  };
+}  // namespace llarp::net
@@ -9,14 +9,16 @@
 #include "util/time.hpp"
 #include "util/mem.hpp"
 #include "util/str.hpp"
-#include "dht/kademlia.hpp"
+#include "dht/xor_index.hpp"
 
 #include <algorithm>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
 static const char skiplist_subdirs[] = "0123456789abcdef";
 static const std::string RC_FILE_EXT = ".signed";
+static const std::string RC_STORE_FILE = "rcs.store";
 
 namespace llarp
 {
@@ -26,7 +28,7 @@ namespace llarp
   {}
 
   static void
-  EnsureSkiplist(fs::path nodedbDir)
+  EnsureNodeDBDir(fs::path nodedbDir)
   {
     if (not fs::exists(nodedbDir))
     {
@@ -41,29 +43,48 @@ namespace llarp
 
     if (not fs::is_directory(nodedbDir))
       throw std::runtime_error{fmt::format("nodedb {} is not a directory", nodedbDir)};
-
-    for (const char& ch : skiplist_subdirs)
-    {
-      // this seems to be a problem on all targets
-      // perhaps cpp17::fs is just as screwed-up
-      // attempting to create a folder with no name
-      // what does this mean...?
-      if (!ch)
-        continue;
-
-      fs::path sub = nodedbDir / std::string(&ch, 1);
-      fs::create_directory(sub);
-    }
   }
 
   constexpr auto FlushInterval = 5min;
 
+  /// fewer rcs than this are not worth starting another thread to check
+  constexpr size_t MinRCsPerThread = 64;
+
+  /// which of rcs have a good signature, checked split over a thread per core as there can be
+  /// thousands of them
+  static std::vector<char>
+  VerifySignatures(const std::vector<RouterContact>& rcs)
+  {
+    // not a vector<bool>, each thread sets its own part
+    std::vector<char> valid(rcs.size());
+    const size_t threads = std::min<size_t>(
+        std::max(std::thread::hardware_concurrency(), 1u),
+        (rcs.size() + MinRCsPerThread - 1) / MinRCsPerThread);
+    if (threads == 0)
+      return valid;
+    const size_t per = (rcs.size() + threads - 1) / threads;
+    const auto verify = [&rcs, &valid, per](size_t begin) {
+      const auto end = std::min(begin + per, rcs.size());
+      for (auto idx = begin; idx < end; ++idx)
+        valid[idx] = rcs[idx].VerifySignature();
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t begin = per; begin < rcs.size(); begin += per)
+      workers.emplace_back(verify, begin);
+    verify(0);
+    for (auto& worker : workers)
+      worker.join();
+    return valid;
+  }
+
   NodeDB::NodeDB(fs::path root, std::function<void(std::function<void()>)> diskCaller)
       : m_Root{std::move(root)}
+      , m_Store{std::make_shared<NodeDBStore>(m_Root / RC_STORE_FILE)}
       , disk(std::move(diskCaller))
       , m_NextFlushAt{time_now_ms() + FlushInterval}
   {
-    EnsureSkiplist(m_Root);
+    EnsureNodeDBDir(m_Root);
   }
   NodeDB::NodeDB() : m_Root{}, disk{[](auto) {}}, m_NextFlushAt{0s}
   {}
@@ -74,44 +95,97 @@ namespace llarp
     if (m_NextFlushAt == 0s)
       return;
 
+    for (const auto& pk : m_Invalid)
+    {
+      if (auto itr = m_Entries.find(pk); itr != m_Entries.end() and not itr->second.verified)
+        EraseEntry(itr);
+    }
+    m_Invalid.clear();
+
     if (now > m_NextFlushAt)
     {
       m_NextFlushAt += FlushInterval;
-      // make copy of all rcs
-      std::vector<RouterContact> copy;
-      for (const auto& item : m_Entries)
-        copy.push_back(item.second.rc);
-      // flush them to disk in one big job
-      // TODO: split this up? idk maybe some day...
-      disk([this, data = std::move(copy)]() {
-        for (const auto& rc : data)
-        {
-          rc.Write(GetPathForPubkey(rc.pubkey));
-        }
-      });
+      // only what changed since the last flush, appended to the store in one write
+      if (auto records = TakeDirty(); not records.empty())
+      {
+        m_Store->Queue(std::move(records));
+        disk([store = m_Store]() { store->Flush(); });
+      }
     }
   }
 
-  fs::path
-  NodeDB::GetPathForPubkey(RouterID pubkey) const
+  bool
+  NodeDB::AddEntry(RouterContact rc)
   {
-    std::string hexString = oxenc::to_hex(pubkey.begin(), pubkey.end());
-    std::string skiplistDir;
+    const RouterID pk{rc.pubkey};
+    auto [itr, inserted] = m_Entries.try_emplace(pk, std::move(rc));
+    if (not inserted)
+      return false;
+    itr->second.index = m_Index.size();
+    m_Index.push_back(&itr->second);
+    m_Sorted.emplace(pk, &itr->second);
+    if (m_Store)
+      m_Dirty.insert(pk);
+    return true;
+  }
 
-    const llarp::RouterID r{pubkey};
-    std::string fname = r.ToString();
+  NodeDB::NodeMap::iterator
+  NodeDB::EraseEntry(NodeMap::iterator itr)
+  {
+    // the last entry takes its place in the index
+    auto* last = m_Index.back();
+    last->index = itr->second.index;
+    m_Index[last->index] = last;
+    m_Index.pop_back();
+    m_Sorted.erase(itr->first);
+    if (m_Store)
+      m_Dirty.insert(itr->first);
+    return m_Entries.erase(itr);
+  }
 
-    skiplistDir += hexString[0];
-    fname += RC_FILE_EXT;
-    return m_Root / skiplistDir / fname;
+  std::vector<NodeDBStore::Record>
+  NodeDB::TakeDirty()
+  {
+    std::vector<NodeDBStore::Record> records;
+    records.reserve(m_Dirty.size());
+    for (const auto& pk : m_Dirty)
+    {
+      const auto itr = m_Entries.find(pk);
+      if (itr == m_Entries.end())
+        records.push_back(NodeDBStore::Remove(pk));
+      else if (auto record = NodeDBStore::Put(itr->second.rc))
+        records.push_back(std::move(*record));
+    }
+    m_Dirty.clear();
+    return records;
   }
 
-  void
-  NodeDB::LoadFromDisk()
+  bool
+  NodeDB::Usable(const Entry& entry) const
   {
-    if (m_Root.empty())
-      return;
+    if (entry.verified)
+      return true;
+    const RouterID pk{entry.rc.pubkey};
+    if (m_Invalid.count(pk))
+      return false;
+    if (entry.rc.VerifySignature())
+    {
+      entry.verified = true;
+      return true;
+    }
+    log::warning(logcat, "dropping rc for {} loaded from disk with a bad signature", pk);
+    m_Invalid.insert(pk);
+    return false;
+  }
+
+  std::vector<fs::path>
+  NodeDB::LoadLegacyFiles()
+  {
+    std::vector<fs::path> legacy;
     std::set<fs::path> purge;
+    // the rcs we might load and the files they are in
+    std::vector<RouterContact> rcs;
+    std::vector<fs::path> files;
 
     for (const char& ch : skiplist_subdirs)
     {
@@ -126,6 +200,7 @@ namespace llarp
         if (not(fs::is_regular_file(f) and f.extension() == RC_FILE_EXT))
           return true;
 
+        legacy.push_back(f);
         RouterContact rc{};
 
         if (not rc.Read(f))
@@ -148,15 +223,23 @@ namespace llarp
           return true;
         }
 
-        // validate signature and purge entries with invalid signatures
-        // load ones with valid signatures
-        if (rc.VerifySignature())
-          m_Entries.emplace(rc.pubkey, rc);
-        else
-          purge.emplace(f);
-
+        files.push_back(f);
+        rcs.push_back(std::move(rc));
         return true;
       });
+      // once its files are gone
+      legacy.push_back(sub);
+    }
+
+    // validate signatures all at once and purge entries with invalid signatures, load ones with
+    // valid signatures
+    const auto valid = VerifySignatures(rcs);
+    for (size_t idx = 0; idx < rcs.size(); ++idx)
+    {
+      if (valid[idx])
+        AddEntry(std::move(rcs[idx]));
+      else
+        purge.emplace(files[idx]);
     }
 
     if (not purge.empty())
@@ -166,25 +249,68 @@ namespace llarp
       for (const auto& fpath : purge)
         fs::remove(fpath);
     }
+    return legacy;
   }
 
   void
-  NodeDB::SaveToDisk() const
+  NodeDB::LoadFromDisk()
   {
-    if (m_Root.empty())
+    if (not m_Store)
+      return;
+
+    if (not fs::exists(m_Store->Path()))
+    {
+      // a nodedb from before the store, move what it has into one
+      auto legacy = LoadLegacyFiles();
+      log::info(logcat, "moving {} rcs into {}", m_Dirty.size(), m_Store->Path());
+      m_Store->Queue(TakeDirty());
+      disk([store = m_Store, legacy = std::move(legacy)]() {
+        if (not store->Flush())
+          return;
+        std::error_code ec;
+        for (const auto& fpath : legacy)
+          fs::remove(fpath, ec);
+      });
       return;
+    }
 
-    for (const auto& item : m_Entries)
+    const auto now = time_now_ms();
+    for (auto& rc : m_Store->Load())
     {
-      item.second.rc.Write(GetPathForPubkey(item.first));
+      // skip entries that are not from our network
+      if (not rc.FromOurNetwork())
+        continue;
+      const RouterID pk{rc.pubkey};
+      if (rc.IsExpired(now))
+      {
+        // so the next flush writes its removal
+        m_Dirty.insert(pk);
+        continue;
+      }
+      if (AddEntry(std::move(rc)))
+      {
+        // the store has it already, and its signature is checked when it is first used
+        m_Dirty.erase(pk);
+        m_Entries.at(pk).verified = false;
+      }
     }
   }
 
+  void
+  NodeDB::SaveToDisk()
+  {
+    if (not m_Store)
+      return;
+    m_Store->Queue(TakeDirty());
+    m_Store->Flush();
+  }
+
   bool
   NodeDB::Has(RouterID pk) const
   {
     util::NullLock lock{m_Access};
-    return m_Entries.find(pk) != m_Entries.end();
+    const auto itr = m_Entries.find(pk);
+    return itr != m_Entries.end() and Usable(itr->second);
   }
 
   std::optional<RouterContact>
@@ -192,7 +318,7 @@ namespace llarp
   {
     util::NullLock lock{m_Access};
     const auto itr = m_Entries.find(pk);
-    if (itr == m_Entries.end())
+    if (itr == m_Entries.end() or not Usable(itr->second))
       return std::nullopt;
     return itr->second.rc;
   }
@@ -201,36 +327,31 @@ namespace llarp
   NodeDB::Remove(RouterID pk)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(pk);
-    AsyncRemoveManyFromDisk({pk});
+    if (auto itr = m_Entries.find(pk); itr != m_Entries.end())
+      EraseEntry(itr);
   }
 
   void
   NodeDB::RemoveStaleRCs(std::unordered_set<RouterID> keep, llarp_time_t cutoff)
   {
     util::NullLock lock{m_Access};
-    std::unordered_set<RouterID> removed;
     auto itr = m_Entries.begin();
     while (itr != m_Entries.end())
     {
       if (itr->second.insertedAt < cutoff and keep.count(itr->second.rc.pubkey) == 0)
-      {
-        removed.insert(itr->second.rc.pubkey);
-        itr = m_Entries.erase(itr);
-      }
+        itr = EraseEntry(itr);
       else
         ++itr;
     }
-    if (not removed.empty())
-      AsyncRemoveManyFromDisk(std::move(removed));
   }
 
   void
   NodeDB::Put(RouterContact rc)
   {
     util::NullLock lock{m_Access};
-    m_Entries.erase(rc.pubkey);
-    m_Entries.emplace(rc.pubkey, rc);
+    if (auto itr = m_Entries.find(rc.pubkey); itr != m_Entries.end())
+      EraseEntry(itr);
+    AddEntry(std::move(rc));
   }
 
   size_t
@@ -244,51 +365,41 @@ namespace llarp
   NodeDB::PutIfNewer(RouterContact rc)
   {
     util::NullLock lock{m_Access};
+    ReplaceIfNewer(std::move(rc));
+  }
+
+  void
+  NodeDB::PutManyIfNewer(std::vector<RouterContact> rcs)
+  {
+    util::NullLock lock{m_Access};
+    for (auto& rc : rcs)
+      ReplaceIfNewer(std::move(rc));
+  }
+
+  void
+  NodeDB::ReplaceIfNewer(RouterContact rc)
+  {
     auto itr = m_Entries.find(rc.pubkey);
     if (itr == m_Entries.end() or itr->second.rc.OtherIsNewer(rc))
     {
       // delete if existing
       if (itr != m_Entries.end())
-        m_Entries.erase(itr);
+        EraseEntry(itr);
       // add new entry
-      m_Entries.emplace(rc.pubkey, rc);
+      AddEntry(std::move(rc));
     }
   }
 
-  void
-  NodeDB::AsyncRemoveManyFromDisk(std::unordered_set<RouterID> remove) const
-  {
-    if (m_Root.empty())
-      return;
-    // build file list
-    std::set<fs::path> files;
-    for (auto id : remove)
-    {
-      files.emplace(GetPathForPubkey(std::move(id)));
-    }
-    // remove them from the disk via the diskio thread
-    disk([files]() {
-      for (auto fpath : files)
-        fs::remove(fpath);
-    });
-  }
-
   llarp::RouterContact
   NodeDB::FindClosestTo(llarp::dht::Key_t location) const
   {
     util::NullLock lock{m_Access};
     llarp::RouterContact rc;
-    const llarp::dht::XorMetric compare(location);
-    VisitAll([&rc, compare](const auto& otherRC) {
-      if (rc.pubkey.IsZero())
-      {
-        rc = otherRC;
-        return;
-      }
-      if (compare(
-              llarp::dht::Key_t{otherRC.pubkey.as_array()},
-              llarp::dht::Key_t{rc.pubkey.as_array()}))
-        rc = otherRC;
+    dht::VisitClosest(m_Sorted, location, [this, &rc](const auto& item) {
+      if (not Usable(*item.second))
+        return true;
+      rc = item.second->rc;
+      return false;
     });
     return rc;
   }
@@ -297,27 +408,15 @@ namespace llarp
   NodeDB::FindManyClosestTo(llarp::dht::Key_t location, uint32_t numRouters) const
   {
     util::NullLock lock{m_Access};
-    std::vector<const RouterContact*> all;
-
-    const auto& entries = m_Entries;
-
-    all.reserve(entries.size());
-    for (auto& entry : entries)
-    {
-      all.push_back(&entry.second.rc);
-    }
-
-    auto it_mid = numRouters < all.size() ? all.begin() + numRouters : all.end();
-    std::partial_sort(
-        all.begin(), it_mid, all.end(), [compare = dht::XorMetric{location}](auto* a, auto* b) {
-          return compare(*a, *b);
-        });
-
     std::vector<RouterContact> closest;
-    closest.reserve(numRouters);
-    for (auto it = all.begin(); it != it_mid; ++it)
-      closest.push_back(**it);
-
+    if (numRouters == 0)
+      return closest;
+    closest.reserve(std::min<size_t>(numRouters, m_Sorted.size()));
+    dht::VisitClosest(m_Sorted, location, [this, &closest, numRouters](const auto& item) {
+      if (Usable(*item.second))
+        closest.push_back(item.second->rc);
+      return closest.size() < numRouters;
+    });
     return closest;
   }
 }  // namespace llarp
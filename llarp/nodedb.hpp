@@ -1,5 +1,6 @@
 #pragma once
 
+#include "nodedb_store.hpp"
 #include "router_contact.hpp"
 #include "router_id.hpp"
 #include "util/common.hpp"
@@ -9,6 +10,8 @@
 #include "dht/key.hpp"
 #include "crypto/crypto.hpp"
 
+#include <map>
+#include <memory>
 #include <set>
 #include <optional>
 #include <unordered_set>
@@ -16,6 +19,8 @@
 #include <utility>
 #include <atomic>
 #include <algorithm>
+#include <random>
+#include <vector>
 
 namespace llarp
 {
@@ -25,27 +30,63 @@ namespace llarp
     {
       const RouterContact rc;
       llarp_time_t insertedAt;
+      /// where we are in m_Index
+      size_t index = 0;
+      /// false for one loaded from disk until its signature is checked, the first time it is used
+      mutable bool verified = true;
       explicit Entry(RouterContact rc);
     };
     using NodeMap = std::unordered_map<RouterID, Entry>;
 
     NodeMap m_Entries;
+    /// every entry in m_Entries, in no particular order, to draw random entries from
+    std::vector<Entry*> m_Index;
+    /// every entry in m_Entries in pubkey order, for dht::VisitClosest
+    std::map<RouterID, const Entry*> m_Sorted;
+
+    /// how many random entries GetRandom tries before it goes through them all
+    static constexpr size_t RandomDraws = 32;
 
     const fs::path m_Root;
 
+    /// where the rcs live on disk, null for an in memory nodedb
+    std::shared_ptr<NodeDBStore> m_Store;
+    /// pubkeys put or removed since we last wrote to the store
+    std::unordered_set<RouterID> m_Dirty;
+    /// entries loaded from disk whose signature turned out bad, dropped at the next Tick
+    mutable std::unordered_set<RouterID> m_Invalid;
+
     const std::function<void(std::function<void()>)> disk;
 
     llarp_time_t m_NextFlushAt;
 
     mutable util::NullMutex m_Access;
 
-    /// asynchronously remove the files for a set of rcs on disk given their public ident key
-    void
-    AsyncRemoveManyFromDisk(std::unordered_set<RouterID> idents) const;
+    /// load the one file per rc that nodedbs kept before the store, checking their signatures in
+    /// parallel, and queue them all to be written to the store.  returns the files to remove once the store has them.
+    std::vector<fs::path>
+    LoadLegacyFiles();
+
+    /// the store records for everything in m_Dirty, which is cleared
+    std::vector<NodeDBStore::Record>
+    TakeDirty();
+
+    /// true if entry can be handed out, checking the signature of one loaded from disk the first
+    /// time it is asked about
+    bool
+    Usable(const Entry& entry) const;
+
+    /// add an entry for rc unless we have one for its pubkey already, returns true if we added it
+    bool
+    AddEntry(RouterContact rc);
 
-    /// get filename of an RC file given its public ident key
-    fs::path
-    GetPathForPubkey(RouterID pk) const;
+    /// erase an entry and take it out of m_Index and m_Sorted, returns the iterator after it
+    NodeMap::iterator
+    EraseEntry(NodeMap::iterator itr);
+
+    /// PutIfNewer with m_Access held
+    void
+    ReplaceIfNewer(RouterContact rc);
 
    public:
     explicit NodeDB(fs::path rootdir, std::function<void(std::function<void()>)> diskCaller);
@@ -53,19 +94,20 @@ namespace llarp
     /// in memory nodedb
     NodeDB();
 
-    /// load all entries from disk syncrhonously
+    /// load all entries from disk syncrhonously.  their signatures are checked when they are
+    /// first used rather than now.
     void
     LoadFromDisk();
 
-    /// explicit save all RCs to disk synchronously
+    /// write what changed since the last flush to disk synchronously
     void
-    SaveToDisk() const;
+    SaveToDisk();
 
     /// the number of RCs that are loaded from disk
     size_t
     NumLoaded() const;
 
-    /// do periodic tasks like flush to disk and expiration
+    /// do periodic tasks like flush what changed to disk and expiration
     void
     Tick(llarp_time_t now);
 
@@ -85,22 +127,35 @@ namespace llarp
     std::optional<RouterContact>
     Get(RouterID pk) const;
 
+    /// a random rc that visit returns true for, std::nullopt if there is none.  visit is asked
+    /// about rcs at random, an rc may be asked about more than once.
     template <typename Filter>
     std::optional<RouterContact>
     GetRandom(Filter visit) const
     {
       util::NullLock lock{m_Access};
+      if (m_Index.empty())
+        return std::nullopt;
+
+      llarp::CSRNG rng{};
+      // usually most entries pass, so a few draws find one without looking at the rest.  drawing
+      // until one passes picks each that passes as likely as any other.
+      std::uniform_int_distribution<size_t> pick{0, m_Index.size() - 1};
+      for (size_t draw = 0; draw < RandomDraws; ++draw)
+      {
+        const auto* entry = m_Index[pick(rng)];
+        if (Usable(*entry) and visit(entry->rc))
+          return entry->rc;
+      }
 
-      std::vector<const decltype(m_Entries)::value_type*> entries;
-      for (const auto& entry : m_Entries)
-        entries.push_back(&entry);
-
-      std::shuffle(entries.begin(), entries.end(), llarp::CSRNG{});
+      // few pass if any, so go through them all in a random order
+      std::vector<const Entry*> entries{m_Index.begin(), m_Index.end()};
+      std::shuffle(entries.begin(), entries.end(), rng);
 
-      for (const auto entry : entries)
+      for (const auto* entry : entries)
       {
-        if (visit(entry->second.rc))
-          return entry->second.rc;
+        if (Usable(*entry) and visit(entry->rc))
+          return entry->rc;
       }
 
       return std::nullopt;
@@ -114,11 +169,13 @@ namespace llarp
       util::NullLock lock{m_Access};
       for (const auto& item : m_Entries)
       {
-        visit(item.second.rc);
+        if (Usable(item.second))
+          visit(item.second.rc);
       }
     }
 
-    /// visit all entries inserted before a timestamp
+    /// visit all entries inserted before a timestamp, ones loaded from disk before their
+    /// signature is checked as this only tells us what to look up again
     template <typename Visit>
     void
     VisitInsertedBefore(Visit visit, llarp_time_t insertedBefore)
@@ -141,20 +198,14 @@ namespace llarp
     RemoveIf(Filter visit)
     {
       util::NullLock lock{m_Access};
-      std::unordered_set<RouterID> removed;
       auto itr = m_Entries.begin();
       while (itr != m_Entries.end())
       {
         if (visit(itr->second.rc))
-        {
-          removed.insert(itr->second.rc.pubkey);
-          itr = m_Entries.erase(itr);
-        }
+          itr = EraseEntry(itr);
         else
           ++itr;
       }
-      if (not removed.empty())
-        AsyncRemoveManyFromDisk(std::move(removed));
     }
 
     /// remove rcs that are not in keep and have been inserted before cutoff
@@ -165,6 +216,10 @@ namespace llarp
     void
     PutIfNewer(RouterContact rc);
 
+    /// PutIfNewer for each of a batch of rcs, all in one go
+    void
+    PutManyIfNewer(std::vector<RouterContact> rcs);
+
     /// unconditional put of rc into cache
     void
     Put(RouterContact rc);
@@ -0,0 +1,263 @@
+#include "nodedb_store.hpp"
+
+#include "util/file.hpp"
+#include "util/logging.hpp"
+
+#include <oxenc/endian.h>
+
+#include <string_view>
+#include <unordered_map>
+
+namespace llarp
+{
+  static auto logcat = log::Cat("nodedb");
+
+  namespace
+  {
+    constexpr std::string_view Magic{"lokinet nodedb 1\n"};
+    constexpr char PutKind = 'p';
+    constexpr char RemoveKind = 'r';
+    /// kind, pubkey and the size of the rc after them
+    constexpr size_t RecordHeaderSize = 1 + RouterID::SIZE + 2;
+
+    void
+    Encode(std::string& out, const NodeDBStore::Record& record)
+    {
+      out += record.rc.empty() ? RemoveKind : PutKind;
+      out.append(reinterpret_cast<const char*>(record.pubkey.data()), RouterID::SIZE);
+      char size[2];
+      oxenc::write_host_as_big<uint16_t>(record.rc.size(), size);
+      out.append(size, sizeof(size));
+      out.append(reinterpret_cast<const char*>(record.rc.data()), record.rc.size());
+    }
+
+    /// visit(kind, pubkey, offset, size) with where the rc is in data for every whole record,
+    /// returns where the last whole record ends, 0 if data is not a store at all
+    template <typename Visit>
+    size_t
+    ForEachRecord(std::string_view data, Visit&& visit)
+    {
+      if (data.substr(0, Magic.size()) != Magic)
+        return 0;
+      size_t pos = Magic.size();
+      while (data.size() - pos >= RecordHeaderSize)
+      {
+        const char kind = data[pos];
+        const size_t size =
+            oxenc::load_big_to_host<uint16_t>(data.data() + pos + 1 + RouterID::SIZE);
+        if ((kind != PutKind and kind != RemoveKind) or data.size() - pos - RecordHeaderSize < size)
+          break;
+        const RouterID pubkey{reinterpret_cast<const byte_t*>(data.data() + pos + 1)};
+        visit(kind, pubkey, pos + RecordHeaderSize, size);
+        pos += RecordHeaderSize + size;
+      }
+      return pos;
+    }
+
+    struct Scan
+    {
+      /// the latest put record for each pubkey, from where its header starts to where it ends
+      std::unordered_map<RouterID, std::pair<size_t, size_t>> latest;
+      /// how many records there are in all
+      size_t records = 0;
+      /// where the last whole record ends
+      size_t end = 0;
+    };
+
+    Scan
+    ScanRecords(std::string_view data)
+    {
+      Scan scan;
+      scan.end = ForEachRecord(
+          data, [&scan](char kind, const RouterID& pubkey, size_t offset, size_t size) {
+            ++scan.records;
+            if (kind == PutKind)
+              scan.latest[pubkey] = {offset - RecordHeaderSize, offset + size};
+            else
+              scan.latest.erase(pubkey);
+          });
+      return scan;
+    }
+  }  // namespace
+
+  NodeDBStore::NodeDBStore(fs::path file) : m_File{std::move(file)}
+  {}
+
+  std::optional<NodeDBStore::Record>
+  NodeDBStore::Put(const RouterContact& rc)
+  {
+    std::array<byte_t, MAX_RC_SIZE> tmp;
+    llarp_buffer_t buf(tmp);
+    if (not rc.BEncode(&buf))
+      return std::nullopt;
+    return Record{RouterID{rc.pubkey}, std::vector<byte_t>{tmp.data(), buf.cur}};
+  }
+
+  NodeDBStore::Record
+  NodeDBStore::Remove(const RouterID& pubkey)
+  {
+    return Record{pubkey, {}};
+  }
+
+  std::vector<RouterContact>
+  NodeDBStore::Load()
+  {
+    std::lock_guard lock{m_Access};
+    m_Live.clear();
+    m_Records = 0;
+    std::string data;
+    try
+    {
+      if (fs::exists(m_File))
+        data = util::slurp_file(m_File);
+    }
+    catch (const std::exception& e)
+    {
+      log::error(logcat, "failed to read {}: {}", m_File, e.what());
+      return {};
+    }
+
+    const auto scan = ScanRecords(data);
+    m_Records = scan.records;
+    if (scan.end < data.size())
+    {
+      log::warning(
+          logcat, "dropping {} bytes of torn records from {}", data.size() - scan.end, m_File);
+      std::error_code ec;
+      fs::resize_file(m_File, scan.end, ec);
+    }
+
+    std::vector<RouterContact> rcs;
+    rcs.reserve(scan.latest.size());
+    for (const auto& [pubkey, range] : scan.latest)
+    {
+      const auto offset = range.first + RecordHeaderSize;
+      RouterContact rc;
+      llarp_buffer_t buf{data.data() + offset, range.second - offset};
+      if (buf.sz > 0 and rc.BDecode(&buf) and RouterID{rc.pubkey} == pubkey)
+      {
+        m_Live.insert(pubkey);
+        rcs.push_back(std::move(rc));
+      }
+      else
+        m_Queued.push_back(Remove(pubkey));
+    }
+    return rcs;
+  }
+
+  void
+  NodeDBStore::Queue(std::vector<Record> records)
+  {
+    std::lock_guard lock{m_Access};
+    if (m_Queued.empty())
+      m_Queued = std::move(records);
+    else
+      m_Queued.insert(
+          m_Queued.end(),
+          std::make_move_iterator(records.begin()),
+          std::make_move_iterator(records.end()));
+  }
+
+  bool
+  NodeDBStore::Flush()
+  {
+    std::lock_guard lock{m_Access};
+    if (m_Queued.empty())
+      return true;
+
+    std::error_code ec;
+    auto before = fs::file_size(m_File, ec);
+    if (ec)
+      before = 0;
+    std::string data;
+    if (before == 0)
+      data = Magic;
+    for (const auto& record : m_Queued)
+      Encode(data, record);
+
+    try
+    {
+      fs::ofstream out;
+      out.exceptions(std::ofstream::failbit | std::ofstream::badbit);
+      out.open(m_File, std::ios::binary | std::ios::out | std::ios::app);
+      out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+    catch (const std::exception& e)
+    {
+      log::error(logcat, "failed to write {} rcs to {}: {}", m_Queued.size(), m_File, e.what());
+      m_Queued.clear();
+      // cut off whatever part we wrote so later records are not appended after a torn one
+      fs::resize_file(m_File, before, ec);
+      return false;
+    }
+
+    for (const auto& record : m_Queued)
+    {
+      if (record.rc.empty())
+        m_Live.erase(record.pubkey);
+      else
+        m_Live.insert(record.pubkey);
+    }
+    m_Records += m_Queued.size();
+    m_Queued.clear();
+
+    if (m_Records > CompactRatio * m_Live.size() + CompactSlack)
+      return Compact();
+    return true;
+  }
+
+  bool
+  NodeDBStore::Compact()
+  {
+    std::string data;
+    try
+    {
+      data = util::slurp_file(m_File);
+    }
+    catch (const std::exception& e)
+    {
+      log::error(logcat, "failed to read {} to compact it: {}", m_File, e.what());
+      return false;
+    }
+
+    const auto scan = ScanRecords(data);
+    std::string compacted{Magic};
+    for (const auto& [pubkey, range] : scan.latest)
+      compacted.append(data, range.first, range.second - range.first);
+
+    auto tmp = m_File;
+    tmp += ".new";
+    try
+    {
+      util::dump_file(tmp, compacted);
+      fs::rename(tmp, m_File);
+    }
+    catch (const std::exception& e)
+    {
+      log::error(logcat, "failed to compact {}: {}", m_File, e.what());
+      return false;
+    }
+
+    log::debug(
+        logcat, "compacted {} from {} records to {}", m_File, scan.records, scan.latest.size());
+    m_Records = scan.latest.size();
+    m_Live.clear();
+    for (const auto& item : scan.latest)
+      m_Live.insert(item.first);
+    return true;
+  }
+
+  size_t
+  NodeDBStore::Records() const
+  {
+    std::lock_guard lock{m_Access};
+    return m_Records;
+  }
+
+  size_t
+  NodeDBStore::Live() const
+  {
+    std::lock_guard lock{m_Access};
+    return m_Live.size();
+  }
+}  // namespace llarp
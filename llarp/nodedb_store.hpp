@@ -0,0 +1,84 @@
+#pragma once
+
+#include "router_contact.hpp"
+#include "router_id.hpp"
+#include "util/fs.hpp"
+
+#include <mutex>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+namespace llarp
+{
+  /// the rcs of a nodedb in one file that we only ever append to, a record for each rc put or
+  /// removed, the last one for a pubkey winning.  once most of the records in it have been replaced
+  /// by later ones it is rewritten holding only the live ones.
+  ///
+  /// Queue and Flush can be called from any thread, Flush does the disk io so is meant for the
+  /// disk thread.
+  class NodeDBStore
+  {
+   public:
+    /// one rc put, or removed if rc is empty
+    struct Record
+    {
+      RouterID pubkey;
+      /// the rc bencoded
+      std::vector<byte_t> rc;
+    };
+
+    /// the file is rewritten once it holds more than this many records per live rc, plus slack
+    static constexpr size_t CompactRatio = 2;
+    static constexpr size_t CompactSlack = 256;
+
+    explicit NodeDBStore(fs::path file);
+
+    const fs::path&
+    Path() const
+    {
+      return m_File;
+    }
+
+    /// the record putting rc, std::nullopt if it does not bencode
+    static std::optional<Record>
+    Put(const RouterContact& rc);
+
+    /// the record removing the rc for pubkey
+    static Record
+    Remove(const RouterID& pubkey);
+
+    /// decode every rc live in the file, their signatures are not checked.  a torn record at the
+    /// end, from a write we did not get to finish, is cut off.
+    std::vector<RouterContact>
+    Load();
+
+    /// queue records to be written by the next Flush, after any already queued
+    void
+    Queue(std::vector<Record> records);
+
+    /// append everything queued in the order it was queued, then compact the file if it is due.
+    /// returns false if writing failed, what was queued is dropped either way.
+    bool
+    Flush();
+
+    /// how many records the file holds
+    size_t
+    Records() const;
+
+    /// how many of them are rcs we still have
+    size_t
+    Live() const;
+
+   private:
+    /// rewrite the file with only the live records, m_Access held
+    bool
+    Compact();
+
+    const fs::path m_File;
+    mutable std::mutex m_Access;
+    std::vector<Record> m_Queued;
+    std::unordered_set<RouterID> m_Live;
+    size_t m_Records = 0;
+  };
+}  // namespace llarp
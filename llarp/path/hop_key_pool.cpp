@@ -0,0 +1,94 @@
+#include "hop_key_pool.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// keys made between taking the lock to add them, so Take is never kept waiting long
+    static constexpr size_t RefillBatch = 16;
+
+    HopKeyPool::HopKeyPool(size_t capacity) : m_Capacity{capacity}
+    {
+      m_Keys.reserve(m_Capacity);
+    }
+
+    SecretKey
+    HopKeyPool::Take()
+    {
+      m_Taken.fetch_add(1, std::memory_order_relaxed);
+      {
+        std::lock_guard lock{m_Access};
+        if (not m_Keys.empty())
+        {
+          SecretKey key = m_Keys.back();
+          // do not leave a copy behind in the spare capacity
+          m_Keys.back().Zero();
+          m_Keys.pop_back();
+          return key;
+        }
+      }
+      m_Missed.fetch_add(1, std::memory_order_relaxed);
+      SecretKey key;
+      CryptoManager::instance()->encryption_keygen(key);
+      return key;
+    }
+
+    bool
+    HopKeyPool::ShouldRefill()
+    {
+      if (Size() > m_Capacity / 2)
+        return false;
+      return not m_Refilling.exchange(true);
+    }
+
+    size_t
+    HopKeyPool::Refill()
+    {
+      auto crypto = CryptoManager::instance();
+      size_t made = 0;
+      std::vector<SecretKey> batch;
+      batch.reserve(RefillBatch);
+      while (true)
+      {
+        const auto want = std::min(RefillBatch, m_Capacity - std::min(Size(), m_Capacity));
+        if (want == 0)
+          break;
+        batch.resize(want);
+        for (auto& key : batch)
+          crypto->encryption_keygen(key);
+        made += want;
+
+        std::lock_guard lock{m_Access};
+        for (auto& key : batch)
+        {
+          if (m_Keys.size() < m_Capacity)
+            m_Keys.push_back(key);
+          key.Zero();
+        }
+      }
+      m_Refilling = false;
+      return made;
+    }
+
+    size_t
+    HopKeyPool::Size() const
+    {
+      std::lock_guard lock{m_Access};
+      return m_Keys.size();
+    }
+
+    util::StatusObject
+    HopKeyPool::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"size", Size()},
+          {"capacity", m_Capacity},
+          {"taken", m_Taken.load(std::memory_order_relaxed)},
+          {"missed", m_Missed.load(std::memory_order_relaxed)}};
+    }
+  }  // namespace path
+}  // namespace llarp
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <llarp/crypto/types.hpp>
+#include <llarp/util/status.hpp>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// ephemeral encryption keypairs made ahead of time by the crypto workers while they are idle,
+    /// so a path build only does its key exchanges on the way to sending the commit.  each hop of
+    /// a build takes two, its commkey and the one its commit record is encrypted with.
+    ///
+    /// Take can be called from any thread, Refill is meant for a crypto worker.
+    class HopKeyPool
+    {
+     public:
+      /// enough for a burst of 32 four hop builds
+      static constexpr size_t DefaultCapacity = 256;
+
+      explicit HopKeyPool(size_t capacity = DefaultCapacity);
+
+      HopKeyPool(const HopKeyPool&) = delete;
+      HopKeyPool&
+      operator=(const HopKeyPool&) = delete;
+
+      /// a keypair nobody else gets, from the pool or made now if it ran dry
+      SecretKey
+      Take();
+
+      /// true if we are down to half capacity and there is no refill going already, in which case
+      /// the caller is expected to Refill
+      bool
+      ShouldRefill();
+
+      /// make keypairs until we are at capacity, returns how many we made
+      size_t
+      Refill();
+
+      size_t
+      Size() const;
+
+      size_t
+      Capacity() const
+      {
+        return m_Capacity;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      const size_t m_Capacity;
+      mutable std::mutex m_Access;
+      std::vector<SecretKey> m_Keys;
+      std::atomic<bool> m_Refilling{false};
+
+      std::atomic<uint64_t> m_Taken{0};
+      /// how many Take made on the spot as we had none
+      std::atomic<uint64_t> m_Missed{0};
+    };
+  }  // namespace path
+}  // namespace llarp
@@ -1,18 +1,30 @@
 #include "ihophandler.hpp"
+#include "path_context.hpp"
 #include <llarp/router/abstractrouter.hpp>
 
 namespace llarp
 {
   namespace path
   {
+    PacketPool&
+    IHopHandler::TrafficPool()
+    {
+      // sized to the relay messages' payload so anything we queue fits back into one.  never
+      // destroyed, buffers may still be held by workers during shutdown.
+      static auto* pool = new PacketPool{MAX_LINK_MSG_SIZE - 128};
+      return *pool;
+    }
+
     // handle data in upstream direction
     bool
     IHopHandler::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      auto& pkt = m_UpstreamQueue.emplace_back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+      auto pkt = TrafficPool().copy_from(X.base, X.sz);
+      if (not pkt)
+        return false;
+      m_UpstreamQueue.emplace_back(std::move(pkt), Y);
+      if (not std::exchange(m_UpstreamPending, true))
+        r->pathContext().QueueUpstreamFlush(GetSelf());
       r->TriggerPump();
       return true;
     }
@@ -21,14 +33,30 @@ namespace llarp
     bool
     IHopHandler::HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
     {
-      auto& pkt = m_DownstreamQueue.emplace_back();
-      pkt.first.resize(X.sz);
-      std::copy_n(X.base, X.sz, pkt.first.begin());
-      pkt.second = Y;
+      auto pkt = TrafficPool().copy_from(X.base, X.sz);
+      if (not pkt)
+        return false;
+      m_DownstreamQueue.emplace_back(std::move(pkt), Y);
+      if (not std::exchange(m_DownstreamPending, true))
+        r->pathContext().QueueDownstreamFlush(GetSelf());
       r->TriggerPump();
       return true;
     }
 
+    void
+    IHopHandler::PumpUpstream(AbstractRouter* r)
+    {
+      m_UpstreamPending = false;
+      FlushUpstream(r);
+    }
+
+    void
+    IHopHandler::PumpDownstream(AbstractRouter* r)
+    {
+      m_DownstreamPending = false;
+      FlushDownstream(r);
+    }
+
     void
     IHopHandler::DecayFilters(llarp_time_t now)
     {
@@ -4,6 +4,7 @@
 #include <llarp/util/types.hpp>
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/util/decaying_hashset.hpp>
+#include <llarp/util/packet_pool.hpp>
 #include <llarp/messages/relay.hpp>
 #include <vector>
 
@@ -24,8 +25,12 @@ namespace llarp
   {
     struct IHopHandler
     {
-      using TrafficEvent_t = std::pair<std::vector<byte_t>, TunnelNonce>;
-      using TrafficQueue_t = std::list<TrafficEvent_t>;
+      using TrafficEvent_t = std::pair<PacketBuffer, TunnelNonce>;
+      using TrafficQueue_t = std::vector<TrafficEvent_t>;
+
+      /// the pool every hop's queued traffic is copied into
+      static PacketPool&
+      TrafficPool();
 
       virtual ~IHopHandler() = default;
 
@@ -71,8 +76,24 @@ namespace llarp
       virtual void
       FlushDownstream(AbstractRouter* r) = 0;
 
+      /// flush upstream traffic for a hop that was put on the path context's work list
+      void
+      PumpUpstream(AbstractRouter* r);
+
+      /// flush downstream traffic for a hop that was put on the path context's work list
+      void
+      PumpDownstream(AbstractRouter* r);
+
      protected:
+      /// get a shared pointer to ourself so we can put ourself on the path context's work lists
+      virtual std::shared_ptr<IHopHandler>
+      GetSelf() = 0;
+
       uint64_t m_SequenceNum = 0;
+      /// true while we are on the path context's upstream work list
+      bool m_UpstreamPending = false;
+      /// true while we are on the path context's downstream work list
+      bool m_DownstreamPending = false;
       TrafficQueue_t m_UpstreamQueue;
       TrafficQueue_t m_DownstreamQueue;
       util::DecayingHashSet<TunnelNonce> m_UpstreamReplayFilter;
@@ -84,10 +105,12 @@ namespace llarp
       virtual void
       DownstreamWork(TrafficQueue_t queue, AbstractRouter* r) = 0;
 
+      /// called on the logic thread with traffic that has had our onion layers applied
       virtual void
-      HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r) = 0;
+      HandleAllUpstream(TrafficQueue_t msgs, AbstractRouter* r) = 0;
+      /// called on the logic thread with traffic that has had our onion layers applied
       virtual void
-      HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) = 0;
+      HandleAllDownstream(TrafficQueue_t msgs, AbstractRouter* r) = 0;
     };
 
     using HopHandler_ptr = std::shared_ptr<IHopHandler>;
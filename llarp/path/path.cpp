@@ -486,10 +486,14 @@ namespace llarp
     }
 
     void
-    Path::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
+    Path::HandleAllUpstream(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      for (const auto& msg : msgs)
+      RelayUpstreamMessage msg;
+      msg.pathid = TXID();
+      for (auto& ev : msgs)
       {
+        msg.X = llarp_buffer_t{ev.first.data(), ev.first.size()};
+        msg.Y = ev.second;
         if (r->SendToOrQueue(Upstream(), msg))
         {
           m_TXRate += msg.X.size();
@@ -505,36 +509,47 @@ namespace llarp
     void
     Path::UpstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      std::vector<RelayUpstreamMessage> sendmsgs(msgs.size());
-      size_t idx = 0;
+      // peel one hop at a time across every message so each layer is a single batch of
+      // independent buffers for the cipher
+      std::vector<TunnelNonce> nonces;
+      nonces.reserve(msgs.size());
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs.size());
       for (auto& ev : msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        TunnelNonce n = ev.second;
-        for (const auto& hop : hops)
-        {
-          CryptoManager::instance()->xchacha20(buf, hop.shared, n);
+        const auto& n = nonces.emplace_back(ev.second);
+        jobs.push_back(XChaCha20Job{ev.first.data(), ev.first.size(), nullptr, &n});
+      }
+      auto crypto = CryptoManager::instance();
+      for (const auto& hop : hops)
+      {
+        for (auto& job : jobs)
+          job.key = &hop.shared;
+        crypto->xchacha20_batch(jobs);
+        for (auto& n : nonces)
           n ^= hop.nonceXOR;
-        }
-        auto& msg = sendmsgs[idx];
-        msg.X = buf;
-        msg.Y = ev.second;
-        msg.pathid = TXID();
-        ++idx;
       }
-      r->loop()->call([self = shared_from_this(), data = std::move(sendmsgs), r]() mutable {
+      r->loop()->call([self = shared_from_this(), data = std::move(msgs), r]() mutable {
         self->HandleAllUpstream(std::move(data), r);
       });
     }
 
+    std::shared_ptr<IHopHandler>
+    Path::GetSelf()
+    {
+      return shared_from_this();
+    }
+
     void
     Path::FlushUpstream(AbstractRouter* r)
     {
       if (not m_UpstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+        r->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data = std::exchange(m_UpstreamQueue, {}), r]() mutable {
+              self->UpstreamWork(std::move(data), r);
+            });
       }
     }
 
@@ -543,9 +558,11 @@ namespace llarp
     {
       if (not m_DownstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+        r->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data = std::exchange(m_DownstreamQueue, {}), r]() mutable {
+              self->DownstreamWork(std::move(data), r);
+            });
       }
     }
 
@@ -579,31 +596,30 @@ namespace llarp
     void
     Path::DownstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      std::vector<RelayDownstreamMessage> sendMsgs(msgs.size());
-      size_t idx = 0;
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs.size());
       for (auto& ev : msgs)
+        jobs.push_back(XChaCha20Job{ev.first.data(), ev.first.size(), nullptr, &ev.second});
+      auto crypto = CryptoManager::instance();
+      for (const auto& hop : hops)
       {
-        const llarp_buffer_t buf(ev.first);
-        sendMsgs[idx].Y = ev.second;
-        for (const auto& hop : hops)
-        {
-          sendMsgs[idx].Y ^= hop.nonceXOR;
-          CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
-        }
-        sendMsgs[idx].X = buf;
-        ++idx;
+        for (auto& ev : msgs)
+          ev.second ^= hop.nonceXOR;
+        for (auto& job : jobs)
+          job.key = &hop.shared;
+        crypto->xchacha20_batch(jobs);
       }
-      r->loop()->call([self = shared_from_this(), msgs = std::move(sendMsgs), r]() mutable {
+      r->loop()->call([self = shared_from_this(), msgs = std::move(msgs), r]() mutable {
         self->HandleAllDownstream(std::move(msgs), r);
       });
     }
 
     void
-    Path::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
+    Path::HandleAllDownstream(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      for (const auto& msg : msgs)
+      for (auto& ev : msgs)
       {
-        const llarp_buffer_t buf{msg.X};
+        const llarp_buffer_t buf{ev.first.data(), ev.first.size()};
         m_RXRate += buf.sz;
         if (HandleRoutingMessage(buf, r))
         {
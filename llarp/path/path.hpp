@@ -387,6 +387,9 @@ namespace llarp
       FlushDownstream(AbstractRouter* r) override;
 
      protected:
+      std::shared_ptr<IHopHandler>
+      GetSelf() override;
+
       void
       UpstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
 
@@ -394,10 +397,10 @@ namespace llarp
       DownstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
 
       void
-      HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllUpstream(TrafficQueue_t msgs, AbstractRouter* r) override;
 
       void
-      HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllDownstream(TrafficQueue_t msgs, AbstractRouter* r) override;
 
      private:
       bool
@@ -12,7 +12,10 @@ namespace llarp
     static constexpr auto DefaultPathBuildLimit = 500ms;
 
     PathContext::PathContext(AbstractRouter* router)
-        : m_Router(router), m_AllowTransit(false), m_PathLimits(DefaultPathBuildLimit)
+        : m_Router(router)
+        , m_HopKeys(std::make_shared<HopKeyPool>())
+        , m_AllowTransit(false)
+        , m_PathLimits(DefaultPathBuildLimit)
     {}
 
     void
@@ -304,15 +307,31 @@ namespace llarp
     void
     PathContext::PumpUpstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
+      m_PumpingWork.swap(m_UpstreamWork);
+      for (const auto& hop : m_PumpingWork)
+        hop->PumpUpstream(m_Router);
+      m_PumpingWork.clear();
     }
 
     void
     PathContext::PumpDownstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
+      m_PumpingWork.swap(m_DownstreamWork);
+      for (const auto& hop : m_PumpingWork)
+        hop->PumpDownstream(m_Router);
+      m_PumpingWork.clear();
+    }
+
+    void
+    PathContext::QueueUpstreamFlush(HopHandler_ptr hop)
+    {
+      m_UpstreamWork.emplace_back(std::move(hop));
+    }
+
+    void
+    PathContext::QueueDownstreamFlush(HopHandler_ptr hop)
+    {
+      m_DownstreamWork.emplace_back(std::move(hop));
     }
 
     uint64_t
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <llarp/crypto/encrypted_frame.hpp>
+#include "hop_key_pool.hpp"
 #include <llarp/net/ip_address.hpp>
 #include "ihophandler.hpp"
 #include "path_types.hpp"
@@ -38,12 +39,22 @@ namespace llarp
       void
       ExpirePaths(llarp_time_t now);
 
+      /// flush upstream traffic on every hop that queued some since the last pump
       void
       PumpUpstream();
 
+      /// flush downstream traffic on every hop that queued some since the last pump
       void
       PumpDownstream();
 
+      /// put a hop with queued upstream traffic on the work list for the next pump
+      void
+      QueueUpstreamFlush(HopHandler_ptr hop);
+
+      /// put a hop with queued downstream traffic on the work list for the next pump
+      void
+      QueueDownstreamFlush(HopHandler_ptr hop);
+
       void
       AllowTransit();
 
@@ -166,6 +177,13 @@ namespace llarp
       const SecretKey&
       EncryptionSecretKey();
 
+      /// the keypairs our path builds take their ephemeral keys from
+      const std::shared_ptr<HopKeyPool>&
+      HopKeys() const
+      {
+        return m_HopKeys;
+      }
+
       const byte_t*
       OurRouterID() const;
 
@@ -181,6 +199,14 @@ namespace llarp
       AbstractRouter* m_Router;
       SyncTransitMap_t m_TransitPaths;
       SyncOwnedPathsMap_t m_OurPaths;
+      /// shared so refills queued on the crypto workers can hold onto it
+      std::shared_ptr<HopKeyPool> m_HopKeys;
+      /// hops with queued traffic, so a pump costs O(active hops) rather than O(all hops);
+      /// only touched from the logic thread
+      std::vector<HopHandler_ptr> m_UpstreamWork;
+      std::vector<HopHandler_ptr> m_DownstreamWork;
+      /// the list being drained by the current pump, kept around to reuse its storage
+      std::vector<HopHandler_ptr> m_PumpingWork;
       bool m_AllowTransit;
       util::DecayingHashSet<IpAddress> m_PathLimits;
     };
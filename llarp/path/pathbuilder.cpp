@@ -34,6 +34,8 @@ namespace llarp
     Handler result;
     size_t idx = 0;
     AbstractRouter* router = nullptr;
+    /// where our ephemeral keypairs come from, made ahead of time
+    std::shared_ptr<path::HopKeyPool> keys;
     WorkerFunc_t work;
     EventLoop_ptr loop;
     LR_CommitMessage LRCM;
@@ -47,8 +49,8 @@ namespace llarp
 
       auto crypto = CryptoManager::instance();
 
-      // generate key
-      crypto->encryption_keygen(hop.commkey);
+      // take key
+      hop.commkey = keys->Take();
       hop.nonce.Randomize();
       // do key exchange
       if (!crypto->dh_client(hop.shared, hop.rc.enckey, hop.commkey, hop.nonce))
@@ -92,8 +94,7 @@ namespace llarp
         return;
       }
       // use ephemeral keypair for frame
-      SecretKey framekey;
-      crypto->encryption_keygen(framekey);
+      SecretKey framekey = keys->Take();
       if (!frame.EncryptInPlace(framekey, hop.rc.enckey))
       {
         LogError(pathset->Name(), " Failed to encrypt LRCR");
@@ -373,29 +374,29 @@ namespace llarp
         }
         else
         {
-          auto filter =
-              [&hops, r = m_router, endpointRC, pathConfig, exclude](const auto& rc) -> bool {
-            if (exclude.count(rc.pubkey))
-              return false;
-
-            std::set<RouterContact> hopsSet;
-            hopsSet.insert(endpointRC);
-            hopsSet.insert(hops.begin(), hops.end());
+          // what the hops we have rule out, worked out once here rather than for every candidate
+          std::set<RouterContact> hopsSet{hops.begin(), hops.end()};
+          hopsSet.insert(endpointRC);
+          std::set<RouterID> chosen;
+          for (const auto& hop : hopsSet)
+            chosen.insert(hop.pubkey);
+#ifndef TESTNET
+          const auto taken = pathConfig.TakenRanges(hopsSet);
+          if (not taken)
+            return std::nullopt;
+#endif
 
-            if (r->routerProfiling().IsBadForPath(rc.pubkey, 1))
+          auto filter = [&](const auto& rc) -> bool {
+            if (exclude.count(rc.pubkey) or chosen.count(rc.pubkey))
               return false;
-            for (const auto& hop : hopsSet)
-            {
-              if (hop.pubkey == rc.pubkey)
-                return false;
-            }
 
-            hopsSet.insert(rc);
+            if (m_router->routerProfiling().IsBadForPath(rc.pubkey, 1))
+              return false;
 #ifndef TESTNET
-            if (not pathConfig.Acceptable(hopsSet))
+            if (not pathConfig.Acceptable(*taken, rc))
               return false;
 #endif
-            return rc.pubkey != endpointRC.pubkey;
+            return true;
           };
 
           if (const auto maybe = m_router->nodedb()->GetRandom(filter))
@@ -440,6 +441,7 @@ namespace llarp
       // async generate keys
       auto ctx = std::make_shared<AsyncPathKeyExchangeContext>();
       ctx->router = m_router;
+      ctx->keys = m_router->pathContext().HopKeys();
       auto self = GetSelf();
       ctx->pathset = self;
       std::string path_shortName = "[path " + m_router->ShortName() + "-";
@@ -105,28 +105,35 @@ namespace llarp
       return HandleDownstream(buf, N, r);
     }
 
+    void
+    TransitHop::XorBatch(TrafficQueue_t& msgs) const
+    {
+      std::vector<XChaCha20Job> jobs;
+      jobs.reserve(msgs.size());
+      for (auto& ev : msgs)
+        jobs.push_back(XChaCha20Job{ev.first.data(), ev.first.size(), &pathKey, &ev.second});
+      CryptoManager::instance()->xchacha20_batch(jobs);
+      for (auto& ev : msgs)
+        ev.second ^= nonceXOR;
+    }
+
     void
     TransitHop::DownstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
       auto flushIt = [self = shared_from_this(), r]() {
-        std::vector<RelayDownstreamMessage> msgs;
+        TrafficQueue_t msgs;
         while (auto maybe = self->m_DownstreamGather.tryPopFront())
         {
-          msgs.push_back(*maybe);
+          msgs.push_back(std::move(*maybe));
         }
         self->HandleAllDownstream(std::move(msgs), r);
       };
+      XorBatch(msgs);
       for (auto& ev : msgs)
       {
-        RelayDownstreamMessage msg;
-        const llarp_buffer_t buf(ev.first);
-        msg.pathid = info.rxID;
-        msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.X = buf;
         llarp::LogDebug(
             "relay ",
-            msg.X.size(),
+            ev.first.size(),
             " bytes downstream from ",
             info.upstream,
             " to ",
@@ -136,7 +143,7 @@ namespace llarp
           r->loop()->call(flushIt);
         }
         if (m_DownstreamGather.enabled())
-          m_DownstreamGather.pushBack(msg);
+          m_DownstreamGather.pushBack(std::move(ev));
       }
       r->loop()->call(flushIt);
     }
@@ -144,37 +151,32 @@ namespace llarp
     void
     TransitHop::UpstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
+      XorBatch(msgs);
       for (auto& ev : msgs)
       {
-        const llarp_buffer_t buf(ev.first);
-        RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.pathid = info.txID;
-        msg.Y = ev.second ^ nonceXOR;
-        msg.X = buf;
-        if (m_UpstreamGather.tryPushBack(msg) != thread::QueueReturn::Success)
+        if (m_UpstreamGather.tryPushBack(std::move(ev)) != thread::QueueReturn::Success)
           break;
       }
 
       // Flush it:
       r->loop()->call([self = shared_from_this(), r] {
-        std::vector<RelayUpstreamMessage> msgs;
+        TrafficQueue_t msgs;
         while (auto maybe = self->m_UpstreamGather.tryPopFront())
         {
-          msgs.push_back(*maybe);
+          msgs.push_back(std::move(*maybe));
         }
         self->HandleAllUpstream(std::move(msgs), r);
       });
     }
 
     void
-    TransitHop::HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r)
+    TransitHop::HandleAllUpstream(TrafficQueue_t msgs, AbstractRouter* r)
     {
       if (IsEndpoint(r->pubkey()))
       {
-        for (const auto& msg : msgs)
+        for (auto& ev : msgs)
         {
-          const llarp_buffer_t buf(msg.X);
+          const llarp_buffer_t buf{ev.first.data(), ev.first.size()};
           if (!r->ParseRoutingMessageBuffer(buf, this, info.rxID))
           {
             LogWarn("invalid upstream data on endpoint ", info);
@@ -190,15 +192,19 @@ namespace llarp
       }
       else
       {
-        for (const auto& msg : msgs)
+        RelayUpstreamMessage msg;
+        msg.pathid = info.txID;
+        for (auto& ev : msgs)
         {
           llarp::LogDebug(
               "relay ",
-              msg.X.size(),
+              ev.first.size(),
               " bytes upstream from ",
               info.downstream,
               " to ",
               info.upstream);
+          msg.X = llarp_buffer_t{ev.first.data(), ev.first.size()};
+          msg.Y = ev.second;
           r->SendToOrQueue(info.upstream, msg);
         }
       }
@@ -206,30 +212,42 @@ namespace llarp
     }
 
     void
-    TransitHop::HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r)
+    TransitHop::HandleAllDownstream(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      for (const auto& msg : msgs)
+      RelayDownstreamMessage msg;
+      msg.pathid = info.rxID;
+      for (auto& ev : msgs)
       {
         llarp::LogDebug(
             "relay ",
-            msg.X.size(),
+            ev.first.size(),
             " bytes downstream from ",
             info.upstream,
             " to ",
             info.downstream);
+        msg.X = llarp_buffer_t{ev.first.data(), ev.first.size()};
+        msg.Y = ev.second;
         r->SendToOrQueue(info.downstream, msg);
       }
       r->TriggerPump();
     }
 
+    std::shared_ptr<IHopHandler>
+    TransitHop::GetSelf()
+    {
+      return shared_from_this();
+    }
+
     void
     TransitHop::FlushUpstream(AbstractRouter* r)
     {
       if (not m_UpstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+        r->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data = std::exchange(m_UpstreamQueue, {}), r]() mutable {
+              self->UpstreamWork(std::move(data), r);
+            });
       }
     }
 
@@ -238,9 +256,11 @@ namespace llarp
     {
       if (not m_DownstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+        r->QueuePinnedWork(
+            reinterpret_cast<uintptr_t>(this),
+            [self = shared_from_this(), data = std::exchange(m_DownstreamQueue, {}), r]() mutable {
+              self->DownstreamWork(std::move(data), r);
+            });
       }
     }
 
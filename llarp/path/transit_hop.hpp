@@ -183,6 +183,9 @@ namespace llarp
       QueueDestroySelf(AbstractRouter* r);
 
      protected:
+      std::shared_ptr<IHopHandler>
+      GetSelf() override;
+
       void
       UpstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
 
@@ -190,18 +193,23 @@ namespace llarp
       DownstreamWork(TrafficQueue_t queue, AbstractRouter* r) override;
 
       void
-      HandleAllUpstream(std::vector<RelayUpstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllUpstream(TrafficQueue_t msgs, AbstractRouter* r) override;
 
       void
-      HandleAllDownstream(std::vector<RelayDownstreamMessage> msgs, AbstractRouter* r) override;
+      HandleAllDownstream(TrafficQueue_t msgs, AbstractRouter* r) override;
 
      private:
+      /// xor every message in the queue with our layer of the onion as a single batch, then advance
+      /// each nonce to what the next hop expects
+      void
+      XorBatch(TrafficQueue_t& msgs) const;
+
       void
       SetSelfDestruct();
 
       std::set<std::shared_ptr<TransitHop>, ComparePtr<std::shared_ptr<TransitHop>>> m_FlushOthers;
-      thread::Queue<RelayUpstreamMessage> m_UpstreamGather;
-      thread::Queue<RelayDownstreamMessage> m_DownstreamGather;
+      thread::Queue<TrafficEvent_t> m_UpstreamGather;
+      thread::Queue<TrafficEvent_t> m_DownstreamGather;
       std::atomic<uint32_t> m_UpstreamWorkCounter;
       std::atomic<uint32_t> m_DownstreamWorkCounter;
     };
@@ -157,6 +157,10 @@ namespace llarp
     /// call function in crypto worker
     virtual void QueueWork(std::function<void(void)>) = 0;
 
+    /// call function in crypto worker, on the same worker as and after any earlier work queued
+    /// with the same affinity (typically the address of the session or path the work is for)
+    virtual void QueuePinnedWork(uint64_t affinity, std::function<void(void)>) = 0;
+
     /// call function in disk io thread
     virtual void QueueDiskIO(std::function<void(void)>) = 0;
 
@@ -292,9 +296,6 @@ namespace llarp
     virtual bool
     GetRandomConnectedRouter(RouterContact& result) const = 0;
 
-    virtual void
-    HandleDHTLookupForExplore(RouterID remote, const std::vector<RouterContact>& results) = 0;
-
     virtual void SetDownHook(std::function<void(void)>){};
 
     /// lookup router by pubkey
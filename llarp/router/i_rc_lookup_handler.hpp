@@ -3,6 +3,7 @@
 #include <llarp/util/types.hpp>
 #include <llarp/router_id.hpp>
 
+#include <functional>
 #include <memory>
 #include <set>
 #include <vector>
@@ -22,6 +23,9 @@ namespace llarp
   using RCRequestCallback =
       std::function<void(const RouterID&, const RouterContact* const, const RCRequestResult)>;
 
+  /// called with the rcs of a batch that passed CheckRCs
+  using CheckRCsHook_t = std::function<void(std::vector<RouterContact>)>;
+
   struct I_RCLookupHandler
   {
     virtual ~I_RCLookupHandler() = default;
@@ -59,6 +63,12 @@ namespace llarp
     virtual bool
     CheckRC(const RouterContact& rc) const = 0;
 
+    /// CheckRC for a batch of rcs, checked on the crypto workers a few at a time in parallel.
+    /// the ones that pass are put into the nodedb and dht together on the logic thread, which
+    /// then calls hook with them.
+    virtual void
+    CheckRCs(std::vector<RouterContact> rcs, CheckRCsHook_t hook = nullptr) const = 0;
+
     virtual bool
     GetRandomWhitelistRouter(RouterID& router) const = 0;
 
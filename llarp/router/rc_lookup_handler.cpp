@@ -12,6 +12,8 @@
 #include <llarp/dht/context.hpp>
 #include "abstractrouter.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <iterator>
 #include <functional>
 #include <random>
@@ -217,6 +219,80 @@ namespace llarp
     return true;
   }
 
+  /// how many rcs of a batch one job on the workers checks
+  constexpr size_t RCsPerJob = 16;
+
+  void
+  RCLookupHandler::CheckRCs(std::vector<RouterContact> rcs, CheckRCsHook_t hook) const
+  {
+    rcs.erase(
+        std::remove_if(
+            rcs.begin(),
+            rcs.end(),
+            [this](const auto& rc) {
+              if (SessionIsAllowed(rc.pubkey))
+                return false;
+              _dht->impl->DelRCNodeAsync(dht::Key_t{rc.pubkey});
+              return true;
+            }),
+        rcs.end());
+    if (rcs.empty())
+    {
+      if (hook)
+        hook({});
+      return;
+    }
+
+    struct Batch
+    {
+      std::vector<RouterContact> rcs;
+      /// not a vector<bool>, each job sets its own part
+      std::vector<char> valid;
+      std::atomic<size_t> jobs;
+      CheckRCsHook_t hook;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->valid.resize(rcs.size());
+    batch->jobs = (rcs.size() + RCsPerJob - 1) / RCsPerJob;
+    batch->rcs = std::move(rcs);
+    batch->hook = std::move(hook);
+
+    const auto now = _dht->impl->Now();
+    for (size_t begin = 0; begin < batch->rcs.size(); begin += RCsPerJob)
+    {
+      _work([this, batch, begin, now] {
+        const auto end = std::min(begin + RCsPerJob, batch->rcs.size());
+        for (auto idx = begin; idx < end; ++idx)
+          batch->valid[idx] = batch->rcs[idx].Verify(now);
+        if (--batch->jobs > 0)
+          return;
+        // the last job to finish hands the whole batch back to merge in one go
+        _loop->call([this, batch] {
+          std::vector<RouterContact> valid, pub;
+          for (size_t idx = 0; idx < batch->rcs.size(); ++idx)
+          {
+            auto& rc = batch->rcs[idx];
+            if (not batch->valid[idx])
+            {
+              LogWarn("RC for ", RouterID(rc.pubkey), " is invalid");
+              continue;
+            }
+            if (rc.IsPublicRouter())
+            {
+              _dht->impl->Nodes()->PutNode(rc);
+              pub.push_back(rc);
+            }
+            valid.push_back(std::move(rc));
+          }
+          LogDebug("adding or updating ", pub.size(), " RCs to nodedb and dht");
+          _nodedb->PutManyIfNewer(std::move(pub));
+          if (batch->hook)
+            batch->hook(std::move(valid));
+        });
+      });
+    }
+  }
+
   size_t
   RCLookupHandler::NumberOfStrictConnectRouters() const
   {
@@ -77,6 +77,9 @@ namespace llarp
     bool
     CheckRC(const RouterContact& rc) const override;
 
+    void
+    CheckRCs(std::vector<RouterContact> rcs, CheckRCsHook_t hook = nullptr) const override;
+
     bool
     GetRandomWhitelistRouter(RouterID& router) const override EXCLUDES(_mutex);
 
@@ -106,7 +106,10 @@ namespace llarp
         {"services", _hiddenServiceContext.ExtractStatus()},
         {"exit", _exitContext.ExtractStatus()},
         {"links", _linkManager.ExtractStatus()},
-        {"outboundMessages", _outboundMessageHandler.ExtractStatus()}};
+        {"outboundMessages", _outboundMessageHandler.ExtractStatus()},
+        {"cryptoWorkers",
+         m_CryptoWorkers ? m_CryptoWorkers->ExtractStatus() : util::StatusObject{}},
+        {"hopKeys", paths.HopKeys()->ExtractStatus()}};
   }
 
   util::StatusObject
@@ -439,6 +442,13 @@ namespace llarp
     log::debug(logcat, "Starting OMQ server");
     m_lmq->start();
 
+    size_t cryptoThreads = std::thread::hardware_concurrency();
+    if (conf.router.m_cryptoThreads > 0)
+      cryptoThreads = conf.router.m_cryptoThreads;
+    log::debug(logcat, "Starting {} crypto workers", cryptoThreads);
+    m_CryptoWorkers = std::make_unique<thread::WorkerPool>(cryptoThreads, "lokinet-crypto");
+    m_CryptoWorkers->Start();
+
     _nodedb = std::move(nodedb);
 
     m_isServiceNode = conf.router.m_isRelay;
@@ -1146,6 +1156,9 @@ namespace llarp
         [&peersWeHave](const dht::Key_t& k) -> bool { return peersWeHave.count(k) == 0; });
     // expire paths
     paths.ExpirePaths(now);
+    // make keys for path builds ahead of time while the crypto workers have nothing else to do
+    if (m_CryptoWorkers and m_CryptoWorkers->QueueDepth() == 0 and paths.HopKeys()->ShouldRefill())
+      QueueWork([keys = paths.HopKeys()] { keys->Refill(); });
     // update tick timestamp
     _lastTick = llarp::time_now_ms();
   }
@@ -1214,15 +1227,6 @@ namespace llarp
     return _linkManager.GetRandomConnectedRouter(result);
   }
 
-  void
-  Router::HandleDHTLookupForExplore(RouterID /*remote*/, const std::vector<RouterContact>& results)
-  {
-    for (const auto& rc : results)
-    {
-      _rcLookupHandler.CheckRC(rc);
-    }
-  }
-
   // TODO: refactor callers and remove this function
   void
   Router::LookupRouter(RouterID remote, RouterLookupHandler resultHandler)
@@ -1492,6 +1496,11 @@ namespace llarp
   {
     llarp::sys::service_manager->stopping();
     Close();
+    if (m_CryptoWorkers)
+    {
+      log::debug(logcat, "stopping crypto workers");
+      m_CryptoWorkers->Stop();
+    }
     log::debug(logcat, "stopping oxenmq");
     m_lmq.reset();
   }
@@ -1631,7 +1640,19 @@ namespace llarp
   void
   Router::QueueWork(std::function<void(void)> func)
   {
-    m_lmq->job(std::move(func));
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->AddJob(std::move(func));
+    else
+      m_lmq->job(std::move(func));
+  }
+
+  void
+  Router::QueuePinnedWork(uint64_t affinity, std::function<void(void)> func)
+  {
+    if (m_CryptoWorkers)
+      m_CryptoWorkers->AddJob(affinity, std::move(func));
+    else
+      m_lmq->job(std::move(func));
   }
 
   void
@@ -34,6 +34,7 @@
 #include <llarp/util/mem.hpp>
 #include <llarp/util/status.hpp>
 #include <llarp/util/str.hpp>
+#include <llarp/util/thread/worker_pool.hpp>
 #include <llarp/util/time.hpp>
 #include <llarp/util/service_manager.hpp>
 
@@ -199,6 +200,9 @@ namespace llarp
     void
     QueueWork(std::function<void(void)> func) override;
 
+    void
+    QueuePinnedWork(uint64_t affinity, std::function<void(void)> func) override;
+
     void
     QueueDiskIO(std::function<void(void)> func) override;
 
@@ -233,6 +237,8 @@ namespace llarp
     std::shared_ptr<NodeDB> _nodedb;
     llarp_time_t _startedAt;
     const oxenmq::TaggedThreadID m_DiskThread;
+    /// runs QueueWork jobs, started once we are configured
+    std::unique_ptr<thread::WorkerPool> m_CryptoWorkers;
 
     llarp_time_t
     Uptime() const override;
@@ -525,9 +531,6 @@ namespace llarp
     bool
     GetRandomConnectedRouter(RouterContact& result) const override;
 
-    void
-    HandleDHTLookupForExplore(RouterID remote, const std::vector<RouterContact>& results) override;
-
     void
     LookupRouter(RouterID remote, RouterLookupHandler resultHandler) override;
 
@@ -0,0 +1,81 @@
+#include "convo_map.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace service
+  {
+    Session&
+    ConvoMap::operator[](const ConvoTag& tag)
+    {
+      return m_Sessions[tag];
+    }
+
+    std::pair<ConvoMap::iterator, bool>
+    ConvoMap::emplace(const ConvoTag& tag, Session session)
+    {
+      auto result = m_Sessions.emplace(tag, std::move(session));
+      if (not result.second)
+        return result;
+      const auto& added = result.first->second;
+      if (const auto addr = added.Addr(); not addr.IsZero())
+      {
+        auto& remote = m_Remotes[addr];
+        remote.tags.push_back(tag);
+        if (added.inbound)
+          remote.inbound++;
+        remote.best.reset();
+      }
+      return result;
+    }
+
+    ConvoMap::iterator
+    ConvoMap::erase(const_iterator itr)
+    {
+      Unindex(itr->first, itr->second);
+      return m_Sessions.erase(itr);
+    }
+
+    size_t
+    ConvoMap::erase(const ConvoTag& tag)
+    {
+      const auto itr = m_Sessions.find(tag);
+      if (itr == m_Sessions.end())
+        return 0;
+      erase(itr);
+      return 1;
+    }
+
+    const ConvoMap::Remote*
+    ConvoMap::FindRemote(const Address& addr) const
+    {
+      const auto itr = m_Remotes.find(addr);
+      if (itr == m_Remotes.end())
+        return nullptr;
+      return &itr->second;
+    }
+
+    void
+    ConvoMap::Unindex(const ConvoTag& tag, const Session& session)
+    {
+      const auto addr = session.Addr();
+      if (addr.IsZero())
+        return;
+      const auto itr = m_Remotes.find(addr);
+      if (itr == m_Remotes.end())
+        return;
+      auto& remote = itr->second;
+      const auto found = std::find(remote.tags.begin(), remote.tags.end(), tag);
+      if (found == remote.tags.end())
+        return;
+      *found = remote.tags.back();
+      remote.tags.pop_back();
+      if (session.inbound)
+        remote.inbound--;
+      remote.best.reset();
+      if (remote.tags.empty())
+        m_Remotes.erase(itr);
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "address.hpp"
+#include "convotag.hpp"
+#include "session.hpp"
+#include <llarp/util/time.hpp>
+
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// our sessions by convo tag.  alongside them we index the convo tags we have with each remote
+    /// address, so finding the sessions for an address on the per packet send path looks at just
+    /// those sessions rather than scanning all of them.
+    ///
+    /// a session is indexed by the remote it has when it is added; the remote of a session already
+    /// in the map must not change.
+    class ConvoMap
+    {
+      using Map_t = std::unordered_map<ConvoTag, Session>;
+
+     public:
+      using iterator = Map_t::iterator;
+      using const_iterator = Map_t::const_iterator;
+
+      /// the convo tags we have with one remote address
+      struct Remote
+      {
+        std::vector<ConvoTag> tags;
+        /// how many of those sessions are inbound
+        size_t inbound = 0;
+        /// the tag GetBestConvoTagFor last picked for this remote and when, forgotten whenever
+        /// the tags change
+        mutable std::optional<ConvoTag> best;
+        mutable llarp_time_t rankedAt = 0s;
+
+        bool
+        HasInbound() const
+        {
+          return inbound > 0;
+        }
+
+        bool
+        HasOutbound() const
+        {
+          return inbound < tags.size();
+        }
+      };
+
+      iterator
+      begin()
+      {
+        return m_Sessions.begin();
+      }
+
+      iterator
+      end()
+      {
+        return m_Sessions.end();
+      }
+
+      const_iterator
+      begin() const
+      {
+        return m_Sessions.begin();
+      }
+
+      const_iterator
+      end() const
+      {
+        return m_Sessions.end();
+      }
+
+      iterator
+      find(const ConvoTag& tag)
+      {
+        return m_Sessions.find(tag);
+      }
+
+      const_iterator
+      find(const ConvoTag& tag) const
+      {
+        return m_Sessions.find(tag);
+      }
+
+      size_t
+      count(const ConvoTag& tag) const
+      {
+        return m_Sessions.count(tag);
+      }
+
+      size_t
+      size() const
+      {
+        return m_Sessions.size();
+      }
+
+      bool
+      empty() const
+      {
+        return m_Sessions.empty();
+      }
+
+      /// get the session for tag, adding an empty one with no remote if we have none
+      Session&
+      operator[](const ConvoTag& tag);
+
+      /// add a session for tag with the remote it has, if we do not have one already.  returns
+      /// the session for tag and whether we added it.
+      std::pair<iterator, bool>
+      emplace(const ConvoTag& tag, Session session);
+
+      iterator
+      erase(const_iterator itr);
+
+      size_t
+      erase(const ConvoTag& tag);
+
+      /// the convo tags we have with addr, nullptr if we have none
+      const Remote*
+      FindRemote(const Address& addr) const;
+
+     private:
+      void
+      Unindex(const ConvoTag& tag, const Session& session);
+
+      Map_t m_Sessions;
+      std::unordered_map<Address, Remote> m_Remotes;
+    };
+  }  // namespace service
+}  // namespace llarp
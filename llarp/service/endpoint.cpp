@@ -48,6 +48,9 @@ namespace llarp
   {
     static auto logcat = log::Cat("endpoint");
 
+    /// how long GetBestConvoTagFor keeps picking the same convo tag before ranking them again
+    static constexpr auto ConvoTagRankInterval = 100ms;
+
     Endpoint::Endpoint(AbstractRouter* r, Context* parent)
         : path::Builder{r, 3, path::default_len}
         , context{parent}
@@ -513,23 +516,15 @@ namespace llarp
     bool
     Endpoint::HasInboundConvo(const Address& addr) const
     {
-      for (const auto& item : Sessions())
-      {
-        if (item.second.remote.Addr() == addr and item.second.inbound)
-          return true;
-      }
-      return false;
+      const auto* remote = Sessions().FindRemote(addr);
+      return remote and remote->HasInbound();
     }
 
     bool
     Endpoint::HasOutboundConvo(const Address& addr) const
     {
-      for (const auto& item : Sessions())
-      {
-        if (item.second.remote.Addr() == addr && not item.second.inbound)
-          return true;
-      }
-      return false;
+      const auto* remote = Sessions().FindRemote(addr);
+      return remote and remote->HasOutbound();
     }
 
     void
@@ -553,29 +548,25 @@ namespace llarp
               tag);
           return;
         }
-        itr = Sessions().emplace(tag, Session{}).first;
-        itr->second.inbound = inbound;
-        itr->second.remote = info;
+        Session session{};
+        session.inbound = inbound;
+        session.remote = info;
+        Sessions().emplace(tag, std::move(session));
       }
     }
 
     size_t
     Endpoint::RemoveAllConvoTagsFor(service::Address remote)
     {
-      size_t removed = 0;
       auto& sessions = Sessions();
-      auto itr = sessions.begin();
-      while (itr != sessions.end())
-      {
-        if (itr->second.remote.Addr() == remote)
-        {
-          itr = sessions.erase(itr);
-          removed++;
-        }
-        else
-          ++itr;
-      }
-      return removed;
+      const auto* convos = sessions.FindRemote(remote);
+      if (not convos)
+        return 0;
+      // erasing the last of them drops the index entry we are looking at
+      const auto tags = convos->tags;
+      for (const auto& tag : tags)
+        sessions.erase(tag);
+      return tags.size();
     }
 
     bool
@@ -646,12 +637,7 @@ namespace llarp
     void
     Endpoint::PutCachedSessionKeyFor(const ConvoTag& tag, const SharedSecret& k)
     {
-      auto itr = Sessions().find(tag);
-      if (itr == Sessions().end())
-      {
-        itr = Sessions().emplace(tag, Session{}).first;
-      }
-      itr->second.sharedKey = k;
+      Sessions()[tag].sharedKey = k;
     }
 
     void
@@ -1811,58 +1797,69 @@ namespace llarp
       // get convotag with lowest estimated RTT
       if (auto ptr = std::get_if<Address>(&remote))
       {
+        const auto* convos = Sessions().FindRemote(*ptr);
+        if (not convos)
+          return std::nullopt;
+        // this runs for every packet we send, so only rank the tags again every so often
+        const auto now = Now();
+        if (convos->best and now < convos->rankedAt + ConvoTagRankInterval)
+          return convos->best;
+
         llarp_time_t rtt = 30s;
         std::optional<ConvoTag> ret = std::nullopt;
-        for (const auto& [tag, session] : Sessions())
+        for (const auto& tag : convos->tags)
         {
           if (tag.IsZero())
             continue;
-          if (session.remote.Addr() == *ptr)
+          const auto itr = Sessions().find(tag);
+          if (itr == Sessions().end())
+            continue;
+          const auto& session = itr->second;
+          if (*ptr == m_Identity.pub.Addr())
+          {
+            return tag;
+          }
+          if (session.inbound)
           {
-            if (*ptr == m_Identity.pub.Addr())
+            auto path = GetPathByRouter(session.replyIntro.router);
+            // if we have no path to the remote router that's fine still use it just in case this
+            // is the ONLY one we have
+            if (path == nullptr)
             {
-              return tag;
+              ret = tag;
+              continue;
             }
-            if (session.inbound)
+
+            if (path and path->IsReady())
             {
-              auto path = GetPathByRouter(session.replyIntro.router);
-              // if we have no path to the remote router that's fine still use it just in case this
-              // is the ONLY one we have
-              if (path == nullptr)
+              const auto rttEstimate = (session.replyIntro.latency + path->intro.latency) * 2;
+              if (rttEstimate < rtt)
               {
                 ret = tag;
-                continue;
-              }
-
-              if (path and path->IsReady())
-              {
-                const auto rttEstimate = (session.replyIntro.latency + path->intro.latency) * 2;
-                if (rttEstimate < rtt)
-                {
-                  ret = tag;
-                  rtt = rttEstimate;
-                }
+                rtt = rttEstimate;
               }
             }
-            else
+          }
+          else
+          {
+            auto range = m_state->m_RemoteSessions.equal_range(*ptr);
+            auto itr = range.first;
+            while (itr != range.second)
             {
-              auto range = m_state->m_RemoteSessions.equal_range(*ptr);
-              auto itr = range.first;
-              while (itr != range.second)
+              if (itr->second->ReadyToSend() and itr->second->estimatedRTT > 0s)
               {
-                if (itr->second->ReadyToSend() and itr->second->estimatedRTT > 0s)
+                if (itr->second->estimatedRTT < rtt)
                 {
-                  if (itr->second->estimatedRTT < rtt)
-                  {
-                    ret = tag;
-                    rtt = itr->second->estimatedRTT;
-                  }
+                  ret = tag;
+                  rtt = itr->second->estimatedRTT;
                 }
-                itr++;
               }
+              itr++;
             }
           }
         }
+        convos->best = ret;
+        convos->rankedAt = now;
         return ret;
       }
       if (auto* ptr = std::get_if<RouterID>(&remote))
@@ -2,6 +2,7 @@
 
 #include "pendingbuffer.hpp"
 #include "router_lookup_job.hpp"
+#include "convo_map.hpp"
 #include "session.hpp"
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/thread/queue.hpp>
@@ -43,8 +44,6 @@ namespace llarp
 
     using SNodeSessions = std::unordered_map<RouterID, std::shared_ptr<exit::BaseSession>>;
 
-    using ConvoMap = std::unordered_map<ConvoTag, Session>;
-
     /// set of outbound addresses to maintain to
     using OutboundSessions_t = std::unordered_set<Address>;
 
@@ -172,18 +172,16 @@ namespace llarp
     EndpointUtil::GetConvoTagsForService(
         const ConvoMap& sessions, const Address& info, std::set<ConvoTag>& tags)
     {
+      const auto* remote = sessions.FindRemote(info);
+      if (not remote)
+        return false;
       bool inserted = false;
-      auto itr = sessions.begin();
-      while (itr != sessions.end())
+      for (const auto& tag : remote->tags)
       {
-        if (itr->second.remote.Addr() == info)
+        if (tags.emplace(tag).second)
         {
-          if (tags.emplace(itr->first).second)
-          {
-            inserted = true;
-          }
+          inserted = true;
         }
-        ++itr;
       }
       return inserted;
     }
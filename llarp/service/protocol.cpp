@@ -1,4 +1,5 @@
 #include "protocol.hpp"
+#include <llarp/net/ip_packet.hpp>
 #include <llarp/path/path.hpp>
 #include <llarp/routing/handler.hpp>
 #include <llarp/util/buffer.hpp>
@@ -20,11 +21,17 @@ namespace llarp
     ProtocolMessage::ProtocolMessage(const ConvoTag& t) : tag(t)
     {}
 
-    ProtocolMessage::~ProtocolMessage() = default;
+    ProtocolMessage::~ProtocolMessage()
+    {
+      net::IPPacket::RecycleBuffer(std::move(payload));
+    }
 
     void
     ProtocolMessage::PutBuffer(const llarp_buffer_t& buf)
     {
+      // payloads are almost always ip packets, so share their buffers
+      if (payload.capacity() < buf.sz and buf.sz <= net::IPPacket::MaxSize)
+        payload = net::IPPacket::AcquireBuffer();
       payload.resize(buf.sz);
       memcpy(payload.data(), buf.base, buf.sz);
     }
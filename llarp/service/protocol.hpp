@@ -36,6 +36,12 @@ namespace llarp
     {
       ProtocolMessage(const ConvoTag& tag);
       ProtocolMessage();
+      ProtocolMessage(const ProtocolMessage&) = default;
+      ProtocolMessage(ProtocolMessage&&) = default;
+      ProtocolMessage&
+      operator=(const ProtocolMessage&) = default;
+      ProtocolMessage&
+      operator=(ProtocolMessage&&) = default;
       ~ProtocolMessage();
       ProtocolType proto = ProtocolType::TrafficV4;
       llarp_time_t queued = 0s;
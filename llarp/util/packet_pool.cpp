@@ -0,0 +1,82 @@
+#include "packet_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace llarp
+{
+  PacketBuffer::PacketBuffer(const PacketBuffer& other) : m_Slot{other.m_Slot}
+  {
+    if (m_Slot)
+      m_Slot->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  PacketBuffer::~PacketBuffer()
+  {
+    if (m_Slot and m_Slot->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      m_Slot->pool->release(m_Slot);
+  }
+
+  void
+  PacketBuffer::resize(size_t sz)
+  {
+    if (m_Slot)
+      m_Slot->size = std::min<size_t>(sz, m_Slot->capacity);
+  }
+
+  PacketPool::PacketPool(size_t capacity, size_t slab_slots)
+      : m_Capacity{capacity}, m_SlabSlots{std::max<size_t>(slab_slots, 1)}
+  {}
+
+  PacketPool::~PacketPool()
+  {
+    assert(m_Free.size() == m_Slabs.size() * m_SlabSlots);
+  }
+
+  PacketBuffer
+  PacketPool::acquire()
+  {
+    std::unique_lock lock{m_Access};
+    if (m_Free.empty())
+    {
+      // keep every header aligned by rounding each slot up to a whole number of headers
+      constexpr auto header = sizeof(PacketBuffer::Slot);
+      const auto stride = ((header + m_Capacity + header - 1) / header) * header;
+      auto& slab = m_Slabs.emplace_back(new byte_t[stride * m_SlabSlots]);
+      m_Free.reserve(m_Slabs.size() * m_SlabSlots);
+      for (size_t idx = m_SlabSlots; idx > 0; --idx)
+      {
+        auto* slot = new (slab.get() + (stride * (idx - 1))) PacketBuffer::Slot{};
+        slot->capacity = m_Capacity;
+        slot->pool = this;
+        m_Free.push_back(slot);
+      }
+    }
+    auto* slot = m_Free.back();
+    m_Free.pop_back();
+    lock.unlock();
+    slot->refs.store(1, std::memory_order_relaxed);
+    slot->size = 0;
+    return PacketBuffer{slot};
+  }
+
+  PacketBuffer
+  PacketPool::copy_from(const byte_t* ptr, size_t sz)
+  {
+    if (sz > m_Capacity)
+      return PacketBuffer{};
+    auto buf = acquire();
+    std::memcpy(buf.data(), ptr, sz);
+    buf.resize(sz);
+    return buf;
+  }
+
+  void
+  PacketPool::release(PacketBuffer::Slot* slot)
+  {
+    std::lock_guard lock{m_Access};
+    m_Free.push_back(slot);
+  }
+}  // namespace llarp
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llarp
+{
+  class PacketPool;
+
+  /// refcounted handle to a fixed capacity buffer taken from a PacketPool.  copying a handle
+  /// shares the underlying buffer; the buffer goes back to its pool when the last handle to it is
+  /// dropped, from whichever thread that happens on.
+  class PacketBuffer
+  {
+   public:
+    PacketBuffer() = default;
+
+    PacketBuffer(const PacketBuffer& other);
+
+    PacketBuffer(PacketBuffer&& other) noexcept : m_Slot{other.m_Slot}
+    {
+      other.m_Slot = nullptr;
+    }
+
+    PacketBuffer&
+    operator=(PacketBuffer other) noexcept
+    {
+      std::swap(m_Slot, other.m_Slot);
+      return *this;
+    }
+
+    ~PacketBuffer();
+
+    explicit operator bool() const
+    {
+      return m_Slot != nullptr;
+    }
+
+    byte_t*
+    data()
+    {
+      return m_Slot ? m_Slot->data() : nullptr;
+    }
+
+    const byte_t*
+    data() const
+    {
+      return m_Slot ? m_Slot->data() : nullptr;
+    }
+
+    /// the number of bytes in use
+    size_t
+    size() const
+    {
+      return m_Slot ? m_Slot->size : 0;
+    }
+
+    /// the most bytes this buffer can hold
+    size_t
+    capacity() const
+    {
+      return m_Slot ? m_Slot->capacity : 0;
+    }
+
+    /// set the number of bytes in use, clamped to capacity()
+    void
+    resize(size_t sz);
+
+   private:
+    friend class PacketPool;
+
+    /// header placed in front of each buffer in a pool slab
+    struct Slot
+    {
+      std::atomic<uint32_t> refs;
+      uint32_t size;
+      uint32_t capacity;
+      PacketPool* pool;
+
+      /// the buffer itself sits directly after its header
+      byte_t*
+      data()
+      {
+        return reinterpret_cast<byte_t*>(this + 1);
+      }
+    };
+
+    explicit PacketBuffer(Slot* slot) : m_Slot{slot}
+    {}
+
+    Slot* m_Slot = nullptr;
+  };
+
+  /// a pool of fixed capacity packet buffers carved out of large slabs so that queueing relayed
+  /// traffic does not go through the allocator per packet.  slabs are only released when the pool
+  /// is destroyed, which must not happen while any of its buffers are still held.
+  class PacketPool
+  {
+   public:
+    /// make a pool of buffers each able to hold `capacity` bytes, growing `slab_slots` buffers at
+    /// a time
+    explicit PacketPool(size_t capacity, size_t slab_slots = 256);
+
+    PacketPool(const PacketPool&) = delete;
+    PacketPool&
+    operator=(const PacketPool&) = delete;
+
+    ~PacketPool();
+
+    /// take an empty buffer from the pool, growing the pool if there are none free
+    PacketBuffer
+    acquire();
+
+    /// take a buffer from the pool and copy `sz` bytes into it; returns an empty handle if `sz`
+    /// is larger than our buffer capacity
+    PacketBuffer
+    copy_from(const byte_t* ptr, size_t sz);
+
+    size_t
+    capacity() const
+    {
+      return m_Capacity;
+    }
+
+   private:
+    friend class PacketBuffer;
+
+    void
+    release(PacketBuffer::Slot* slot);
+
+    const size_t m_Capacity;
+    const size_t m_SlabSlots;
+    std::mutex m_Access;
+    std::vector<std::unique_ptr<byte_t[]>> m_Slabs;
+    std::vector<PacketBuffer::Slot*> m_Free;
+  };
+}  // namespace llarp
@@ -0,0 +1,265 @@
+#include "worker_pool.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// how long an idle worker sleeps before looking for work to steal again, in case it missed
+    /// a wakeup
+    static constexpr std::chrono::milliseconds IdleWait{10};
+
+    WorkerPool::WorkerPool(size_t workers, std::string name, size_t queue_size)
+        : m_Name{std::move(name)}
+    {
+      workers = std::max<size_t>(workers, 1);
+      m_Workers.reserve(workers);
+      for (size_t idx = 0; idx < workers; ++idx)
+        m_Workers.emplace_back(std::make_unique<Worker>(queue_size));
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+      Stop();
+    }
+
+    void
+    WorkerPool::Start()
+    {
+      if (m_Running.exchange(true))
+        return;
+      for (size_t idx = 0; idx < m_Workers.size(); ++idx)
+      {
+        auto& worker = *m_Workers[idx];
+        worker.pinned.enable();
+        worker.shared.enable();
+        worker.thread = std::thread{[this, idx]() {
+          util::SetThreadName(m_Name + "-" + std::to_string(idx));
+          Run(idx);
+        }};
+      }
+    }
+
+    void
+    WorkerPool::Stop()
+    {
+      if (not m_Running.exchange(false))
+        return;
+      for (auto& worker : m_Workers)
+      {
+        // disabling also wakes anyone blocked pushing onto a full queue
+        worker->pinned.disable();
+        worker->shared.disable();
+        {
+          std::lock_guard lock{worker->sleepMutex};
+          worker->sleepCV.notify_all();
+        }
+      }
+      for (auto& worker : m_Workers)
+      {
+        if (worker->thread.joinable())
+          worker->thread.join();
+        worker->pinned.removeAll();
+        worker->shared.removeAll();
+        std::lock_guard lock{worker->overflowMutex};
+        worker->overflow.clear();
+        worker->overflowSize = 0;
+      }
+      std::lock_guard lock{m_OverflowMutex};
+      m_Overflow.clear();
+      m_OverflowSize = 0;
+    }
+
+    bool
+    WorkerPool::AddJob(Job_t job)
+    {
+      const auto num = m_Workers.size();
+      const auto start = m_NextWorker.fetch_add(1, std::memory_order_relaxed) % num;
+      Entry ent{std::move(job), Clock_t::now()};
+      // prefer a worker with room in its queue, only overflow if everyone is backed up
+      for (size_t n = 0; n < num; ++n)
+      {
+        const auto idx = (start + n) % num;
+        switch (m_Workers[idx]->shared.tryPushBack(std::move(ent)))
+        {
+          case QueueReturn::Success:
+            Wake(idx);
+            return true;
+          case QueueReturn::QueueDisabled:
+            return false;
+          default:
+            break;
+        }
+      }
+      {
+        std::lock_guard lock{m_OverflowMutex};
+        if (not m_Running)
+          return false;
+        m_Overflow.push_back(std::move(ent));
+        m_OverflowSize++;
+      }
+      m_Overflowed.fetch_add(1, std::memory_order_relaxed);
+      Wake(start);
+      return true;
+    }
+
+    bool
+    WorkerPool::AddJob(uint64_t affinity, Job_t job)
+    {
+      // affinities are usually addresses, which share their low bits, so mix before picking
+      affinity ^= affinity >> 33;
+      affinity *= 0xff51afd7ed558ccdULL;
+      affinity ^= affinity >> 33;
+      const auto idx = affinity % m_Workers.size();
+      auto& worker = *m_Workers[idx];
+      Entry ent{std::move(job), Clock_t::now()};
+      // once anything has overflowed, everything after it has to as well to stay in order
+      if (worker.overflowSize == 0)
+      {
+        switch (worker.pinned.tryPushBack(std::move(ent)))
+        {
+          case QueueReturn::Success:
+            Wake(idx);
+            return true;
+          case QueueReturn::QueueDisabled:
+            return false;
+          default:
+            break;
+        }
+      }
+      {
+        std::lock_guard lock{worker.overflowMutex};
+        if (not m_Running)
+          return false;
+        worker.overflow.push_back(std::move(ent));
+        worker.overflowSize++;
+      }
+      m_Overflowed.fetch_add(1, std::memory_order_relaxed);
+      Wake(idx);
+      return true;
+    }
+
+    size_t
+    WorkerPool::QueueDepth() const
+    {
+      size_t depth = m_OverflowSize;
+      for (const auto& worker : m_Workers)
+        depth += worker->pinned.size() + worker->shared.size() + worker->overflowSize;
+      return depth;
+    }
+
+    util::StatusObject
+    WorkerPool::ExtractStatus() const
+    {
+      const auto executed = m_Executed.load(std::memory_order_relaxed);
+      const auto totalWait = m_TotalWaitUS.load(std::memory_order_relaxed);
+      return util::StatusObject{
+          {"workers", m_Workers.size()},
+          {"queued", QueueDepth()},
+          {"executed", executed},
+          {"stolen", m_Stolen.load(std::memory_order_relaxed)},
+          {"overflowed", m_Overflowed.load(std::memory_order_relaxed)},
+          {"avgWaitUS", executed ? totalWait / executed : 0},
+          {"maxWaitUS", m_MaxWaitUS.load(std::memory_order_relaxed)}};
+    }
+
+    void
+    WorkerPool::Wake(size_t idx)
+    {
+      if (m_Workers[idx]->sleeping.load())
+      {
+        std::lock_guard lock{m_Workers[idx]->sleepMutex};
+        m_Workers[idx]->sleepCV.notify_one();
+        return;
+      }
+      // the worker we queued on is busy, poke an idle one so it can steal
+      for (auto& worker : m_Workers)
+      {
+        if (worker->sleeping.load())
+        {
+          std::lock_guard lock{worker->sleepMutex};
+          worker->sleepCV.notify_one();
+          return;
+        }
+      }
+    }
+
+    std::optional<WorkerPool::Entry>
+    WorkerPool::NextJob(size_t idx)
+    {
+      auto& self = *m_Workers[idx];
+      if (auto ent = self.pinned.tryPopFront())
+        return ent;
+      // only once the pinned queue is drained, everything overflowed came after what is in it
+      if (auto ent = PopOverflow(self.overflowMutex, self.overflow, self.overflowSize))
+        return ent;
+      if (auto ent = self.shared.tryPopFront())
+        return ent;
+      if (auto ent = PopOverflow(m_OverflowMutex, m_Overflow, m_OverflowSize))
+        return ent;
+      // pinned jobs are never stolen, that would break their ordering
+      const auto num = m_Workers.size();
+      for (size_t n = 1; n < num; ++n)
+      {
+        if (auto ent = m_Workers[(idx + n) % num]->shared.tryPopFront())
+        {
+          m_Stolen.fetch_add(1, std::memory_order_relaxed);
+          return ent;
+        }
+      }
+      return std::nullopt;
+    }
+
+    std::optional<WorkerPool::Entry>
+    WorkerPool::PopOverflow(
+        std::mutex& mutex, std::deque<Entry>& overflow, std::atomic<size_t>& size)
+    {
+      if (size == 0)
+        return std::nullopt;
+      std::lock_guard lock{mutex};
+      if (overflow.empty())
+        return std::nullopt;
+      std::optional<Entry> ent{std::move(overflow.front())};
+      overflow.pop_front();
+      size--;
+      return ent;
+    }
+
+    void
+    WorkerPool::Execute(Entry ent)
+    {
+      const uint64_t wait =
+          std::chrono::duration_cast<std::chrono::microseconds>(Clock_t::now() - ent.queued)
+              .count();
+      m_TotalWaitUS.fetch_add(wait, std::memory_order_relaxed);
+      auto max = m_MaxWaitUS.load(std::memory_order_relaxed);
+      while (wait > max
+             and not m_MaxWaitUS.compare_exchange_weak(max, wait, std::memory_order_relaxed))
+      {}
+      ent.job();
+      m_Executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void
+    WorkerPool::Run(size_t idx)
+    {
+      auto& self = *m_Workers[idx];
+      while (m_Running)
+      {
+        if (auto ent = NextJob(idx))
+        {
+          Execute(std::move(*ent));
+          continue;
+        }
+        std::unique_lock lock{self.sleepMutex};
+        self.sleeping = true;
+        // re-check with the flag set so a job queued just before we slept still wakes us
+        if (m_Running and self.pinned.empty() and self.shared.empty() and self.overflowSize == 0
+            and m_OverflowSize == 0)
+          self.sleepCV.wait_for(lock, IdleWait);
+        self.sleeping = false;
+      }
+    }
+  }  // namespace thread
+}  // namespace llarp
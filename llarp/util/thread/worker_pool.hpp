@@ -0,0 +1,140 @@
+#pragma once
+
+#include "queue.hpp"
+
+#include <llarp/util/status.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// a fixed set of worker threads for cpu heavy work (mostly crypto) that has to be kept off
+    /// the logic thread.
+    ///
+    /// every worker owns two lock free queues.  jobs added with an affinity key always go to the
+    /// pinned queue of the worker that key maps to and run there in the order they were added, so
+    /// one session's or path's batches stay ordered and warm in one core's cache.  jobs added
+    /// without a key are spread round robin over the shared queues, which idle workers steal from.
+    ///
+    /// adding a job never blocks: the logic thread adds most of them and the workers report back
+    /// to it, so waiting on them could deadlock.  once the lock free queues are full jobs go to
+    /// unbounded overflow queues instead, which are only run after the full queue they spilled
+    /// from, so pinned jobs keep their order.
+    class WorkerPool
+    {
+     public:
+      using Job_t = std::function<void(void)>;
+
+      /// make a pool of `workers` threads (at least one) named `name`-N, each of whose lock free
+      /// queues hold up to `queue_size` jobs before they overflow
+      WorkerPool(size_t workers, std::string name, size_t queue_size = 1024);
+
+      WorkerPool(const WorkerPool&) = delete;
+      WorkerPool&
+      operator=(const WorkerPool&) = delete;
+
+      ~WorkerPool();
+
+      /// start the worker threads
+      void
+      Start();
+
+      /// stop accepting jobs, drop any still queued and join the worker threads
+      void
+      Stop();
+
+      /// queue a job to run on any worker; returns false if we are stopped
+      bool
+      AddJob(Job_t job);
+
+      /// queue a job to run on the worker `affinity` maps to, after every job already queued with
+      /// the same affinity; returns false if we are stopped
+      bool
+      AddJob(uint64_t affinity, Job_t job);
+
+      size_t
+      NumWorkers() const
+      {
+        return m_Workers.size();
+      }
+
+      /// jobs queued but not yet started, across all workers
+      size_t
+      QueueDepth() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      using Clock_t = std::chrono::steady_clock;
+
+      struct Entry
+      {
+        Job_t job;
+        Clock_t::time_point queued;
+      };
+
+      struct Worker
+      {
+        explicit Worker(size_t queue_size) : pinned{queue_size}, shared{queue_size}
+        {}
+
+        Queue<Entry> pinned;
+        Queue<Entry> shared;
+        /// pinned jobs added while `pinned` was full, and every one after them until it drains
+        std::mutex overflowMutex;
+        std::deque<Entry> overflow;
+        std::atomic<size_t> overflowSize{0};
+        std::mutex sleepMutex;
+        std::condition_variable sleepCV;
+        std::atomic<bool> sleeping{false};
+        std::thread thread;
+      };
+
+      void
+      Run(size_t idx);
+
+      std::optional<Entry>
+      NextJob(size_t idx);
+
+      /// pop the front of an overflow queue if it has anything
+      static std::optional<Entry>
+      PopOverflow(std::mutex& mutex, std::deque<Entry>& overflow, std::atomic<size_t>& size);
+
+      void
+      Execute(Entry ent);
+
+      /// wake the worker at idx, or if it is busy some other idle worker to steal the job
+      void
+      Wake(size_t idx);
+
+      const std::string m_Name;
+      std::vector<std::unique_ptr<Worker>> m_Workers;
+      std::atomic<bool> m_Running{false};
+      std::atomic<size_t> m_NextWorker{0};
+
+      /// unpinned jobs added while every shared queue was full, for any worker to take
+      std::mutex m_OverflowMutex;
+      std::deque<Entry> m_Overflow;
+      std::atomic<size_t> m_OverflowSize{0};
+
+      std::atomic<uint64_t> m_Executed{0};
+      std::atomic<uint64_t> m_Stolen{0};
+      /// how many jobs went to an overflow queue
+      std::atomic<uint64_t> m_Overflowed{0};
+      std::atomic<uint64_t> m_TotalWaitUS{0};
+      std::atomic<uint64_t> m_MaxWaitUS{0};
+    };
+  }  // namespace thread
+}  // namespace llarp
@@ -30,6 +30,30 @@ namespace llarp::vpn
     /// get pollable fd for reading
     virtual int
     PollFD() const = 0;
+
+    /// how many independent queues packets can be read from.  with more than one, each queue is
+    /// read through QueuePollFD and ReadQueuePacket instead of PollFD and ReadNextPacket, and the
+    /// platform keeps every flow on a single queue so packets of a flow stay in order.
+    virtual size_t
+    NumQueues() const
+    {
+      return 1;
+    }
+
+    /// get pollable fd for reading queue number idx
+    virtual int
+    QueuePollFD(size_t) const
+    {
+      return PollFD();
+    }
+
+    /// read next ip packet from queue number idx, return an empty packet if there are none ready.
+    /// may be called from a different thread for each queue.
+    virtual net::IPPacket
+    ReadQueuePacket(size_t)
+    {
+      return ReadNextPacket();
+    }
   };
 
 }  // namespace llarp::vpn
@@ -5,7 +5,9 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <fcntl.h>
+#include <sys/uio.h>
 #include "common.hpp"
+#include "offload.hpp"
 #include <net/if.h>
 #include <linux/if_tun.h>
 
@@ -34,25 +36,132 @@ namespace llarp::vpn
 
   class LinuxInterface : public NetworkInterface
   {
-    const int m_fd;
+    /// one fd per queue, the first one is also used for writing
+    std::vector<int> m_FDs;
 
-   public:
-    LinuxInterface(InterfaceInfo info)
-        : NetworkInterface{std::move(info)}, m_fd{::open("/dev/net/tun", O_RDWR)}
+    /// what we keep per queue when the kernel hands us offloaded packets
+    struct OffloadQueue
+    {
+      /// room for a whole super packet and its virtio header
+      std::vector<byte_t> buf;
+      /// the packets the last read unpacked to that we have yet to hand out
+      std::vector<net::IPPacket> pkts;
+      size_t next = 0;
+    };
+    /// one per queue if we opened the interface with IFF_VNET_HDR, otherwise empty
+    std::vector<OffloadQueue> m_Offload;
 
+    /// open a tun fd and attach it to our interface, creating the interface for the first one
+    int
+    OpenQueue(short flags)
     {
-      if (m_fd == -1)
+      const int fd = ::open("/dev/net/tun", O_RDWR);
+      if (fd == -1)
         throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+      m_FDs.push_back(fd);
 
       ifreq ifr{};
-      in6_ifreq ifr6{};
-      ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+      ifr.ifr_flags = flags;
       std::copy_n(
           m_Info.ifname.c_str(),
           std::min(m_Info.ifname.size(), sizeof(ifr.ifr_name)),
           ifr.ifr_name);
-      if (::ioctl(m_fd, TUNSETIFF, &ifr) == -1)
+      if (::ioctl(fd, TUNSETIFF, &ifr) == -1)
         throw std::runtime_error("cannot set interface name: " + std::string{strerror(errno)});
+      // queues are read from their own threads, which must never block in read
+      if (m_Info.queues > 1 and ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK) == -1)
+        throw std::runtime_error(
+            "cannot set tun queue non blocking: " + std::string{strerror(errno)});
+      return fd;
+    }
+
+    net::IPPacket
+    ReadFrom(size_t idx)
+    {
+      if (not m_Offload.empty())
+        return ReadOffloaded(idx);
+      auto pkt = net::IPPacket::AcquireBuffer();
+      pkt.resize(net::IPPacket::MaxSize);
+      const auto sz = read(m_FDs[idx], pkt.data(), pkt.size());
+      if (sz < 0)
+      {
+        const int err = errno;
+        // every drain of the fd ends here, so hand the buffer back rather than free it
+        net::IPPacket::RecycleBuffer(std::move(pkt));
+        if (err == EAGAIN or err == EWOULDBLOCK)
+        {
+          errno = 0;
+          return net::IPPacket{};
+        }
+        throw std::error_code{err, std::system_category()};
+      }
+      pkt.resize(sz);
+      return net::IPPacket{std::move(pkt)};
+    }
+
+    /// read through a queue opened with IFF_VNET_HDR, where one read can stand for many packets
+    net::IPPacket
+    ReadOffloaded(size_t idx)
+    {
+      auto& queue = m_Offload[idx];
+      while (queue.next == queue.pkts.size())
+      {
+        queue.pkts.clear();
+        queue.next = 0;
+        const auto sz = read(m_FDs[idx], queue.buf.data(), queue.buf.size());
+        if (sz < 0)
+        {
+          if (errno == EAGAIN or errno == EWOULDBLOCK)
+          {
+            errno = 0;
+            return net::IPPacket{};
+          }
+          throw std::error_code{errno, std::system_category()};
+        }
+        if (static_cast<size_t>(sz) <= sizeof(VNetHeader))
+          continue;
+        VNetHeader hdr;
+        std::memcpy(&hdr, queue.buf.data(), sizeof(hdr));
+        const byte_view_t data{queue.buf.data() + sizeof(hdr), sz - sizeof(hdr)};
+        if (not UnpackOffloaded(hdr, data, queue.pkts))
+          LogDebug(m_Info.ifname, " dropped an offloaded packet we cannot unpack");
+      }
+      return std::move(queue.pkts[queue.next++]);
+    }
+
+   public:
+    LinuxInterface(InterfaceInfo info) : NetworkInterface{std::move(info)}
+    {
+      m_Info.queues = std::max<size_t>(m_Info.queues, 1);
+      // with IFF_MULTI_QUEUE the kernel picks a queue by the flow hash of each packet (or the
+      // queue the flow was last sent from), so a flow is only ever read from one queue.
+      short tunflags = IFF_TUN | IFF_NO_PI;
+      if (m_Info.queues > 1)
+        tunflags |= IFF_MULTI_QUEUE;
+      if (m_Info.offload)
+        tunflags |= IFF_VNET_HDR;
+      for (size_t idx = 0; idx < m_Info.queues; ++idx)
+        OpenQueue(tunflags);
+
+      if (m_Info.offload)
+      {
+        // let the kernel hand us tcp in super packets of up to 64k and leave checksums to us,
+        // rather than segmenting and checksumming everything before we read it.  every packet
+        // carries a virtio header whether or not the kernel agrees to this.
+        constexpr unsigned int offloads = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6 | TUN_F_TSO_ECN;
+        if (::ioctl(m_FDs[0], TUNSETOFFLOAD, offloads) == -1)
+          LogWarn(m_Info.ifname, " cannot enable offloads: ", strerror(errno));
+        m_Offload.resize(m_FDs.size());
+        for (auto& queue : m_Offload)
+          queue.buf.resize(sizeof(VNetHeader) + MaxOffloadSize);
+      }
+
+      ifreq ifr{};
+      in6_ifreq ifr6{};
+      std::copy_n(
+          m_Info.ifname.c_str(),
+          std::min(m_Info.ifname.size(), sizeof(ifr.ifr_name)),
+          ifr.ifr_name);
       IOCTL control{AF_INET};
 
       control.ioctl(SIOCGIFFLAGS, &ifr);
@@ -94,38 +203,52 @@ namespace llarp::vpn
 
     virtual ~LinuxInterface()
     {
-      ::close(m_fd);
+      for (const auto fd : m_FDs)
+        ::close(fd);
     }
 
     int
     PollFD() const override
     {
-      return m_fd;
+      return m_FDs[0];
+    }
+
+    size_t
+    NumQueues() const override
+    {
+      return m_FDs.size();
+    }
+
+    int
+    QueuePollFD(size_t idx) const override
+    {
+      return m_FDs.at(idx);
+    }
+
+    net::IPPacket
+    ReadQueuePacket(size_t idx) override
+    {
+      return ReadFrom(idx);
     }
 
     net::IPPacket
     ReadNextPacket() override
     {
-      std::vector<byte_t> pkt;
-      pkt.resize(net::IPPacket::MaxSize);
-      const auto sz = read(m_fd, pkt.data(), pkt.capacity());
-      if (sz < 0)
-      {
-        if (errno == EAGAIN or errno == EWOULDBLOCK)
-        {
-          errno = 0;
-          return net::IPPacket{};
-        }
-        throw std::error_code{errno, std::system_category()};
-      }
-      pkt.resize(sz);
-      return pkt;
+      return ReadFrom(0);
     }
 
     bool
     WritePacket(net::IPPacket pkt) override
     {
-      const auto sz = write(m_fd, pkt.data(), pkt.size());
+      if (not m_Offload.empty())
+      {
+        // we only ever write whole, checksummed packets, so the header says nothing
+        VNetHeader hdr{};
+        iovec iov[2] = {{&hdr, sizeof(hdr)}, {pkt.data(), pkt.size()}};
+        const auto sz = ::writev(m_FDs[0], iov, 2);
+        return sz == static_cast<ssize_t>(sizeof(hdr) + pkt.size());
+      }
+      const auto sz = write(m_FDs[0], pkt.data(), pkt.size());
       if (sz <= 0)
         return false;
       return sz == static_cast<ssize_t>(pkt.size());
@@ -0,0 +1,135 @@
+#include "offload.hpp"
+
+#include <oxenc/endian.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace llarp::vpn
+{
+  namespace
+  {
+    constexpr uint16_t TCPProto = 6;
+    constexpr size_t TCPMinHeaderSize = 20;
+    constexpr size_t IPv6HeaderSize = 40;
+
+    constexpr byte_t TCPFlagFIN = 0x01;
+    constexpr byte_t TCPFlagPSH = 0x08;
+    constexpr byte_t TCPFlagCWR = 0x80;
+
+    /// sum of the 16 bit words in sz bytes at ptr, as they sit in memory
+    uint32_t
+    sum_words(const byte_t* ptr, size_t sz)
+    {
+      uint32_t sum = 0;
+      for (size_t idx = 0; idx + 1 < sz; idx += 2)
+      {
+        uint16_t word;
+        std::memcpy(&word, ptr + idx, sizeof(word));
+        sum += word;
+      }
+      return sum;
+    }
+
+    void
+    put_checksum(byte_t* ptr, uint16_t sum)
+    {
+      std::memcpy(ptr, &sum, sizeof(sum));
+    }
+
+    /// compute the tcp checksum of a segment whose tcp header starts at l4
+    void
+    tcp_checksum(std::vector<byte_t>& pkt, size_t l4, bool v6)
+    {
+      const auto len = pkt.size() - l4;
+      // pseudo header: source and destination address, protocol and tcp length
+      uint32_t sum = v6 ? sum_words(pkt.data() + 8, 32) : sum_words(pkt.data() + 12, 8);
+      sum += oxenc::host_to_big(TCPProto);
+      sum += oxenc::host_to_big(static_cast<uint16_t>(len));
+      put_checksum(pkt.data() + l4 + 16, 0);
+      put_checksum(pkt.data() + l4 + 16, net::ipchksum(pkt.data() + l4, len, sum));
+    }
+  }  // namespace
+
+  bool
+  UnpackOffloaded(const VNetHeader& hdr, byte_view_t data, std::vector<net::IPPacket>& out)
+  {
+    if (data.size() < net::IPPacket::MinSize)
+      return false;
+
+    const auto gso = hdr.gso_type & ~VNetHeader::GSOECN;
+    if (gso == VNetHeader::GSONone)
+    {
+      const size_t start = hdr.csum_start;
+      const size_t field = start + hdr.csum_offset;
+      const bool checksum = hdr.flags & VNetHeader::NeedsChecksum;
+      if (checksum and field + sizeof(uint16_t) > data.size())
+        return false;
+      auto pkt = net::IPPacket::AcquireBuffer();
+      pkt.assign(data.begin(), data.end());
+      // the kernel left the pseudo header sum in the checksum field, summing everything from
+      // csum_start on finishes it
+      if (checksum)
+        put_checksum(pkt.data() + field, net::ipchksum(pkt.data() + start, pkt.size() - start));
+      out.emplace_back(std::move(pkt));
+      return true;
+    }
+
+    const bool v6 = gso == VNetHeader::GSOTCPv6;
+    if (not v6 and gso != VNetHeader::GSOTCPv4)
+      return false;
+    if ((data[0] >> 4) != (v6 ? 6 : 4))
+      return false;
+
+    // hdr_len is only a hint, work the header lengths out from the packet itself
+    const size_t l4 = hdr.csum_start;
+    if (v6 ? l4 < IPv6HeaderSize : l4 != size_t(data[0] & 0x0f) * 4)
+      return false;
+    if (hdr.gso_size == 0 or l4 + TCPMinHeaderSize > data.size())
+      return false;
+    const size_t hlen = l4 + size_t(data[l4 + 12] >> 4) * 4;
+    if (hlen < l4 + TCPMinHeaderSize or hlen >= data.size())
+      return false;
+
+    const auto* src = data.data();
+    const auto seqno = oxenc::load_big_to_host<uint32_t>(src + l4 + 4);
+    const auto id = v6 ? uint16_t{} : oxenc::load_big_to_host<uint16_t>(src + 4);
+    const size_t payload = data.size() - hlen;
+
+    size_t seg = 0;
+    for (size_t off = 0; off < payload; off += hdr.gso_size, ++seg)
+    {
+      const auto len = std::min<size_t>(hdr.gso_size, payload - off);
+      const bool last = off + len == payload;
+
+      auto pkt = net::IPPacket::AcquireBuffer();
+      pkt.resize(hlen + len);
+      auto* ptr = pkt.data();
+      std::memcpy(ptr, src, hlen);
+      std::memcpy(ptr + hlen, src + hlen + off, len);
+
+      if (v6)
+        oxenc::write_host_as_big(static_cast<uint16_t>(pkt.size() - IPv6HeaderSize), ptr + 4);
+      else
+      {
+        oxenc::write_host_as_big(static_cast<uint16_t>(pkt.size()), ptr + 2);
+        oxenc::write_host_as_big(static_cast<uint16_t>(id + seg), ptr + 4);
+        put_checksum(ptr + 10, 0);
+        put_checksum(ptr + 10, net::ipchksum(ptr, l4));
+      }
+
+      oxenc::write_host_as_big(static_cast<uint32_t>(seqno + off), ptr + l4 + 4);
+      // as tcp_gso_segment does: congestion window reduced goes on the first segment only, and
+      // fin and push on the last
+      auto& flags = ptr[l4 + 13];
+      if (seg > 0)
+        flags &= ~TCPFlagCWR;
+      if (not last)
+        flags &= ~(TCPFlagFIN | TCPFlagPSH);
+
+      tcp_checksum(pkt, l4, v6);
+      out.emplace_back(std::move(pkt));
+    }
+    return true;
+  }
+}  // namespace llarp::vpn
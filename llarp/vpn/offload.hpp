@@ -0,0 +1,47 @@
+#pragma once
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/util/buffer.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace llarp::vpn
+{
+  /// the virtio net header a linux tun device opened with IFF_VNET_HDR puts in front of every
+  /// packet it hands us, and expects in front of every packet we write, in host byte order.
+  struct VNetHeader
+  {
+    /// csum_start and csum_offset say where the checksum we have to finish is
+    static constexpr uint8_t NeedsChecksum = 1;
+
+    static constexpr uint8_t GSONone = 0;
+    static constexpr uint8_t GSOTCPv4 = 1;
+    static constexpr uint8_t GSOUDP = 3;
+    static constexpr uint8_t GSOTCPv6 = 4;
+    /// set alongside a gso type when the tcp stream has ecn enabled
+    static constexpr uint8_t GSOECN = 0x80;
+
+    uint8_t flags;
+    uint8_t gso_type;
+    /// length of the headers to repeat in front of every segment
+    uint16_t hdr_len;
+    /// most payload bytes per segment
+    uint16_t gso_size;
+    uint16_t csum_start;
+    uint16_t csum_offset;
+  };
+
+  static_assert(sizeof(VNetHeader) == 10);
+
+  /// largest packet an offloading tun device can hand us in one read
+  constexpr size_t MaxOffloadSize = 65535;
+
+  /// turn what one read from an offloading tun device gave us into the ip packets it stands for,
+  /// appending them to out: the packet itself with its checksum finished if the kernel left that
+  /// to us, or the mtu sized segments of a tcp super packet with their headers fixed up the way
+  /// the kernel would have.  returns false, appending nothing, if the packet is malformed or
+  /// offloaded in a way we did not ask for.
+  bool
+  UnpackOffloaded(const VNetHeader& hdr, byte_view_t data, std::vector<net::IPPacket>& out);
+}  // namespace llarp::vpn
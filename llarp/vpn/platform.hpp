@@ -35,6 +35,10 @@ namespace llarp::vpn
     unsigned int index;
     huint32_t dnsaddr;
     std::vector<InterfaceAddress> addrs;
+    /// how many packet queues to open, where the platform supports more than one
+    size_t queues = 1;
+    /// have the kernel hand us tcp segmentation and checksum offloaded packets, where supported
+    bool offload = false;
 
     /// get address number N
     inline net::ipaddr_t
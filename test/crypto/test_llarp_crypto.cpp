@@ -1,4 +1,7 @@
 #include <llarp/crypto/crypto_libsodium.hpp>
+#ifdef LOKINET_AVX2_KERNELS
+#include <llarp/crypto/xchacha20_avx2.hpp>
+#endif
 
 #include <iostream>
 
@@ -48,6 +51,87 @@ TEST_CASE("PQ crypto")
   REQUIRE(otherShared == shared);
 }
 
+TEST_CASE("xchacha20 batch matches single")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  // odd sizes so jobs end mid block and blocks from different jobs share a batch
+  const std::vector<size_t> sizes{1, 63, 64, 65, 200, 1024, 1500, 7, 0, 129, 333};
+  std::vector<SharedSecret> keys(sizes.size());
+  std::vector<TunnelNonce> nonces(sizes.size());
+  std::vector<std::vector<byte_t>> batched, single;
+  std::vector<XChaCha20Job> jobs;
+  for (size_t idx = 0; idx < sizes.size(); ++idx)
+  {
+    keys[idx].Randomize();
+    nonces[idx].Randomize();
+    auto& buf = batched.emplace_back(sizes[idx]);
+    crypto.randbytes(buf.data(), buf.size());
+    single.push_back(buf);
+  }
+  for (size_t idx = 0; idx < sizes.size(); ++idx)
+  {
+    jobs.push_back(
+        XChaCha20Job{batched[idx].data(), batched[idx].size(), &keys[idx], &nonces[idx]});
+    REQUIRE(crypto.xchacha20(llarp_buffer_t{single[idx]}, keys[idx], nonces[idx]));
+  }
+  REQUIRE(crypto.xchacha20_batch(jobs));
+  REQUIRE(batched == single);
+}
+
+#ifdef LOKINET_AVX2_KERNELS
+
+TEST_CASE("xchacha20 avx2 kernel matches libsodium")
+{
+  if (not __builtin_cpu_supports("avx2"))
+    return;
+  llarp::sodium::CryptoLibSodium crypto;
+  // 8 lanes of 64 byte blocks: lengths on, either side of and well off those, and empty ones
+  const std::vector<size_t> lengths{0, 1, 7, 63, 64, 65, 511, 512, 513, 1000, 4103};
+  // job counts that leave lanes empty, fill them exactly, and cross the kernel's 64 job chunks
+  for (const size_t num : {1, 3, 8, 9, 70})
+  {
+    std::vector<SharedSecret> keys(num);
+    std::vector<TunnelNonce> nonces(num);
+    std::vector<std::vector<byte_t>> kernel, scalar;
+    std::vector<XChaCha20Job> jobs;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      keys[idx].Randomize();
+      nonces[idx].Randomize();
+      auto& buf = kernel.emplace_back(lengths[(idx * 5 + num) % lengths.size()]);
+      crypto.randbytes(buf.data(), buf.size());
+      scalar.push_back(buf);
+    }
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      jobs.push_back(
+          XChaCha20Job{kernel[idx].data(), kernel[idx].size(), &keys[idx], &nonces[idx]});
+      REQUIRE(crypto.xchacha20(llarp_buffer_t{scalar[idx]}, keys[idx], nonces[idx]));
+    }
+    avx2::xchacha20_xor_multi(jobs.data(), jobs.size());
+    REQUIRE(kernel == scalar);
+  }
+
+  // every length on its own too, and no jobs at all
+  for (const auto len : lengths)
+  {
+    SharedSecret key;
+    TunnelNonce nonce;
+    key.Randomize();
+    nonce.Randomize();
+    std::vector<byte_t> kernel(len);
+    crypto.randbytes(kernel.data(), kernel.size());
+    auto scalar = kernel;
+    const XChaCha20Job job{kernel.data(), kernel.size(), &key, &nonce};
+    avx2::xchacha20_xor_multi(&job, 1);
+    REQUIRE(crypto.xchacha20(llarp_buffer_t{scalar}, key, nonce));
+    REQUIRE(kernel == scalar);
+  }
+  avx2::xchacha20_xor_multi(nullptr, 0);
+}
+
+#endif
+
 #ifdef HAVE_CRYPT
 
 TEST_CASE("passwd hash valid")
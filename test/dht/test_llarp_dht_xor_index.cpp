@@ -0,0 +1,143 @@
+#include <catch2/catch.hpp>
+#include <llarp/dht/bucket.hpp>
+#include <llarp/dht/xor_index.hpp>
+
+#include <algorithm>
+#include <random>
+
+using namespace llarp;
+
+namespace
+{
+  struct Node
+  {
+    dht::Key_t ID;
+
+    bool
+    operator<(const Node& other) const
+    {
+      return ID < other.ID;
+    }
+
+    util::StatusObject
+    ExtractStatus() const
+    {
+      return {};
+    }
+  };
+
+  dht::Key_t
+  RandomKey(std::mt19937_64& rng)
+  {
+    dht::Key_t key;
+    for (auto& b : key)
+      b = rng();
+    return key;
+  }
+
+  /// every key sorted by xor distance to target the slow way
+  std::vector<dht::Key_t>
+  BruteForce(std::vector<dht::Key_t> keys, const dht::Key_t& target)
+  {
+    std::sort(keys.begin(), keys.end(), dht::XorMetric{target});
+    return keys;
+  }
+}  // namespace
+
+TEST_CASE("VisitClosest goes through keys closest first", "[dht]")
+{
+  std::mt19937_64 rng{GENERATE(1, 2, 3)};
+  const size_t num = GENERATE(1, 2, 3, 100, 1000);
+  std::map<dht::Key_t, int> map;
+  std::vector<dht::Key_t> keys;
+  for (size_t idx = 0; idx < num; ++idx)
+  {
+    auto key = RandomKey(rng);
+    // a few that share long prefixes with another
+    if (idx % 7 == 6)
+    {
+      key = keys.back();
+      key[31] ^= 1 << (idx % 8);
+    }
+    if (map.emplace(key, idx).second)
+      keys.push_back(key);
+  }
+
+  for (int round = 0; round < 10; ++round)
+  {
+    // a key of ours, one next to ours, and one anywhere
+    auto target = RandomKey(rng);
+    if (round == 0)
+      target = keys.front();
+    if (round == 1)
+    {
+      target = keys.back();
+      target[20] ^= 0x10;
+    }
+    std::vector<dht::Key_t> visited;
+    dht::VisitClosest(map, target, [&visited](const auto& item) {
+      visited.push_back(item.first);
+      return true;
+    });
+    REQUIRE(visited == BruteForce(keys, target));
+
+    // and stops when told to
+    size_t seen = 0;
+    dht::VisitClosest(map, target, [&seen](const auto&) { return ++seen < 3; });
+    REQUIRE(seen == std::min<size_t>(3, keys.size()));
+  }
+}
+
+TEST_CASE("VisitClosest on nothing visits nothing", "[dht]")
+{
+  const std::map<dht::Key_t, int> map;
+  bool visited = false;
+  dht::VisitClosest(map, dht::Key_t{}, [&visited](const auto&) {
+    visited = true;
+    return true;
+  });
+  REQUIRE_FALSE(visited);
+}
+
+TEST_CASE("Bucket finds the nearest keys that are not excluded", "[dht]")
+{
+  std::mt19937_64 rng{7};
+  dht::Bucket<Node> bucket{dht::Key_t{}, [&rng]() { return rng(); }};
+  std::vector<dht::Key_t> keys;
+  for (int idx = 0; idx < 500; ++idx)
+  {
+    keys.push_back(RandomKey(rng));
+    bucket.PutNode(Node{keys.back()});
+  }
+
+  const auto target = RandomKey(rng);
+  const auto sorted = BruteForce(keys, target);
+
+  dht::Key_t found;
+  REQUIRE(bucket.FindClosest(target, found));
+  REQUIRE(found == sorted[0]);
+
+  const std::set<dht::Key_t> exclude{sorted[0], sorted[2], sorted[3]};
+  REQUIRE(bucket.FindCloseExcluding(target, found, exclude));
+  REQUIRE(found == sorted[1]);
+
+  std::set<dht::Key_t> near;
+  REQUIRE(bucket.GetManyNearExcluding(target, near, 4, exclude));
+  REQUIRE(near == std::set<dht::Key_t>{sorted[1], sorted[4], sorted[5], sorted[6]});
+
+  // asking for more than there are fills in what there is
+  near.clear();
+  REQUIRE_FALSE(bucket.GetManyNearExcluding(target, near, keys.size(), exclude));
+  REQUIRE(near.size() == keys.size() - exclude.size());
+
+  // everything excluded
+  const std::set<dht::Key_t> all{keys.begin(), keys.end()};
+  REQUIRE_FALSE(bucket.FindCloseExcluding(target, found, all));
+  REQUIRE_FALSE(bucket.GetRandomNodeExcluding(found, all));
+
+  // all but one excluded
+  std::set<dht::Key_t> allButOne{all};
+  allButOne.erase(sorted[42]);
+  REQUIRE(bucket.GetRandomNodeExcluding(found, allButOne));
+  REQUIRE(found == sorted[42]);
+}
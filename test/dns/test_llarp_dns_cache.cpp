@@ -0,0 +1,226 @@
+#include <catch2/catch.hpp>
+#include <llarp/dns/cache.hpp>
+
+#include <vector>
+
+using llarp::byte_view_t;
+using llarp::dns::AnswerCache;
+using llarp::dns::MessageView;
+using namespace std::literals;
+
+namespace
+{
+  using Wire = std::vector<byte_t>;
+
+  /// header with id, flags and counts, then the question for name in (its labels given
+  /// separately) with type A
+  Wire
+  MakeMessage(
+      uint16_t id, uint16_t flags, uint16_t an, uint16_t ns, std::vector<std::string> labels)
+  {
+    Wire wire{
+        byte_t(id >> 8),
+        byte_t(id),
+        byte_t(flags >> 8),
+        byte_t(flags),
+        0,
+        1,
+        byte_t(an >> 8),
+        byte_t(an),
+        byte_t(ns >> 8),
+        byte_t(ns),
+        0,
+        0};
+    for (const auto& label : labels)
+    {
+      wire.push_back(label.size());
+      wire.insert(wire.end(), label.begin(), label.end());
+    }
+    wire.insert(wire.end(), {0, 0, 1, 0, 1});
+    return wire;
+  }
+
+  /// append a record pointing back at the question's name
+  void
+  AddRecord(Wire& wire, uint16_t type, uint32_t ttl, Wire rdata)
+  {
+    wire.insert(
+        wire.end(),
+        {0xc0,
+         12,
+         byte_t(type >> 8),
+         byte_t(type),
+         0,
+         1,
+         byte_t(ttl >> 24),
+         byte_t(ttl >> 16),
+         byte_t(ttl >> 8),
+         byte_t(ttl),
+         byte_t(rdata.size() >> 8),
+         byte_t(rdata.size())});
+    wire.insert(wire.end(), rdata.begin(), rdata.end());
+  }
+
+  /// append an edns record saying we take payload byte replies, with the DO bit if dnssec
+  void
+  AddOPT(Wire& wire, uint16_t payload, bool dnssec)
+  {
+    wire.insert(
+        wire.end(),
+        {0,
+         0,
+         41,
+         byte_t(payload >> 8),
+         byte_t(payload),
+         0,
+         0,
+         byte_t(dnssec ? 0x80 : 0),
+         0,
+         0,
+         0});
+    ++wire[11];
+  }
+
+  uint32_t
+  TTLAt(const llarp::OwnedBuffer& buf, size_t off)
+  {
+    const auto* ptr = buf.buf.get() + off;
+    return (uint32_t{ptr[0]} << 24) | (uint32_t{ptr[1]} << 16) | (uint32_t{ptr[2]} << 8) | ptr[3];
+  }
+
+  byte_view_t
+  View(const Wire& wire)
+  {
+    return {wire.data(), wire.size()};
+  }
+
+  MessageView
+  Parse(const Wire& wire)
+  {
+    auto view = MessageView::Parse(View(wire));
+    REQUIRE(view);
+    return *view;
+  }
+}  // namespace
+
+TEST_CASE("AnswerCache answers repeat queries until the ttl runs out", "[dns]")
+{
+  AnswerCache cache{16};
+  const auto query = MakeMessage(0x1234, 0x0100, 0, 0, {"example", "com"});
+  const auto key = AnswerCache::QuestionKey(Parse(query));
+  REQUIRE(key);
+  REQUIRE_FALSE(cache.Lookup(*key, Parse(query), 0s));
+
+  auto reply = MakeMessage(0x1234, 0x8180, 1, 0, {"example", "com"});
+  const auto ttl_offset = reply.size() + 6;
+  AddRecord(reply, 1, 60, {10, 0, 0, 1});
+  cache.Put(*key, View(reply), 100s);
+  REQUIRE(cache.Size() == 1);
+
+  // the same question cased differently, asked later under another id
+  const auto again = MakeMessage(0xbeef, 0x0100, 0, 0, {"EXAMPLE", "com"});
+  const auto again_key = AnswerCache::QuestionKey(Parse(again));
+  REQUIRE(again_key == key);
+  const auto hit = cache.Lookup(*again_key, Parse(again), 130s);
+  REQUIRE(hit);
+  REQUIRE(hit->sz == reply.size());
+  REQUIRE(hit->buf[0] == 0xbe);
+  REQUIRE(hit->buf[1] == 0xef);
+  REQUIRE(hit->buf[13] == 'E');
+  REQUIRE(TTLAt(*hit, ttl_offset) == 30);
+
+  REQUIRE_FALSE(cache.Lookup(*key, Parse(query), 160s));
+  REQUIRE(cache.Size() == 0);
+}
+
+TEST_CASE("AnswerCache negative replies", "[dns]")
+{
+  AnswerCache cache{16};
+  const auto query = MakeMessage(1, 0x0100, 0, 0, {"nothing", "here"});
+  const auto key = AnswerCache::QuestionKey(Parse(query));
+  REQUIRE(key);
+
+  // nxdomain with an soa whose minimum is lower than its ttl
+  auto reply = MakeMessage(1, 0x8183, 0, 1, {"nothing", "here"});
+  Wire soa{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 20};
+  AddRecord(reply, 6, 3600, soa);
+  cache.Put(*key, View(reply), 0s);
+  REQUIRE(cache.Lookup(*key, Parse(query), 19s));
+  REQUIRE_FALSE(cache.Lookup(*key, Parse(query), 20s));
+
+  // without one we keep it only briefly
+  const auto bare = MakeMessage(1, 0x8183, 0, 0, {"nothing", "here"});
+  cache.Put(*key, View(bare), 100s);
+  REQUIRE(cache.Lookup(*key, Parse(query), 100s + AnswerCache::NegativeTTL - 1ms));
+  REQUIRE_FALSE(cache.Lookup(*key, Parse(query), 100s + AnswerCache::NegativeTTL));
+
+  // and server failures not at all
+  const auto fail = MakeMessage(1, 0x8182, 0, 0, {"nothing", "here"});
+  cache.Put(*key, View(fail), 200s);
+  REQUIRE(cache.Size() == 0);
+}
+
+TEST_CASE("AnswerCache keeps replies to edns queries apart", "[dns]")
+{
+  AnswerCache cache{16};
+  const auto plain = MakeMessage(1, 0x0100, 0, 0, {"example", "com"});
+  auto edns = plain;
+  AddOPT(edns, 1232, false);
+  auto dnssec = plain;
+  AddOPT(dnssec, 1232, true);
+  auto bigger = plain;
+  AddOPT(bigger, 4096, true);
+
+  const auto plain_key = AnswerCache::QuestionKey(Parse(plain));
+  const auto edns_key = AnswerCache::QuestionKey(Parse(edns));
+  const auto dnssec_key = AnswerCache::QuestionKey(Parse(dnssec));
+  const auto bigger_key = AnswerCache::QuestionKey(Parse(bigger));
+  REQUIRE(plain_key);
+  REQUIRE(edns_key);
+  REQUIRE(dnssec_key);
+  REQUIRE(bigger_key);
+  REQUIRE(*plain_key != *edns_key);
+  REQUIRE(*edns_key != *dnssec_key);
+  REQUIRE(*dnssec_key != *bigger_key);
+
+  // a reply to a DO query, with its own opt record, is only for DO queries like it
+  auto reply = MakeMessage(1, 0x8180, 1, 0, {"example", "com"});
+  AddRecord(reply, 1, 60, {10, 0, 0, 1});
+  AddOPT(reply, 1232, true);
+  cache.Put(*dnssec_key, View(reply), 0s);
+  REQUIRE(cache.Size() == 1);
+  REQUIRE(cache.Lookup(*dnssec_key, Parse(dnssec), 1s));
+  REQUIRE_FALSE(cache.Lookup(*plain_key, Parse(plain), 1s));
+  REQUIRE_FALSE(cache.Lookup(*edns_key, Parse(edns), 1s));
+  REQUIRE_FALSE(cache.Lookup(*bigger_key, Parse(bigger), 1s));
+
+  // anything else in the additional section and we do not cache it at all
+  auto signed_query = plain;
+  AddRecord(signed_query, 250, 0, {});
+  ++signed_query[11];
+  REQUIRE_FALSE(AnswerCache::QuestionKey(Parse(signed_query)));
+}
+
+TEST_CASE("AnswerCache evicts the least recently used", "[dns]")
+{
+  AnswerCache cache{2};
+  std::vector<std::string> keys;
+  for (const auto* name : {"a", "b", "c"})
+  {
+    const auto query = MakeMessage(1, 0x0100, 0, 0, {name});
+    keys.push_back(*AnswerCache::QuestionKey(Parse(query)));
+    auto reply = MakeMessage(1, 0x8180, 1, 0, {name});
+    AddRecord(reply, 1, 60, {10, 0, 0, 1});
+    cache.Put(keys.back(), View(reply), 0s);
+    // use a again, leaving b the one unused the longest
+    if (keys.size() == 2)
+      REQUIRE(cache.Lookup(keys[0], Parse(MakeMessage(1, 0x0100, 0, 0, {"a"})), 1s));
+  }
+  REQUIRE(cache.Size() == 2);
+  REQUIRE(cache.Lookup(keys[0], Parse(MakeMessage(1, 0x0100, 0, 0, {"a"})), 1s));
+  REQUIRE_FALSE(cache.Lookup(keys[1], Parse(MakeMessage(1, 0x0100, 0, 0, {"b"})), 1s));
+  REQUIRE(cache.Lookup(keys[2], Parse(MakeMessage(1, 0x0100, 0, 0, {"c"})), 1s));
+
+  // replies are not queries
+  REQUIRE_FALSE(AnswerCache::QuestionKey(Parse(MakeMessage(1, 0x8180, 0, 0, {"a"}))));
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch.hpp>
+#include <llarp/dns/coalesce.hpp>
+#include <llarp/dns/dns.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+TEST_CASE("Coalescer has queries asking the same wait on one lookup", "[dns]")
+{
+  dns::Coalescer<int> lookups{10s};
+
+  auto first = lookups.Join("a", 1, 0s);
+  REQUIRE(first);
+  REQUIRE_FALSE(lookups.Join("a", 2, 1s));
+  REQUIRE_FALSE(lookups.Join("a", 3, 2s));
+  auto other = lookups.Join("b", 4, 2s);
+  REQUIRE(other);
+
+  REQUIRE(lookups.Finish(first) == std::vector<int>{1, 2, 3});
+  // answered once only
+  REQUIRE(lookups.Finish(first).empty());
+  // and the next to ask starts over
+  auto again = lookups.Join("a", 5, 3s);
+  REQUIRE(again);
+  REQUIRE(lookups.Finish(again) == std::vector<int>{5});
+  REQUIRE(lookups.Finish(other) == std::vector<int>{4});
+
+  const auto status = lookups.ExtractStatus();
+  REQUIRE(status["inFlight"] == 0);
+  REQUIRE(status["lookups"] == 3);
+  REQUIRE(status["coalesced"] == 2);
+}
+
+TEST_CASE("Coalescer gives up on a lookup that takes too long", "[dns]")
+{
+  dns::Coalescer<int> lookups{10s};
+
+  auto lost = lookups.Join("a", 1, 0s);
+  REQUIRE(lost);
+  REQUIRE_FALSE(lookups.Join("a", 2, 9s));
+  auto fresh = lookups.Join("a", 3, 10s);
+  REQUIRE(fresh);
+  REQUIRE_FALSE(lookups.Join("a", 4, 11s));
+
+  // the lost one finishing late still answers who waited on it, and leaves the new one be
+  REQUIRE(lookups.Finish(lost) == std::vector<int>{1, 2});
+  REQUIRE_FALSE(lookups.Join("a", 5, 12s));
+  REQUIRE(lookups.Finish(fresh) == std::vector<int>{3, 4, 5});
+
+  // a shorter timeout counts for the lookups already in flight too
+  auto slow = lookups.Join("a", 6, 20s);
+  REQUIRE(slow);
+  lookups.SetTimeout(5s);
+  REQUIRE(lookups.Timeout() == 5s);
+  REQUIRE(lookups.Join("a", 7, 25s));
+}
+
+TEST_CASE("CoalesceKey", "[dns]")
+{
+  dns::Message query{dns::Question{"foo.loki.", dns::qTypeA}};
+  const auto key = dns::CoalesceKey(query);
+  REQUIRE(key);
+
+  // another type, or the name cased differently, is a different question
+  REQUIRE(key != dns::CoalesceKey(dns::Message{dns::Question{"foo.loki.", dns::qTypeAAAA}}));
+  REQUIRE(key != dns::CoalesceKey(dns::Message{dns::Question{"FOO.loki.", dns::qTypeA}}));
+  REQUIRE(key == dns::CoalesceKey(dns::Message{dns::Question{"foo.loki.", dns::qTypeA}}));
+
+  // nor is the same question with another edns record, or none
+  dns::Message edns{dns::Question{"foo.loki.", dns::qTypeA}};
+  edns.edns = dns::Message::EDNS{1232, 0};
+  auto dnssec = edns;
+  dnssec.edns->flags = 0x8000;
+  REQUIRE(key != dns::CoalesceKey(edns));
+  REQUIRE(dns::CoalesceKey(edns) != dns::CoalesceKey(dnssec));
+  REQUIRE(dns::CoalesceKey(dnssec) == dns::CoalesceKey(dnssec));
+
+  // an upstream reply we hooked for its cname is not something we look up
+  query.AddCNAMEReply("bar.loki.");
+  REQUIRE_FALSE(dns::CoalesceKey(query));
+}
@@ -0,0 +1,140 @@
+#include <catch2/catch.hpp>
+#include <llarp/dns/dns.hpp>
+#include <llarp/dns/message_view.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace llarp::dns;
+using llarp::byte_view_t;
+
+namespace
+{
+  using Wire = std::vector<byte_t>;
+
+  /// a query for name with type A
+  Wire
+  MakeQuery(uint16_t id, std::vector<std::string> labels)
+  {
+    Wire wire{byte_t(id >> 8), byte_t(id), 0x01, 0x00, 0, 1, 0, 0, 0, 0, 0, 0};
+    for (const auto& label : labels)
+    {
+      wire.push_back(label.size());
+      wire.insert(wire.end(), label.begin(), label.end());
+    }
+    wire.insert(wire.end(), {0, 0, 1, 0, 1});
+    return wire;
+  }
+
+  byte_view_t
+  View(const Wire& wire)
+  {
+    return {wire.data(), wire.size()};
+  }
+
+  byte_view_t
+  View(const llarp::OwnedBuffer& buf)
+  {
+    return {buf.buf.get(), buf.sz};
+  }
+}  // namespace
+
+TEST_CASE("MessageView reads a query in place", "[dns]")
+{
+  const auto wire = MakeQuery(0x4242, {"Foo", "loki"});
+  const auto view = MessageView::Parse(View(wire));
+  REQUIRE(view);
+  REQUIRE(view->ID() == 0x4242);
+  REQUIRE(view->IsQuery());
+  REQUIRE(view->QuestionCount() == 1);
+
+  const auto q = view->FirstQuestion();
+  REQUIRE(q);
+  REQUIRE(q->qtype == qTypeA);
+  REQUIRE(q->qclass == qClassIN);
+  REQUIRE(q->name.ToString() == "Foo.loki.");
+  REQUIRE(q->name.Length() == 8);
+  REQUIRE(q->name.Equals("foo.loki"));
+  REQUIRE(q->name.Equals("FOO.LOKI."));
+  REQUIRE(q->name.EndsWith(".loki"));
+  REQUIRE(q->name.EndsWith("o.loki"));
+  REQUIRE_FALSE(q->name.EndsWith(".snode"));
+  REQUIRE_FALSE(q->name.Equals("foo.lok"));
+  REQUIRE(view->FirstQuestionBytes().size() == wire.size() - MessageView::HeaderSize);
+}
+
+TEST_CASE("MessageView rejects what runs past the end or loops", "[dns]")
+{
+  auto wire = MakeQuery(1, {"foo", "loki"});
+  for (size_t sz = 0; sz < wire.size(); ++sz)
+    REQUIRE_FALSE(MessageView::Parse(View(wire).substr(0, sz)));
+
+  // a record whose name points at itself
+  wire[7] = 1;
+  wire.insert(wire.end(), {0xc0, byte_t(wire.size()), 0, 1, 0, 1, 0, 0, 0, 0, 0, 0});
+  REQUIRE_FALSE(MessageView::Parse(View(wire)));
+
+  // or forwards
+  wire[wire.size() - 11] += 2;
+  REQUIRE_FALSE(MessageView::Parse(View(wire)));
+
+  // or into the header
+  wire[wire.size() - 11] = 5;
+  REQUIRE_FALSE(MessageView::Parse(View(wire)));
+
+  // but pointing back at the question is fine
+  wire[wire.size() - 11] = MessageView::HeaderSize;
+  REQUIRE(MessageView::Parse(View(wire)));
+
+  // the question itself has nothing before it to point at
+  const Wire compressed{0x12, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0xc0, 5, 0, 1, 0, 1};
+  REQUIRE_FALSE(MessageView::Parse(View(compressed)));
+}
+
+TEST_CASE("ReplyBuilder compresses names against the question", "[dns]")
+{
+  const auto wire = MakeQuery(0x1234, {"www", "example", "loki"});
+  const auto query = MessageView::Parse(View(wire));
+  REQUIRE(query);
+
+  ReplyBuilder builder{*query};
+  const Wire addr{10, 0, 0, 1};
+  REQUIRE(builder.AddRecord(qTypeA, 60, View(addr)));
+  REQUIRE(builder.AddNameRecord(qTypeCNAME, 60, "Mail.Example.loki."));
+  REQUIRE(builder.AddNameRecord(qTypeNS, 60, "ns.other."));
+  REQUIRE_FALSE(builder.AddNameRecord(qTypeNS, 60, "bad..name"));
+  const auto buf = builder.Finish();
+
+  const auto reply = MessageView::Parse(View(buf));
+  REQUIRE(reply);
+  REQUIRE(reply->ID() == 0x1234);
+  REQUIRE_FALSE(reply->IsQuery());
+  REQUIRE(reply->RCode() == flags_RCODENoError);
+  REQUIRE(reply->AnswerCount() == 3);
+  REQUIRE(reply->FirstQuestion()->name.Equals("www.example.loki"));
+
+  std::vector<RecordView> records;
+  reply->ForEachRecord([&records](const RecordView& rec) { records.push_back(rec); });
+  REQUIRE(records.size() == 3);
+  for (const auto& rec : records)
+  {
+    REQUIRE(rec.section == RecordView::Section::Answer);
+    REQUIRE(rec.name.Equals("www.example.loki"));
+    REQUIRE(rec.ttl == 60);
+  }
+  REQUIRE(records[0].rdata == View(addr));
+  // one label then a pointer to example.loki. in the question
+  REQUIRE(records[1].rdata.size() == 1 + 4 + 2);
+  const NameView cname{reply->Data(), size_t(records[1].rdata.data() - reply->Data().data())};
+  REQUIRE(cname.ToString() == "Mail.example.loki.");
+  REQUIRE(records[2].rdata.size() == 1 + 2 + 1 + 5 + 1);
+
+  ReplyBuilder nx{*query};
+  nx.SetRCode(flags_RCODENameError);
+  const auto nxbuf = nx.Finish();
+  const auto nxreply = MessageView::Parse(View(nxbuf));
+  REQUIRE(nxreply);
+  REQUIRE(nxreply->RCode() == flags_RCODENameError);
+  REQUIRE(nxreply->AnswerCount() == 0);
+  REQUIRE(nxbuf.sz == wire.size());
+}
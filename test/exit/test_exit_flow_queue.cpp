@@ -0,0 +1,166 @@
+#include <catch2/catch.hpp>
+#include <llarp/exit/flow_queue.hpp>
+#include <llarp/net/ip.hpp>
+
+#include <map>
+#include <vector>
+
+using namespace llarp;
+using exit::FlowQueue;
+using namespace std::literals;
+
+namespace
+{
+  /// a udp packet of size bytes from 1.1.1.1:sport to 10.0.0.host:dport
+  net::IPPacket
+  MakeUDP(uint8_t host, uint16_t sport, uint16_t dport, size_t size = 1000, uint16_t frag = 0)
+  {
+    std::vector<byte_t> buf(size);
+    buf[0] = 0x45;
+    buf[2] = size >> 8;
+    buf[3] = size;
+    buf[6] = frag >> 8;
+    buf[7] = frag;
+    buf[8] = 64;
+    buf[9] = 17;
+    buf[12] = buf[13] = buf[14] = buf[15] = 1;
+    buf[16] = 10;
+    buf[19] = host;
+    buf[20] = sport >> 8;
+    buf[21] = sport;
+    buf[22] = dport >> 8;
+    buf[23] = dport;
+    return net::IPPacket{std::move(buf)};
+  }
+
+  /// drain budget bytes, returning which host and source port each packet sent was for
+  std::vector<std::pair<uint8_t, uint16_t>>
+  Drain(FlowQueue& queue, size_t budget = FlowQueue::DrainBudget)
+  {
+    std::vector<std::pair<uint8_t, uint16_t>> sent;
+    queue.Drain(budget, [&sent](FlowQueue::Session&, net::IPPacket pkt) {
+      const auto key = exit::FlowKey::FromPacket(pkt);
+      REQUIRE(key);
+      sent.emplace_back(pkt.data()[19], key->srcPort);
+    });
+    return sent;
+  }
+}  // namespace
+
+TEST_CASE("FlowKey", "[exit]")
+{
+  const auto key = exit::FlowKey::FromPacket(MakeUDP(2, 1234, 53));
+  REQUIRE(key);
+  REQUIRE(key->proto == 17);
+  REQUIRE(key->srcPort == 1234);
+  REQUIRE(key->dstPort == 53);
+  REQUIRE(key->dst == net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 2)));
+
+  // fragments all go in one flow without ports
+  const auto frag = exit::FlowKey::FromPacket(MakeUDP(2, 1234, 53, 1000, 0x2000));
+  REQUIRE(frag);
+  REQUIRE(frag->srcPort == 0);
+  REQUIRE(frag->dstPort == 0);
+
+  REQUIRE_FALSE(exit::FlowKey::FromPacket(net::IPPacket{std::vector<byte_t>(10)}));
+}
+
+TEST_CASE("FlowQueue shares what it sends across sessions", "[exit]")
+{
+  FlowQueue queue;
+  // a bulk download to one client on three flows, then a little to another
+  for (int idx = 0; idx < 50; ++idx)
+  {
+    REQUIRE(queue.Push(MakeUDP(2, 1000, 80), 0s));
+    REQUIRE(queue.Push(MakeUDP(2, 1001, 80), 0s));
+    REQUIRE(queue.Push(MakeUDP(2, 1002, 80), 0s));
+  }
+  for (int idx = 0; idx < 5; ++idx)
+    REQUIRE(queue.Push(MakeUDP(3, 1000, 80), 0s));
+  REQUIRE(queue.Queued() == 155);
+
+  // the other client gets about every other packet until it has nothing left, however many flows
+  // the first has
+  const auto sent = Drain(queue);
+  REQUIRE(sent.size() == 155);
+  REQUIRE(queue.Queued() == 0);
+  size_t last = 0;
+  for (size_t idx = 0; idx < sent.size(); ++idx)
+  {
+    if (sent[idx].first == 3)
+      last = idx;
+  }
+  REQUIRE(last <= 11);
+}
+
+TEST_CASE("FlowQueue shares what a session sends across its flows", "[exit]")
+{
+  FlowQueue queue;
+  for (int idx = 0; idx < 20; ++idx)
+    REQUIRE(queue.Push(MakeUDP(2, 1000, 80), 0s));
+  for (int idx = 0; idx < 20; ++idx)
+  {
+    REQUIRE(queue.Push(MakeUDP(2, 1001, 80, 500), 0s));
+    REQUIRE(queue.Push(MakeUDP(2, 1002, 80), 0s));
+  }
+
+  // in bytes, so the flow with packets half the size sends about twice as many
+  std::map<uint16_t, size_t> bytes;
+  for (const auto& [host, port] : Drain(queue, 15 * 1000))
+    bytes[port] += port == 1001 ? 500 : 1000;
+  for (const auto& [port, sent] : bytes)
+  {
+    REQUIRE(sent >= 4000);
+    REQUIRE(sent <= 6000);
+  }
+}
+
+TEST_CASE("FlowQueue drops from the flow holding the most", "[exit]")
+{
+  FlowQueue queue;
+  for (int idx = 0; idx < 10; ++idx)
+    REQUIRE(queue.Push(MakeUDP(3, 1000, 80, 100), 0s));
+  for (size_t idx = 0; idx < FlowQueue::MaxQueuedPackets; ++idx)
+    REQUIRE(queue.Push(MakeUDP(2, 1000, 80), 0s));
+  REQUIRE(queue.Queued() <= FlowQueue::MaxQueuedPackets);
+
+  const auto status = queue.ExtractStatus();
+  const auto& sessions = status["sessions"];
+  REQUIRE(sessions[net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 3)).ToString()]["dropped"] == 0);
+  REQUIRE(sessions[net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 2)).ToString()]["dropped"] > 0);
+
+  size_t other = 0;
+  for (const auto& [host, port] : Drain(queue))
+    other += host == 3;
+  REQUIRE(other == 10);
+}
+
+TEST_CASE("FlowQueue sessions keep their endpoint until uncached", "[exit]")
+{
+  FlowQueue queue;
+  auto* ep = reinterpret_cast<exit::Endpoint*>(0x1000);
+  REQUIRE(queue.Push(MakeUDP(2, 1000, 80), 0s));
+  queue.Drain(FlowQueue::DrainBudget, [ep](FlowQueue::Session& session, net::IPPacket) {
+    REQUIRE(session.endpoint == nullptr);
+    session.endpoint = ep;
+  });
+
+  const auto ip = net::ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 2));
+  queue.Uncache(ip, reinterpret_cast<exit::Endpoint*>(0x2000));
+  REQUIRE(queue.Push(MakeUDP(2, 1001, 80), 1s));
+  queue.Drain(FlowQueue::DrainBudget, [ep](FlowQueue::Session& session, net::IPPacket) {
+    REQUIRE(session.endpoint == ep);
+  });
+
+  queue.Uncache(ip, ep);
+  REQUIRE(queue.Push(MakeUDP(2, 1001, 80), 2s));
+  queue.Drain(FlowQueue::DrainBudget, [](FlowQueue::Session& session, net::IPPacket) {
+    REQUIRE(session.endpoint == nullptr);
+  });
+
+  // idle flows go, and the session with them
+  queue.Expire(2s + FlowQueue::IdleTimeout - 1ms);
+  REQUIRE(queue.ExtractStatus()["sessions"].size() == 1);
+  queue.Expire(2s + FlowQueue::IdleTimeout);
+  REQUIRE(queue.ExtractStatus()["sessions"].empty());
+}
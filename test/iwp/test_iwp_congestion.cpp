@@ -0,0 +1,127 @@
+#include <llarp/iwp/congestion.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp::iwp;
+using namespace std::literals;
+
+TEST_CASE("CongestionControl slow start and loss", "[iwp]")
+{
+  CongestionControl cc;
+  auto now = 1000ms;
+  const auto initial = cc.Window();
+  REQUIRE(cc.InSlowStart());
+
+  cc.OnSent(10, now);
+  REQUIRE(cc.InFlight() == 10);
+  cc.OnRTTSample(50ms);
+  cc.OnAcked(10, now);
+  REQUIRE(cc.InFlight() == 0);
+  REQUIRE(cc.Window() == initial + 10);
+
+  // one loss shrinks the window once, however many packets of that round trip it hits
+  const auto before = cc.Window();
+  cc.OnLoss(now);
+  REQUIRE(cc.Window() == Approx(before * CongestionControl::Beta));
+  cc.OnLoss(now + 10ms);
+  REQUIRE(cc.Window() == Approx(before * CongestionControl::Beta));
+  REQUIRE_FALSE(cc.InSlowStart());
+
+  // and the next round trip can shrink it again, but never below the minimum
+  for (int i = 0; i < 100; ++i)
+  {
+    now += 100ms;
+    cc.OnLoss(now);
+  }
+  REQUIRE(cc.Window() == CongestionControl::MinWindow);
+}
+
+TEST_CASE("CongestionControl cubic growth returns to the last peak", "[iwp]")
+{
+  CongestionControl cc;
+  auto now = 1000ms;
+  cc.OnRTTSample(20ms);
+  cc.OnSent(100, now);
+  cc.OnAcked(100, now);
+  const auto peak = cc.Window();
+  cc.OnLoss(now);
+  const auto reduced = cc.Window();
+  REQUIRE(reduced < peak);
+
+  // ack a window's worth every round trip for a few seconds
+  for (int i = 0; i < 300; ++i)
+  {
+    now += 20ms;
+    const auto packets = static_cast<size_t>(cc.Window());
+    cc.OnSent(packets, now);
+    cc.OnAcked(packets, now);
+  }
+  REQUIRE(cc.Window() > peak);
+}
+
+TEST_CASE("CongestionControl window limits what is in flight", "[iwp]")
+{
+  CongestionControl cc;
+  const auto now = 1000ms;
+  // a message bigger than the window still goes out when nothing else is in flight
+  REQUIRE(cc.CanSend(CongestionControl::MaxWindow, now));
+
+  const auto window = static_cast<size_t>(cc.Window());
+  cc.OnSent(window, now);
+  REQUIRE_FALSE(cc.CanSend(1, now));
+  cc.OnAcked(1, now);
+  REQUIRE(cc.CanSend(1, now));
+}
+
+TEST_CASE("CongestionControl rtt estimate and rto", "[iwp]")
+{
+  CongestionControl cc;
+  REQUIRE(cc.RTO() == CongestionControl::MaxRTO);
+
+  cc.OnRTTSample(40ms);
+  // srtt + 4 * rttvar = 40 + 4 * 20
+  REQUIRE(cc.RTO() == 120ms);
+
+  // a steady rtt converges on it, bounded below by the minimum rto
+  for (int i = 0; i < 50; ++i)
+    cc.OnRTTSample(40ms);
+  REQUIRE(cc.RTO() == CongestionControl::MinRTO);
+
+  // timeouts back off until the next sample
+  cc.OnTimeout(1000ms);
+  REQUIRE(cc.RTO() == CongestionControl::MinRTO * 2);
+  cc.OnRTTSample(40ms);
+  REQUIRE(cc.RTO() == CongestionControl::MinRTO);
+
+  // and never go past the maximum
+  for (int i = 0; i < 10; ++i)
+    cc.OnTimeout(2000ms + (i * 1s));
+  REQUIRE(cc.RTO() == CongestionControl::MaxRTO);
+}
+
+TEST_CASE("CongestionControl paces sends over the round trip", "[iwp]")
+{
+  CongestionControl cc;
+  auto now = 1000ms;
+
+  // with no rtt estimate yet there is nothing to pace by
+  REQUIRE(cc.PacingDelay(8, now) == 0s);
+
+  cc.OnRTTSample(100ms);
+  size_t sent = 0;
+  while (cc.CanSend(1, now))
+  {
+    cc.OnSent(1, now);
+    sent++;
+  }
+  // only a burst goes out at once, well short of the whole window
+  REQUIRE(sent > 0);
+  REQUIRE(sent < cc.Window());
+
+  const auto delay = cc.PacingDelay(1, now);
+  REQUIRE(delay > 0s);
+  REQUIRE(delay < 100ms);
+  REQUIRE_FALSE(cc.CanSend(1, now));
+  now += delay;
+  REQUIRE(cc.CanSend(1, now));
+}
@@ -0,0 +1,109 @@
+#include <llarp/iwp/message_window.hpp>
+
+#include <map>
+#include <random>
+#include <catch2/catch.hpp>
+
+using namespace llarp::iwp;
+
+namespace
+{
+  struct Msg
+  {
+    uint64_t m_MsgID;
+    uint64_t value;
+  };
+}  // namespace
+
+TEST_CASE("MessageWindow matches a map", "[iwp]")
+{
+  MessageWindow<Msg, 1024, 4> window;
+  std::map<uint64_t, uint64_t> expected;
+  std::mt19937_64 rng{42};
+  uint64_t next = 0;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    if (rng() % 2 == 0)
+    {
+      if (window.insert(Msg{next, next * 3}))
+        expected.emplace(next, next * 3);
+      else
+        REQUIRE(window.capacity() == 1024);
+      ++next;
+    }
+    else if (not expected.empty())
+    {
+      auto itr = std::next(expected.begin(), rng() % expected.size());
+      window.erase(itr->first);
+      expected.erase(itr);
+    }
+    REQUIRE(window.size() == expected.size());
+  }
+  for (uint64_t id = 0; id < next; ++id)
+  {
+    const auto* msg = window.find(id);
+    const auto itr = expected.find(id);
+    REQUIRE((msg != nullptr) == (itr != expected.end()));
+    if (msg)
+      REQUIRE(msg->value == itr->second);
+  }
+
+  window.erase_if([](const auto& msg) { return msg.m_MsgID % 2; });
+  for (const auto& msg : window)
+    REQUIRE(msg.m_MsgID % 2 == 0);
+}
+
+TEST_CASE("MessageWindow is full when a slot is taken at max capacity", "[iwp]")
+{
+  MessageWindow<Msg, 8, 8> window;
+  REQUIRE(window.insert(Msg{1, 0}));
+  REQUIRE(window.insert(Msg{2, 0}));
+  REQUIRE_FALSE(window.insert(Msg{9, 0}));
+  window.erase(1);
+  REQUIRE(window.insert(Msg{9, 0}));
+  REQUIRE(window.find(9));
+  REQUIRE_FALSE(window.find(1));
+}
+
+TEST_CASE("MessageWindow hands back what it takes", "[iwp]")
+{
+  MessageWindow<Msg, 8, 4> window;
+  REQUIRE(window.insert(Msg{1, 10}));
+  REQUIRE(window.insert(Msg{2, 20}));
+  REQUIRE(window.insert(Msg{3, 30}));
+  const auto taken = window.take(1);
+  REQUIRE(taken);
+  REQUIRE(taken->value == 10);
+  REQUIRE_FALSE(window.find(1));
+  REQUIRE_FALSE(window.take(1));
+  // what we took is ours, whatever happens to the window after
+  for (uint64_t id = 4; id < 8; ++id)
+    REQUIRE(window.insert(Msg{id, id * 10}));
+  REQUIRE(taken->value == 10);
+  REQUIRE(window.find(3)->value == 30);
+  REQUIRE(window.size() == 6);
+}
+
+TEST_CASE("ReplayWindow", "[iwp]")
+{
+  ReplayWindow<64> replay;
+  REQUIRE_FALSE(replay.Contains(5));
+  REQUIRE(replay.Insert(5));
+  REQUIRE(replay.Contains(5));
+  REQUIRE_FALSE(replay.Insert(5));
+
+  // out of order but inside the window
+  REQUIRE_FALSE(replay.Contains(3));
+  REQUIRE(replay.Insert(3));
+  REQUIRE(replay.Contains(3));
+
+  // sliding forward forgets the ids we skipped over but treats anything older as seen
+  REQUIRE(replay.Insert(100));
+  REQUIRE(replay.Contains(5));
+  REQUIRE_FALSE(replay.Insert(5));
+  REQUIRE_FALSE(replay.Contains(60));
+  REQUIRE(replay.Insert(60));
+  REQUIRE_FALSE(replay.Insert(60));
+  REQUIRE(replay.Size() == 2);
+}
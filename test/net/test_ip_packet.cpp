@@ -0,0 +1,271 @@
+#include <llarp/net/ip.hpp>
+#include <llarp/net/ip_packet.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <random>
+
+using llarp::net::IPPacket;
+
+namespace
+{
+  std::vector<byte_t>
+  MakeRawPacket(size_t sz)
+  {
+    std::vector<byte_t> raw(sz);
+    // ipv4, 20 byte header
+    raw[0] = 0x45;
+    return raw;
+  }
+
+  /// the checksum as rfc 1071 spells it out, a 16 bit word at a time
+  uint16_t
+  ReferenceChecksum(const byte_t* buf, size_t sz, uint32_t sum = 0)
+  {
+    uint64_t wide = sum;
+    for (size_t idx = 0; idx < sz; idx += 2)
+    {
+      uint16_t word = 0;
+      std::memcpy(&word, buf + idx, std::min<size_t>(2, sz - idx));
+      wide += word;
+    }
+    while (wide >> 16)
+      wide = (wide & 0xFFff) + (wide >> 16);
+    return ~wide;
+  }
+
+  /// a tcp or udp packet from src to dst carrying payload with all its checksums filled in.  v4
+  /// if both are v4 mapped.
+  IPPacket
+  MakeL4Packet(llarp::huint128_t src, llarp::huint128_t dst, uint8_t proto, size_t payload)
+  {
+    const auto mapped = [](auto ip) {
+      return llarp::net::ExpandV4(llarp::net::TruncateV6(ip)) == ip;
+    };
+    const bool v4 = mapped(src) and mapped(dst);
+    const size_t hdrsize = v4 ? 20 : 40;
+    const size_t l4size = (proto == 6 ? 20 : 8) + payload;
+    std::vector<byte_t> raw(hdrsize + l4size);
+    for (size_t idx = hdrsize; idx < raw.size(); ++idx)
+      raw[idx] = idx * 7;
+    // the pseudo header the l4 checksum covers, followed by the l4 header and payload
+    std::vector<byte_t> pseudo;
+    if (v4)
+    {
+      raw[0] = 0x45;
+      oxenc::write_host_as_big<uint16_t>(raw.size(), &raw[2]);
+      raw[8] = 64;
+      raw[9] = proto;
+      oxenc::write_host_as_big<uint32_t>(llarp::net::TruncateV6(src).h, &raw[12]);
+      oxenc::write_host_as_big<uint32_t>(llarp::net::TruncateV6(dst).h, &raw[16]);
+      pseudo.assign(&raw[12], &raw[20]);
+      pseudo.insert(pseudo.end(), {0, proto, byte_t(l4size >> 8), byte_t(l4size)});
+    }
+    else
+    {
+      raw[0] = 0x60;
+      oxenc::write_host_as_big<uint16_t>(l4size, &raw[4]);
+      raw[6] = proto;
+      raw[7] = 64;
+      const auto src6 = llarp::net::HUIntToIn6(src);
+      const auto dst6 = llarp::net::HUIntToIn6(dst);
+      std::memcpy(&raw[8], &src6, 16);
+      std::memcpy(&raw[24], &dst6, 16);
+      pseudo.assign(&raw[8], &raw[40]);
+      pseudo.insert(pseudo.end(), {0, 0, byte_t(l4size >> 8), byte_t(l4size), 0, 0, 0, proto});
+    }
+    byte_t* l4 = &raw[hdrsize];
+    oxenc::write_host_as_big<uint16_t>(1234, l4);
+    oxenc::write_host_as_big<uint16_t>(80, l4 + 2);
+    const size_t chk = proto == 6 ? 16 : 6;
+    std::memset(l4 + chk, 0, 2);
+    if (proto == 17)
+      oxenc::write_host_as_big<uint16_t>(l4size, l4 + 4);
+    pseudo.insert(pseudo.end(), l4, l4 + l4size);
+    const auto l4sum = ReferenceChecksum(pseudo.data(), pseudo.size());
+    std::memcpy(l4 + chk, &l4sum, 2);
+    if (v4)
+    {
+      const auto ipsum = ReferenceChecksum(raw.data(), 20);
+      std::memcpy(&raw[10], &ipsum, 2);
+    }
+    return IPPacket{std::move(raw)};
+  }
+
+  /// whether the l4 checksum of a packet MakeL4Packet made still adds up
+  bool
+  L4ChecksumValid(const IPPacket& pkt)
+  {
+    const auto* raw = pkt.data();
+    std::vector<byte_t> pseudo;
+    size_t hdrsize;
+    uint8_t proto;
+    if (pkt.IsV4())
+    {
+      hdrsize = 20;
+      proto = raw[9];
+      const size_t l4size = pkt.size() - hdrsize;
+      pseudo.assign(raw + 12, raw + 20);
+      pseudo.insert(pseudo.end(), {0, proto, byte_t(l4size >> 8), byte_t(l4size)});
+      if (ReferenceChecksum(raw, 20) != 0)
+        return false;
+    }
+    else
+    {
+      hdrsize = 40;
+      proto = raw[6];
+      const size_t l4size = pkt.size() - hdrsize;
+      pseudo.assign(raw + 8, raw + 40);
+      pseudo.insert(pseudo.end(), {0, 0, byte_t(l4size >> 8), byte_t(l4size), 0, 0, 0, proto});
+    }
+    pseudo.insert(pseudo.end(), raw + hdrsize, raw + pkt.size());
+    return ReferenceChecksum(pseudo.data(), pseudo.size()) == 0;
+  }
+}  // namespace
+
+TEST_CASE("IPPacket reuses the buffers of packets we are done with", "[net]")
+{
+  const auto raw = MakeRawPacket(60);
+  const byte_t* first = nullptr;
+  {
+    IPPacket pkt{llarp::byte_view_t{raw.data(), raw.size()}};
+    REQUIRE(pkt.size() == raw.size());
+    REQUIRE(pkt.IsV4());
+    first = pkt.data();
+  }
+  IPPacket pkt{llarp::byte_view_t{raw.data(), raw.size()}};
+  REQUIRE(pkt.data() == first);
+  REQUIRE(pkt.view() == llarp::byte_view_t{raw.data(), raw.size()});
+}
+
+TEST_CASE("IPPacket moves keep the buffer", "[net]")
+{
+  const auto raw = MakeRawPacket(100);
+  IPPacket pkt{llarp::byte_view_t{raw.data(), raw.size()}};
+  const auto* ptr = pkt.data();
+
+  IPPacket moved{std::move(pkt)};
+  REQUIRE(moved.data() == ptr);
+  REQUIRE(moved.size() == raw.size());
+
+  IPPacket assigned;
+  assigned = std::move(moved);
+  REQUIRE(assigned.data() == ptr);
+
+  // a copy is its own packet
+  IPPacket copy{assigned};
+  REQUIRE(copy.data() != ptr);
+  REQUIRE(copy.view() == assigned.view());
+}
+
+TEST_CASE("IPPacket recycled buffers hold a whole packet", "[net]")
+{
+  auto buf = IPPacket::AcquireBuffer();
+  REQUIRE(buf.empty());
+  REQUIRE(buf.capacity() >= IPPacket::MaxSize);
+
+  buf.resize(IPPacket::MaxSize);
+  const auto* ptr = buf.data();
+  IPPacket::RecycleBuffer(std::move(buf));
+
+  auto again = IPPacket::AcquireBuffer();
+  REQUIRE(again.empty());
+  REQUIRE(again.data() == ptr);
+  IPPacket::RecycleBuffer(std::move(again));
+}
+
+TEST_CASE("ipchksum agrees with summing a word at a time", "[net]")
+{
+  std::mt19937 rng{42};
+  std::vector<byte_t> buf(64 * 1024 + 8);
+  for (auto& b : buf)
+    b = rng();
+
+  std::vector<size_t> sizes;
+  for (size_t sz = 0; sz <= 300; ++sz)
+    sizes.push_back(sz);
+  sizes.insert(sizes.end(), {576, 1279, 1500, 9001, 64 * 1024});
+  // every alignment, and a starting sum as the pseudo header would give
+  for (size_t offset = 0; offset < 4; ++offset)
+  {
+    for (const auto sz : sizes)
+    {
+      REQUIRE(llarp::net::ipchksum(&buf[offset], sz) == ReferenceChecksum(&buf[offset], sz));
+      REQUIRE(
+          llarp::net::ipchksum(&buf[offset], sz, 0x1'fffe)
+          == ReferenceChecksum(&buf[offset], sz, 0x1'fffe));
+    }
+  }
+
+  // all ones, so every add carries
+  std::fill(buf.begin(), buf.end(), 0xFF);
+  for (const auto sz : sizes)
+    REQUIRE(llarp::net::ipchksum(buf.data(), sz) == ReferenceChecksum(buf.data(), sz));
+}
+
+TEST_CASE("RewriteAddresses does what rewriting each packet would", "[net]")
+{
+  using llarp::huint128_t;
+  using llarp::ipaddr_ipv4_bits;
+  using llarp::net::ExpandV4;
+  const auto v4a = ExpandV4(ipaddr_ipv4_bits(10, 0, 0, 1));
+  const auto v4b = ExpandV4(ipaddr_ipv4_bits(93, 184, 216, 34));
+  const auto v4c = ExpandV4(ipaddr_ipv4_bits(172, 16, 0, 9));
+  const huint128_t v6a{llarp::uint128_t{0xfd00'0000'0000'0000UL, 1UL}};
+  const huint128_t v6b{llarp::uint128_t{0x2001'0db8'0000'0000UL, 0xdead'beefUL}};
+  const huint128_t v6c{llarp::uint128_t{0xfd00'0000'0000'0000UL, 0xffff'0000'0001UL}};
+
+  // runs of packets from a few flows, then interleaved, so both the shared and fresh deltas are
+  // used
+  std::vector<IPPacket> pkts;
+  std::vector<std::pair<huint128_t, huint128_t>> to;
+  for (size_t idx = 0; idx < 24; ++idx)
+  {
+    const bool v4 = idx % 8 < 4;
+    const uint8_t proto = idx % 2 ? 6 : 17;
+    const bool other = idx >= 16 and idx % 3 == 0;
+    if (v4)
+    {
+      pkts.emplace_back(MakeL4Packet(v4b, other ? v4c : v4a, proto, idx * 13));
+      to.emplace_back(other ? v4a : v4c, v4b);
+    }
+    else
+    {
+      pkts.emplace_back(MakeL4Packet(v6b, other ? v6c : v6a, proto, idx * 13));
+      to.emplace_back(other ? v6a : v6c, v6b);
+    }
+    REQUIRE(L4ChecksumValid(pkts.back()));
+  }
+  // udp over v4 may go without a checksum, and must stay without one
+  pkts.emplace_back(MakeL4Packet(v4b, v4a, 17, 10));
+  std::memset(pkts.back().data() + 26, 0, 2);
+  to.emplace_back(v4c, v4b);
+
+  std::vector<IPPacket> each{pkts};
+  for (size_t idx = 0; idx < each.size(); ++idx)
+  {
+    if (each[idx].IsV4())
+      each[idx].UpdateIPv4Address(
+          llarp::xhtonl(llarp::net::TruncateV6(to[idx].first)),
+          llarp::xhtonl(llarp::net::TruncateV6(to[idx].second)));
+    else
+      each[idx].UpdateIPv6Address(to[idx].first, to[idx].second);
+  }
+
+  std::vector<llarp::net::AddressRewrite> batch;
+  for (size_t idx = 0; idx < pkts.size(); ++idx)
+    batch.push_back(llarp::net::AddressRewrite{&pkts[idx], to[idx].first, to[idx].second});
+  llarp::net::RewriteAddresses(batch);
+
+  for (size_t idx = 0; idx < pkts.size(); ++idx)
+  {
+    REQUIRE(pkts[idx].view() == each[idx].view());
+    REQUIRE(pkts[idx].dstv6() == to[idx].second);
+    if (idx + 1 < pkts.size())
+      REQUIRE(L4ChecksumValid(pkts[idx]));
+  }
+  const auto* raw = pkts.back().data();
+  REQUIRE(raw[26] == 0);
+  REQUIRE(raw[27] == 0);
+}
@@ -0,0 +1,57 @@
+#include <llarp/net/ip_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <limits>
+
+using llarp::huint128_t;
+using llarp::net::IPPool;
+using namespace std::literals;
+
+TEST_CASE("IPPool hands out the range in order", "[net]")
+{
+  IPPool pool;
+  pool.SetRange(huint128_t{10}, huint128_t{14});
+  // something we mapped up front is skipped
+  pool.MarkActiveForever(huint128_t{12});
+
+  REQUIRE(pool.Allocate(1s) == huint128_t{11});
+  REQUIRE(pool.Allocate(2s) == huint128_t{13});
+  // neither end of the range is handed out
+  REQUIRE_FALSE(pool.Allocate(3s));
+  REQUIRE(pool.NumTaken() == 3);
+  REQUIRE(pool.LastActive(huint128_t{13}) == 2s);
+}
+
+TEST_CASE("IPPool finds the address unused the longest", "[net]")
+{
+  IPPool pool;
+  pool.SetRange(huint128_t{0}, huint128_t{100});
+  for (int i = 1; i < 100; ++i)
+    REQUIRE(pool.Allocate(llarp_time_t{i}) == huint128_t{uint64_t(i)});
+  REQUIRE_FALSE(pool.Allocate(100ms));
+  REQUIRE(pool.Oldest() == huint128_t{1});
+
+  pool.MarkActive(huint128_t{1}, 200ms);
+  REQUIRE(pool.Oldest() == huint128_t{2});
+  pool.MarkActiveForever(huint128_t{2});
+  REQUIRE(pool.Oldest() == huint128_t{3});
+  // forever stays forever
+  pool.MarkActive(huint128_t{2}, 300ms);
+  REQUIRE(pool.LastActive(huint128_t{2}) == std::numeric_limits<llarp_time_t>::max());
+
+  // a released address is the next one handed out
+  pool.Release(huint128_t{50});
+  REQUIRE_FALSE(pool.IsTaken(huint128_t{50}));
+  REQUIRE(pool.Allocate(400ms) == huint128_t{50});
+  REQUIRE(pool.Oldest() == huint128_t{3});
+}
+
+TEST_CASE("IPPool with everything taken forever", "[net]")
+{
+  IPPool pool;
+  pool.SetRange(huint128_t{0}, huint128_t{2});
+  pool.MarkActiveForever(huint128_t{1});
+  REQUIRE_FALSE(pool.Allocate(1s));
+  REQUIRE_FALSE(pool.Oldest());
+}
@@ -3,6 +3,10 @@
 #include <llarp/config/config.hpp>
 #include <llarp/router_contact.hpp>
 #include <llarp/nodedb.hpp>
+#include <llarp/dht/kademlia.hpp>
+
+#include <random>
+#include <set>
 
 using llarp_nodedb = llarp::NodeDB;
 
@@ -65,3 +69,103 @@ TEST_CASE("FindClosestTo returns properly ordered set", "[nodedb][dht]")
   REQUIRE(c.pubkey == results[0].pubkey);
   REQUIRE(b.pubkey == results[1].pubkey);
 }
+
+namespace
+{
+  /// an in memory nodedb holding rcs with pubkeys starting 0 to num - 1
+  void
+  Fill(llarp::NodeDB& nodeDB, uint8_t num)
+  {
+    for (uint8_t i = 0; i < num; ++i)
+    {
+      llarp::RouterContact rc;
+      rc.pubkey[0] = i;
+      nodeDB.Put(rc);
+    }
+  }
+}  // namespace
+
+TEST_CASE("GetRandom only picks what the filter lets through", "[nodedb]")
+{
+  llarp::NodeDB nodeDB;
+  REQUIRE_FALSE(nodeDB.GetRandom([](const auto&) { return true; }));
+
+  Fill(nodeDB, 100);
+  std::set<uint8_t> seen;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const auto rc = nodeDB.GetRandom([](const auto& rc) { return rc.pubkey[0] % 2 == 0; });
+    REQUIRE(rc);
+    REQUIRE(rc->pubkey[0] % 2 == 0);
+    seen.insert(rc->pubkey[0]);
+  }
+  // about 40 draws each, they all come up
+  REQUIRE(seen.size() == 50);
+
+  // one that passes is found however few there are, and none is none
+  for (int i = 0; i < 10; ++i)
+  {
+    const auto rc = nodeDB.GetRandom([](const auto& rc) { return rc.pubkey[0] == 77; });
+    REQUIRE(rc);
+    REQUIRE(rc->pubkey[0] == 77);
+  }
+  REQUIRE_FALSE(nodeDB.GetRandom([](const auto&) { return false; }));
+}
+
+TEST_CASE("GetRandom keeps up with what is put and removed", "[nodedb]")
+{
+  llarp::NodeDB nodeDB;
+  Fill(nodeDB, 50);
+
+  llarp::RouterID gone;
+  gone[0] = 7;
+  nodeDB.Remove(gone);
+  nodeDB.RemoveIf([](const auto& rc) { return rc.pubkey[0] >= 40; });
+  // again over ones we have, which replaces them
+  Fill(nodeDB, 5);
+  REQUIRE(nodeDB.NumLoaded() == 39);
+
+  std::set<uint8_t> seen;
+  for (int i = 0; i < 2000; ++i)
+  {
+    const auto rc = nodeDB.GetRandom([](const auto&) { return true; });
+    REQUIRE(rc);
+    seen.insert(rc->pubkey[0]);
+  }
+  REQUIRE(seen.size() == 39);
+  REQUIRE(seen.count(7) == 0);
+  REQUIRE(*seen.rbegin() == 39);
+}
+
+TEST_CASE("FindManyClosestTo agrees with sorting every rc", "[nodedb][dht]")
+{
+  llarp::NodeDB nodeDB;
+  std::mt19937_64 rng{5};
+  for (int i = 0; i < 300; ++i)
+  {
+    llarp::RouterContact rc;
+    for (auto& b : rc.pubkey)
+      b = rng();
+    nodeDB.Put(rc);
+  }
+  // and some gone again, which takes them out of the index too
+  nodeDB.RemoveIf([](const auto& rc) { return rc.pubkey[0] % 3 == 0; });
+
+  for (int round = 0; round < 10; ++round)
+  {
+    llarp::dht::Key_t target;
+    for (auto& b : target)
+      b = rng();
+
+    std::vector<llarp::RouterContact> all;
+    nodeDB.VisitAll([&all](const auto& rc) { all.push_back(rc); });
+    std::sort(all.begin(), all.end(), llarp::dht::XorMetric{target});
+
+    const auto results = nodeDB.FindManyClosestTo(target, 20);
+    REQUIRE(results.size() == 20);
+    for (size_t i = 0; i < results.size(); ++i)
+      REQUIRE(results[i].pubkey == all[i].pubkey);
+    REQUIRE(nodeDB.FindClosestTo(target).pubkey == all[0].pubkey);
+  }
+  REQUIRE(nodeDB.FindManyClosestTo(llarp::dht::Key_t{}, 0).empty());
+}
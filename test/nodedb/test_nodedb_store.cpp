@@ -0,0 +1,175 @@
+#include <catch2/catch.hpp>
+
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/nodedb.hpp>
+#include <llarp/nodedb_store.hpp>
+#include <llarp/router_contact.hpp>
+
+#include "test_util.hpp"
+
+#include <fstream>
+
+using namespace llarp;
+
+namespace
+{
+  RouterContact
+  SignedRC()
+  {
+    SecretKey sign;
+    CryptoManager::instance()->identity_keygen(sign);
+    SecretKey encr;
+    CryptoManager::instance()->encryption_keygen(encr);
+    RouterContact rc;
+    rc.enckey = encr.toPublic();
+    rc.pubkey = sign.toPublic();
+    REQUIRE(rc.Sign(sign));
+    return rc;
+  }
+
+  /// a nodedb on disk at root whose disk jobs run right away
+  NodeDB
+  OnDisk(const fs::path& root)
+  {
+    return NodeDB{root, [](auto job) { job(); }};
+  }
+}  // namespace
+
+TEST_CASE("NodeDB keeps rcs across restarts in its store", "[nodedb]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  const fs::path root = fs::current_path() / test::randFilename();
+  test::FileGuard guard{root};
+
+  std::vector<RouterContact> rcs;
+  {
+    auto nodeDB = OnDisk(root);
+    nodeDB.LoadFromDisk();
+    for (int i = 0; i < 20; ++i)
+    {
+      rcs.push_back(SignedRC());
+      nodeDB.Put(rcs.back());
+    }
+    nodeDB.SaveToDisk();
+  }
+  const auto store = root / "rcs.store";
+  REQUIRE(fs::exists(store));
+  const auto written = fs::file_size(store);
+  {
+    auto nodeDB = OnDisk(root);
+    nodeDB.LoadFromDisk();
+    REQUIRE(nodeDB.NumLoaded() == 20);
+    for (const auto& rc : rcs)
+    {
+      const auto loaded = nodeDB.Get(RouterID{rc.pubkey});
+      REQUIRE(loaded);
+      REQUIRE(*loaded == rc);
+    }
+    // nothing changed so nothing is written
+    nodeDB.SaveToDisk();
+    REQUIRE(fs::file_size(store) == written);
+
+    for (int i = 0; i < 5; ++i)
+      nodeDB.Remove(RouterID{rcs[i].pubkey});
+    nodeDB.SaveToDisk();
+  }
+
+  // as if we were killed half way through writing a record
+  {
+    std::ofstream out{store, std::ios::binary | std::ios::app};
+    out << "p0123456789";
+  }
+  auto nodeDB = OnDisk(root);
+  nodeDB.LoadFromDisk();
+  REQUIRE(nodeDB.NumLoaded() == 15);
+  REQUIRE_FALSE(nodeDB.Has(RouterID{rcs[0].pubkey}));
+  REQUIRE(nodeDB.Has(RouterID{rcs[19].pubkey}));
+}
+
+TEST_CASE("NodeDB checks signatures of stored rcs when they are first used", "[nodedb]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  const fs::path root = fs::current_path() / test::randFilename();
+  test::FileGuard guard{root};
+
+  auto good = SignedRC();
+  auto bad = SignedRC();
+  bad.signature[0] ^= 1;
+  {
+    auto nodeDB = OnDisk(root);
+    nodeDB.Put(good);
+    nodeDB.Put(bad);
+    nodeDB.SaveToDisk();
+  }
+
+  auto nodeDB = OnDisk(root);
+  nodeDB.LoadFromDisk();
+  REQUIRE(nodeDB.NumLoaded() == 2);
+  REQUIRE(nodeDB.Get(RouterID{good.pubkey}));
+  REQUIRE_FALSE(nodeDB.Get(RouterID{bad.pubkey}));
+  REQUIRE_FALSE(nodeDB.Has(RouterID{bad.pubkey}));
+  // and dropped at the next tick
+  nodeDB.Tick(time_now_ms());
+  REQUIRE(nodeDB.NumLoaded() == 1);
+}
+
+TEST_CASE("NodeDB checks every rc file it moves into its store at once", "[nodedb]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  const fs::path root = fs::current_path() / test::randFilename();
+  fs::create_directory(root);
+  test::FileGuard guard{root};
+
+  // as nodedbs kept them before the store, enough of them to be checked on a few threads
+  std::vector<RouterContact> rcs;
+  for (size_t i = 0; i < 300; ++i)
+  {
+    rcs.push_back(SignedRC());
+    if (i % 10 == 0)
+      rcs.back().signature[0] ^= 1;
+    const auto dir = root / std::string{"0123456789abcdef"[i % 16]};
+    fs::create_directories(dir);
+    REQUIRE(rcs.back().Write(dir / (std::to_string(i) + ".signed")));
+  }
+
+  auto nodeDB = OnDisk(root);
+  nodeDB.LoadFromDisk();
+  REQUIRE(nodeDB.NumLoaded() == 270);
+  for (size_t i = 0; i < rcs.size(); ++i)
+    REQUIRE(nodeDB.Has(RouterID{rcs[i].pubkey}) == (i % 10 != 0));
+  REQUIRE(fs::exists(root / "rcs.store"));
+  REQUIRE_FALSE(fs::exists(root / "0"));
+}
+
+TEST_CASE("NodeDBStore compacts once most records are replaced", "[nodedb]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  const fs::path root = fs::current_path() / test::randFilename();
+  fs::create_directory(root);
+  test::FileGuard guard{root};
+
+  const auto keep = SignedRC();
+  const auto churn = SignedRC();
+  NodeDBStore store{root / "rcs.store"};
+  REQUIRE(store.Load().empty());
+  store.Queue({*NodeDBStore::Put(keep)});
+  REQUIRE(store.Flush());
+
+  for (size_t i = 0; i <= NodeDBStore::CompactSlack; ++i)
+  {
+    store.Queue({*NodeDBStore::Put(churn)});
+    REQUIRE(store.Flush());
+  }
+  REQUIRE(store.Records() == NodeDBStore::CompactSlack + 2);
+  store.Queue({NodeDBStore::Remove(RouterID{churn.pubkey})});
+  REQUIRE(store.Flush());
+  // rewritten with just the one still live
+  REQUIRE(store.Records() == 1);
+  REQUIRE(store.Live() == 1);
+
+  NodeDBStore reopened{root / "rcs.store"};
+  const auto rcs = reopened.Load();
+  REQUIRE(rcs.size() == 1);
+  REQUIRE(rcs[0] == keep);
+}
@@ -0,0 +1,52 @@
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/path/hop_key_pool.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <set>
+
+using namespace llarp;
+
+TEST_CASE("HopKeyPool hands out every keypair once", "[path]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  path::HopKeyPool pool{8};
+  REQUIRE(pool.ShouldRefill());
+  // one refill at a time
+  REQUIRE_FALSE(pool.ShouldRefill());
+  REQUIRE(pool.Refill() == 8);
+  REQUIRE(pool.Size() == 8);
+  REQUIRE(pool.Refill() == 0);
+  REQUIRE_FALSE(pool.ShouldRefill());
+
+  auto crypto = CryptoManager::instance();
+  SecretKey relay;
+  crypto->encryption_keygen(relay);
+  TunnelNonce nonce;
+  nonce.Randomize();
+
+  std::set<PubKey> seen;
+  for (size_t i = 0; i < 5; ++i)
+  {
+    const auto key = pool.Take();
+    REQUIRE_FALSE(key.IsZero());
+    REQUIRE(seen.insert(key.toPublic()).second);
+    // and it works for a key exchange with a hop
+    SharedSecret ours, theirs;
+    REQUIRE(crypto->dh_client(ours, relay.toPublic(), key, nonce));
+    REQUIRE(crypto->dh_server(theirs, key.toPublic(), relay, nonce));
+    REQUIRE(ours == theirs);
+  }
+  REQUIRE(pool.Size() == 3);
+  REQUIRE(pool.ShouldRefill());
+  REQUIRE(pool.Refill() == 5);
+
+  // ran dry, so made on the spot
+  for (size_t i = 0; i < 10; ++i)
+    REQUIRE(seen.insert(pool.Take().toPublic()).second);
+  REQUIRE(pool.Size() == 0);
+  const auto status = pool.ExtractStatus();
+  REQUIRE(status["taken"] == 15);
+  REQUIRE(status["missed"] == 2);
+}
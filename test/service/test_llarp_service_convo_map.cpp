@@ -0,0 +1,87 @@
+#include <llarp/crypto/crypto.hpp>
+#include <llarp/crypto/crypto_libsodium.hpp>
+#include <llarp/service/convo_map.hpp>
+#include <llarp/service/identity.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  service::Session
+  MakeSession(const service::Identity& ident, bool inbound)
+  {
+    service::Session session{};
+    session.remote = ident.pub;
+    session.inbound = inbound;
+    return session;
+  }
+
+  service::ConvoTag
+  RandomTag()
+  {
+    service::ConvoTag tag;
+    tag.Randomize();
+    return tag;
+  }
+}  // namespace
+
+TEST_CASE("ConvoMap indexes sessions by remote address", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity alice, bob;
+  alice.RegenerateKeys();
+  bob.RegenerateKeys();
+
+  service::ConvoMap convos;
+  REQUIRE(convos.FindRemote(alice.pub.Addr()) == nullptr);
+
+  const auto in = RandomTag();
+  const auto out = RandomTag();
+  REQUIRE(convos.emplace(in, MakeSession(alice, true)).second);
+  REQUIRE(convos.emplace(out, MakeSession(alice, false)).second);
+  REQUIRE(convos.emplace(RandomTag(), MakeSession(bob, false)).second);
+  // adding a tag we already have changes nothing
+  REQUIRE_FALSE(convos.emplace(in, MakeSession(bob, false)).second);
+  REQUIRE(convos.size() == 3);
+
+  const auto* remote = convos.FindRemote(alice.pub.Addr());
+  REQUIRE(remote != nullptr);
+  REQUIRE(remote->tags.size() == 2);
+  REQUIRE(remote->HasInbound());
+  REQUIRE(remote->HasOutbound());
+
+  REQUIRE(convos.erase(in) == 1);
+  remote = convos.FindRemote(alice.pub.Addr());
+  REQUIRE(remote != nullptr);
+  REQUIRE(remote->tags == std::vector<service::ConvoTag>{out});
+  REQUIRE_FALSE(remote->HasInbound());
+  REQUIRE(remote->HasOutbound());
+
+  // erasing through an iterator unindexes too, and the last tag takes the remote with it
+  convos.erase(convos.find(out));
+  REQUIRE(convos.FindRemote(alice.pub.Addr()) == nullptr);
+  REQUIRE(convos.FindRemote(bob.pub.Addr()) != nullptr);
+  REQUIRE(convos.erase(out) == 0);
+}
+
+TEST_CASE("ConvoMap does not index sessions without a remote", "[service]")
+{
+  CryptoManager manager(new sodium::CryptoLibSodium());
+  service::Identity alice;
+  alice.RegenerateKeys();
+
+  service::ConvoMap convos;
+  const auto tag = RandomTag();
+  convos[tag].inbound = true;
+  REQUIRE(convos.count(tag) == 1);
+  REQUIRE(convos.FindRemote(alice.pub.Addr()) == nullptr);
+
+  // nor does erasing one touch the index
+  REQUIRE(convos.emplace(RandomTag(), MakeSession(alice, true)).second);
+  REQUIRE(convos.erase(tag) == 1);
+  const auto* remote = convos.FindRemote(alice.pub.Addr());
+  REQUIRE(remote != nullptr);
+  REQUIRE(remote->inbound == 1);
+}
@@ -0,0 +1,51 @@
+#include <llarp/util/packet_pool.hpp>
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <thread>
+
+TEST_CASE("PacketPool copy and share buffers", "[packet-pool]")
+{
+  llarp::PacketPool pool{128, 4};
+  const std::array<byte_t, 3> data{1, 2, 3};
+
+  auto buf = pool.copy_from(data.data(), data.size());
+  REQUIRE(buf);
+  REQUIRE(buf.size() == data.size());
+  REQUIRE(buf.capacity() == 128);
+  REQUIRE(std::equal(data.begin(), data.end(), buf.data()));
+
+  // copies share the same storage
+  auto other = buf;
+  REQUIRE(other.data() == buf.data());
+  other.data()[0] = 42;
+  REQUIRE(buf.data()[0] == 42);
+
+  auto moved = std::move(other);
+  REQUIRE_FALSE(other);
+  REQUIRE(moved.data() == buf.data());
+
+  // too big for the pool
+  std::array<byte_t, 129> big{};
+  REQUIRE_FALSE(pool.copy_from(big.data(), big.size()));
+}
+
+TEST_CASE("PacketPool reuses released buffers", "[packet-pool]")
+{
+  llarp::PacketPool pool{64, 2};
+  const byte_t* first = nullptr;
+  {
+    auto buf = pool.acquire();
+    REQUIRE(buf.size() == 0);
+    first = buf.data();
+  }
+  auto again = pool.acquire();
+  REQUIRE(again.data() == first);
+
+  // grows past a single slab, and buffers can be dropped on another thread
+  std::vector<llarp::PacketBuffer> bufs;
+  for (int i = 0; i < 10; ++i)
+    bufs.push_back(pool.acquire());
+  std::thread{[bufs = std::move(bufs)]() mutable { bufs.clear(); }}.join();
+  again = llarp::PacketBuffer{};
+}
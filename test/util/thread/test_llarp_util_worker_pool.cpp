@@ -0,0 +1,97 @@
+#include <llarp/util/thread/worker_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <catch2/catch.hpp>
+
+using namespace llarp::thread;
+
+TEST_CASE("WorkerPool runs every job", "[worker-pool]")
+{
+  WorkerPool pool{4, "test-worker"};
+  pool.Start();
+
+  std::atomic<int> ran{0};
+  constexpr int numJobs = 10000;
+  for (int i = 0; i < numJobs; ++i)
+    REQUIRE(pool.AddJob([&ran] { ran++; }));
+  while (ran < numJobs)
+    std::this_thread::yield();
+
+  pool.Stop();
+  REQUIRE_FALSE(pool.AddJob([] {}));
+  REQUIRE(pool.ExtractStatus()["executed"] == numJobs);
+}
+
+TEST_CASE("WorkerPool keeps pinned jobs in order", "[worker-pool]")
+{
+  WorkerPool pool{4, "test-worker"};
+  pool.Start();
+
+  constexpr uint64_t numKeys = 8;
+  constexpr int numJobs = 10000;
+  std::vector<std::vector<int>> seen(numKeys);
+  std::atomic<int> ran{0};
+  for (int i = 0; i < numJobs; ++i)
+  {
+    const uint64_t key = i % numKeys;
+    // unpinned work mixed in to give the workers something to steal
+    pool.AddJob([&ran] { ran++; });
+    // each key only ever runs on one worker so its list needs no lock
+    pool.AddJob(key, [&seen, &ran, key, i] {
+      seen[key].push_back(i);
+      ran++;
+    });
+  }
+  while (ran < numJobs * 2)
+    std::this_thread::yield();
+  pool.Stop();
+
+  for (const auto& order : seen)
+  {
+    REQUIRE(order.size() == numJobs / numKeys);
+    REQUIRE(std::is_sorted(order.begin(), order.end()));
+  }
+}
+
+TEST_CASE("WorkerPool overflows rather than block when its queues are full", "[worker-pool]")
+{
+  WorkerPool pool{2, "test-worker", 4};
+  pool.Start();
+
+  // keep both workers busy so nothing drains while we add
+  std::atomic<bool> release{false};
+  std::atomic<int> blocked{0};
+  for (int i = 0; i < 2; ++i)
+    pool.AddJob([&] {
+      blocked++;
+      while (not release)
+        std::this_thread::yield();
+    });
+  while (blocked < 2)
+    std::this_thread::yield();
+
+  constexpr int numJobs = 1000;
+  std::vector<int> order;
+  std::atomic<int> ran{0};
+  for (int i = 0; i < numJobs; ++i)
+  {
+    REQUIRE(pool.AddJob([&ran] { ran++; }));
+    REQUIRE(pool.AddJob(7, [&order, &ran, i] {
+      order.push_back(i);
+      ran++;
+    }));
+  }
+  REQUIRE(pool.QueueDepth() == numJobs * 2);
+  REQUIRE(pool.ExtractStatus()["overflowed"] > 0);
+
+  release = true;
+  while (ran < numJobs * 2)
+    std::this_thread::yield();
+  pool.Stop();
+
+  REQUIRE(order.size() == numJobs);
+  REQUIRE(std::is_sorted(order.begin(), order.end()));
+}
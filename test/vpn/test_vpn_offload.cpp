@@ -0,0 +1,155 @@
+#include <llarp/vpn/offload.hpp>
+
+#include <oxenc/endian.h>
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+
+using namespace llarp;
+using vpn::VNetHeader;
+
+namespace
+{
+  constexpr size_t IPHeaderSize = 20;
+  constexpr size_t TCPHeaderSize = 20;
+  constexpr byte_t FlagsPSHACKFIN = 0x19;
+
+  uint32_t
+  sum_words(const byte_t* ptr, size_t sz)
+  {
+    uint32_t sum = 0;
+    for (size_t idx = 0; idx + 1 < sz; idx += 2)
+    {
+      uint16_t word;
+      std::memcpy(&word, ptr + idx, sizeof(word));
+      sum += word;
+    }
+    return sum;
+  }
+
+  /// tcp pseudo header sum for an ipv4 packet
+  uint32_t
+  pseudo_sum(const byte_t* pkt, size_t tcplen)
+  {
+    return sum_words(pkt + 12, 8) + oxenc::host_to_big(uint16_t{6})
+        + oxenc::host_to_big(static_cast<uint16_t>(tcplen));
+  }
+
+  bool
+  tcp_checksum_ok(const net::IPPacket& pkt)
+  {
+    const auto tcplen = pkt.size() - IPHeaderSize;
+    return net::ipchksum(pkt.data() + IPHeaderSize, tcplen, pseudo_sum(pkt.data(), tcplen)) == 0;
+  }
+
+  /// an ipv4 tcp packet carrying payload bytes of data
+  std::vector<byte_t>
+  make_tcp_packet(size_t payload)
+  {
+    std::vector<byte_t> pkt(IPHeaderSize + TCPHeaderSize + payload);
+    auto* ptr = pkt.data();
+    ptr[0] = 0x45;
+    oxenc::write_host_as_big(static_cast<uint16_t>(pkt.size()), ptr + 2);
+    oxenc::write_host_as_big(uint16_t{0x1234}, ptr + 4);
+    ptr[8] = 64;
+    ptr[9] = 6;
+    const byte_t addrs[8] = {10, 0, 0, 1, 10, 0, 0, 2};
+    std::memcpy(ptr + 12, addrs, sizeof(addrs));
+    auto* tcp = ptr + IPHeaderSize;
+    oxenc::write_host_as_big(uint16_t{5555}, tcp);
+    oxenc::write_host_as_big(uint16_t{80}, tcp + 2);
+    oxenc::write_host_as_big(uint32_t{1000}, tcp + 4);
+    tcp[12] = (TCPHeaderSize / 4) << 4;
+    tcp[13] = FlagsPSHACKFIN;
+    for (size_t idx = 0; idx < payload; ++idx)
+      tcp[TCPHeaderSize + idx] = idx % 251;
+    // leave the pseudo header sum in the checksum field, as the kernel does
+    uint32_t sum = pseudo_sum(ptr, TCPHeaderSize + payload);
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum += sum >> 16;
+    const auto partial = static_cast<uint16_t>(sum);
+    std::memcpy(tcp + 16, &partial, sizeof(partial));
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("UnpackOffloaded finishes a partial checksum", "[vpn]")
+{
+  const auto raw = make_tcp_packet(500);
+  VNetHeader hdr{};
+  hdr.flags = VNetHeader::NeedsChecksum;
+  hdr.csum_start = IPHeaderSize;
+  hdr.csum_offset = 16;
+
+  std::vector<net::IPPacket> out;
+  REQUIRE(vpn::UnpackOffloaded(hdr, byte_view_t{raw.data(), raw.size()}, out));
+  REQUIRE(out.size() == 1);
+  REQUIRE(out[0].size() == raw.size());
+  REQUIRE(tcp_checksum_ok(out[0]));
+}
+
+TEST_CASE("UnpackOffloaded segments a tcp super packet", "[vpn]")
+{
+  const auto raw = make_tcp_packet(3000);
+  VNetHeader hdr{};
+  hdr.flags = VNetHeader::NeedsChecksum;
+  hdr.gso_type = VNetHeader::GSOTCPv4;
+  hdr.gso_size = 1400;
+  hdr.hdr_len = IPHeaderSize + TCPHeaderSize;
+  hdr.csum_start = IPHeaderSize;
+  hdr.csum_offset = 16;
+
+  std::vector<net::IPPacket> out;
+  REQUIRE(vpn::UnpackOffloaded(hdr, byte_view_t{raw.data(), raw.size()}, out));
+  REQUIRE(out.size() == 3);
+
+  const size_t sizes[] = {1400, 1400, 200};
+  size_t off = 0;
+  for (size_t seg = 0; seg < out.size(); ++seg)
+  {
+    const auto& pkt = out[seg];
+    const auto* ptr = pkt.data();
+    const auto* tcp = ptr + IPHeaderSize;
+    REQUIRE(pkt.size() == IPHeaderSize + TCPHeaderSize + sizes[seg]);
+    REQUIRE(oxenc::load_big_to_host<uint16_t>(ptr + 2) == pkt.size());
+    REQUIRE(oxenc::load_big_to_host<uint16_t>(ptr + 4) == 0x1234 + seg);
+    REQUIRE(net::ipchksum(ptr, IPHeaderSize) == 0);
+    REQUIRE(oxenc::load_big_to_host<uint32_t>(tcp + 4) == 1000 + off);
+    // fin and push stay on the last segment only
+    REQUIRE(tcp[13] == (seg + 1 == out.size() ? FlagsPSHACKFIN : 0x10));
+    REQUIRE(tcp_checksum_ok(pkt));
+    REQUIRE(
+        std::memcmp(
+            tcp + TCPHeaderSize,
+            raw.data() + IPHeaderSize + TCPHeaderSize + off,
+            sizes[seg])
+        == 0);
+    off += sizes[seg];
+  }
+}
+
+TEST_CASE("UnpackOffloaded rejects what it cannot handle", "[vpn]")
+{
+  const auto raw = make_tcp_packet(3000);
+  VNetHeader hdr{};
+  hdr.gso_size = 1400;
+  hdr.csum_start = IPHeaderSize;
+  std::vector<net::IPPacket> out;
+
+  // we never ask for udp fragmentation offload
+  hdr.gso_type = VNetHeader::GSOUDP;
+  REQUIRE_FALSE(vpn::UnpackOffloaded(hdr, byte_view_t{raw.data(), raw.size()}, out));
+
+  // an ipv6 gso type on an ipv4 packet
+  hdr.gso_type = VNetHeader::GSOTCPv6;
+  REQUIRE_FALSE(vpn::UnpackOffloaded(hdr, byte_view_t{raw.data(), raw.size()}, out));
+
+  // a checksum offset past the end of the packet
+  hdr.gso_type = VNetHeader::GSONone;
+  hdr.flags = VNetHeader::NeedsChecksum;
+  hdr.csum_offset = raw.size();
+  REQUIRE_FALSE(vpn::UnpackOffloaded(hdr, byte_view_t{raw.data(), raw.size()}, out));
+
+  REQUIRE(out.empty());
+}